@@ -0,0 +1,321 @@
+// behavior.cpp: small checks of what the library's features do, as
+// opposed to how fast they do it. Each check asserts on the calls a
+// slot received and returns; the program prints "ok" when all pass.
+// "make check" builds and runs it. Build it without NDEBUG.
+//
+// Build with "make" in this directory, or for example:
+//		g++ -O1 -I.. behavior.cpp -o behavior -lpthread
+
+#include "sigslot.h"
+
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+using namespace sigslot;
+
+class recorder : public has_slots<single_threaded>
+{
+public:
+	void on_value(int value)
+	{
+		m_values.push_back(value);
+	}
+    
+	std::vector<int> m_values;
+};
+
+// Logs its tag to a shared list on every call, so that checks can see
+// the order slots ran in across receivers.
+class tagged : public has_slots<single_threaded>
+{
+public:
+	tagged(std::vector<int>& log, int tag, bool handles = false)
+    : m_plog(&log), m_tag(tag), m_handles(handles)
+	{
+		;
+	}
+    
+	void on_value(int)
+	{
+		m_plog->push_back(m_tag);
+	}
+    
+	bool on_handle(int)
+	{
+		m_plog->push_back(m_tag);
+		return m_handles;
+	}
+    
+private:
+	std::vector<int>* m_plog;
+	int m_tag;
+	bool m_handles;
+};
+
+class weak_tagged : public has_weak_slots
+{
+public:
+	weak_tagged(std::vector<int>& log, int tag)
+    : m_plog(&log), m_tag(tag)
+	{
+		;
+	}
+    
+	void on_value(int)
+	{
+		m_plog->push_back(m_tag);
+	}
+    
+private:
+	std::vector<int>* m_plog;
+	int m_tag;
+};
+
+class counting_dispatcher : public dispatcher
+{
+public:
+	counting_dispatcher()
+    : m_notifies(0)
+	{
+		;
+	}
+    
+	int m_notifies;
+    
+protected:
+	virtual void notify()
+	{
+		++m_notifies;
+	}
+};
+
+// Slots run highest priority first, and those of equal priority in the
+// order they were connected, however the connects were interleaved.
+static void check_priority_order()
+{
+	std::vector<int> log;
+	tagged a(log, 1), b(log, 2), c(log, 3), d(log, 4), e(log, 5);
+	signal1<int, single_threaded> sig;
+	sig.connect(&a, &tagged::on_value);
+	sig.connect(&b, &tagged::on_value, 10);
+	sig.connect(&c, &tagged::on_value, -5);
+	sig.connect(&d, &tagged::on_value, 10);
+	sig.connect(&e, &tagged::on_value);
+    
+	sig.emit(0);
+	static const int expected[] = { 2, 4, 1, 5, 3 };
+	assert(log == std::vector<int>(expected, expected + 5));
+}
+
+// emit_until_handled() stops after the first slot to return true and
+// says so; slots that return void never stop it. emit() runs them all.
+static void check_until_handled()
+{
+	std::vector<int> log;
+	tagged a(log, 1), b(log, 2), c(log, 3), d(log, 4);
+	signal1<int, single_threaded> sig;
+	sig.connect(&a, &tagged::on_value, 3);
+	sig.connect(&b, &tagged::on_handle, 2);
+	sig.connect(&c, &tagged::on_handle, 1);
+	sig.connect(&d, &tagged::on_value);
+    
+	assert(!sig.emit_until_handled(0));
+	assert(log.size() == 4);
+    
+	tagged handler(log, 5, true);
+	sig.connect(&handler, &tagged::on_handle, 2);
+	log.clear();
+	assert(sig.emit_until_handled(0));
+	static const int expected[] = { 1, 2, 5 };
+	assert(log == std::vector<int>(expected, expected + 3));
+    
+	log.clear();
+	sig.emit(0);
+	assert(log.size() == 5);
+}
+
+static std::vector<int> g_function_log;
+
+static void log_function(int value)
+{
+	g_function_log.push_back(value);
+}
+
+// Lambdas and free functions connect with no receiver, and only their
+// handles remove them. A handle whose connection is gone is stale: it
+// reports unconnected and disconnecting it again touches nothing, even
+// once a newer connection has taken its place.
+template<class storage_policy>
+static void check_callables()
+{
+	std::vector<int> log;
+	signal1<int, single_threaded, storage_policy> sig;
+	connection first = sig.connect([&log](int value) { log.push_back(value); });
+	connection second = sig.connect(&log_function);
+	connection handler = sig.connect([&log](int) { log.push_back(-1); return true; }, -1);
+	connection last = sig.connect([&log](int value) { log.push_back(value * 10); }, -2);
+    
+	g_function_log.clear();
+	sig.emit(2);
+	static const int expected[] = { 2, -1, 20 };
+	assert(log == std::vector<int>(expected, expected + 3));
+	assert(g_function_log.size() == 1 && g_function_log[0] == 2);
+    
+	log.clear();
+	assert(sig.emit_until_handled(3));
+	assert(log.size() == 2 && log[1] == -1);
+    
+	sig.disconnect(first);
+	assert(!sig.connected(first) && sig.connected(second));
+	connection replacement = sig.connect([&log](int value) { log.push_back(value + 100); });
+	sig.disconnect(first);
+	sig.disconnect(connection());
+	assert(sig.connected(replacement) && sig.connected(handler) && sig.connected(last));
+    
+	log.clear();
+	sig.emit(4);
+	static const int replaced[] = { 104, -1, 40 };
+	assert(log == std::vector<int>(replaced, replaced + 3));
+    
+	sig.disconnect_all();
+	sig.disconnect(second);
+	sig.disconnect(replacement);
+	assert(!sig.connected(second) && !sig.connected(replacement));
+	connection fresh = sig.connect([&log](int value) { log.push_back(value); });
+	sig.disconnect(last);
+    
+	log.clear();
+	g_function_log.clear();
+	sig.emit(5);
+	assert(log.size() == 1 && log[0] == 5 && g_function_log.empty());
+	assert(sig.connected(fresh));
+}
+
+// Emitting a key that nothing is connected to runs no slot, whether the
+// key was never used or its last connection has gone, and leaves the
+// other keys' connections as they were.
+static void check_hub_unknown_key()
+{
+	std::vector<int> log;
+	tagged a(log, 1), b(log, 2);
+	basic_signal_hub<single_threaded, int, int> hub;
+	hub.emit(7, 0);
+	assert(log.empty());
+    
+	connection first = hub.connect(1, &a, &tagged::on_value);
+	hub.connect(2, &b, &tagged::on_value);
+	hub.emit(3, 0);
+	assert(log.empty());
+	hub.emit(1, 0);
+	assert(log.size() == 1 && log[0] == 1);
+    
+	hub.disconnect(first);
+	assert(!hub.connected(first));
+	log.clear();
+	hub.emit(1, 0);
+	assert(log.empty());
+	hub.emit(2, 0);
+	assert(log.size() == 1 && log[0] == 2);
+}
+
+// A value that arrives within the interval is held back without waking
+// the loop, and delivered by the first dispatch() after next_deadline().
+static void check_coalesced_trailing()
+{
+	typedef std::chrono::steady_clock clock;
+	counting_dispatcher d;
+	recorder r;
+	signal1<int, single_threaded> sig;
+	sig.connect(&r, &recorder::on_value, coalesced_on(d, std::chrono::milliseconds(100)));
+    
+	sig.emit(1);
+	d.dispatch();
+	assert(r.m_values.size() == 1 && r.m_values[0] == 1);
+	assert(d.next_deadline() == clock::time_point::max());
+    
+	sig.emit(2);
+	sig.emit(3);
+	int notifies = d.m_notifies;
+	d.dispatch();
+	assert(r.m_values.size() == 1);
+	assert(d.m_notifies == notifies);
+	assert(d.next_deadline() != clock::time_point::max());
+    
+	d.dispatch();
+	assert(r.m_values.size() == 1);
+	assert(d.m_notifies == notifies);
+    
+	std::this_thread::sleep_until(d.next_deadline());
+	d.dispatch();
+	assert(r.m_values.size() == 2 && r.m_values[1] == 3);
+	assert(d.next_deadline() == clock::time_point::max());
+	assert(d.m_notifies == notifies);
+}
+
+// A signal skips the slot of a has_weak_slots receiver once it has been
+// destroyed, reports its connection as gone, and goes on calling the
+// receivers that are still alive, before and after it in the order.
+template<class mt_policy>
+static void check_weak_skipped()
+{
+	std::vector<int> log;
+	weak_tagged first(log, 1), last(log, 3);
+	weak_tagged* pdoomed = new weak_tagged(log, 2);
+	signal1<int, mt_policy> sig;
+	sig.connect(&first, &weak_tagged::on_value);
+	connection doomed = sig.connect(pdoomed, &weak_tagged::on_value);
+	sig.connect(&last, &weak_tagged::on_value);
+    
+	sig.emit(0);
+	assert(log.size() == 3 && sig.connected(doomed));
+    
+	delete pdoomed;
+	assert(!sig.connected(doomed));
+	log.clear();
+	sig.emit(0);
+	static const int expected[] = { 1, 3 };
+	assert(log == std::vector<int>(expected, expected + 2));
+}
+
+// static_signal runs its static slots, in the order they are listed,
+// before any connection made at run time, whatever its priority. Through
+// a reference to its base signal only the run-time connections run.
+static void check_static_first()
+{
+	typedef signal1<int, single_threaded> signal_type;
+	typedef signal_type::static_slot<tagged, &tagged::on_value> tagged_slot;
+	std::vector<int> log;
+	tagged a(log, 1), b(log, 2), dynamic(log, 3);
+	static_signal<signal_type, tagged_slot, tagged_slot> sig(&b, &a);
+	sig.emit(0);
+	static const int wired[] = { 2, 1 };
+	assert(log == std::vector<int>(wired, wired + 2));
+    
+	sig.connect(&dynamic, &tagged::on_value, 100);
+	log.clear();
+	sig.emit(0);
+	static const int expected[] = { 2, 1, 3 };
+	assert(log == std::vector<int>(expected, expected + 3));
+    
+	log.clear();
+	static_cast<signal_type&>(sig).emit(0);
+	assert(log.size() == 1 && log[0] == 3);
+}
+
+int main()
+{
+	check_priority_order();
+	check_until_handled();
+	check_callables<list_storage>();
+	check_callables<vector_storage>();
+	check_hub_unknown_key();
+	check_coalesced_trailing();
+	check_weak_skipped<single_threaded>();
+	check_weak_skipped<multi_threaded_local>();
+	check_static_first();
+	printf("ok\n");
+	return 0;
+}
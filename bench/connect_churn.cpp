@@ -0,0 +1,77 @@
+// connect_churn.cpp: measures the cost of creating a receiver, connecting
+// it to a set of signals, and destroying it again, which is dominated by
+// allocating and freeing connections and their list and set nodes.
+//
+// Build once with the default allocator and once with the pools:
+//		g++ -O2 -I.. connect_churn.cpp -o connect_churn -lpthread
+//		g++ -O2 -I.. -DSIGSLOT_ALLOCATOR=sigslot::pool_allocator connect_churn.cpp -o connect_churn_pool -lpthread
+
+#include "sigslot.h"
+
+#include <cstdio>
+#include <vector>
+#include <time.h>
+
+using namespace sigslot;
+
+class session : public has_slots<>
+{
+public:
+	void on_event(int)
+	{
+		;
+	}
+};
+
+static double now_ns()
+{
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+int main()
+{
+	static const int signal_count = 40;
+	static const int live_sessions = 8;
+	static const int rounds = 200000;
+    
+	std::vector<signal1<int> *> signals;
+	std::vector<session*> sessions(live_sessions, (session*)NULL);
+    
+	for(int i = 0; i < signal_count; ++i)
+	{
+		signals.push_back(new signal1<int>);
+	}
+    
+	double start = now_ns();
+    
+	for(int round = 0; round < rounds; ++round)
+	{
+		session*& slot = sessions[round % live_sessions];
+		delete slot;
+		slot = new session;
+        
+		for(int i = 0; i < signal_count; ++i)
+		{
+			signals[i]->connect(slot, &session::on_event);
+		}
+	}
+    
+	double elapsed = now_ns() - start;
+    
+	printf("%d signals, %d live sessions: %.1f ns per session lifetime\n",
+		signal_count, live_sessions, elapsed / rounds);
+    
+	for(int i = 0; i < live_sessions; ++i)
+	{
+		delete sessions[i];
+	}
+    
+	for(int i = 0; i < signal_count; ++i)
+	{
+		delete signals[i];
+	}
+    
+	return 0;
+}
@@ -0,0 +1,134 @@
+// disconnect_scaling.cpp: measures how the cost of disconnecting one
+// receiver grows with the number of receivers connected to a signal.
+//
+// Build with, for example:
+//		g++ -O2 -I.. disconnect_scaling.cpp -o disconnect_scaling -lpthread
+//
+// Three ways of removing every receiver are timed, each in shuffled order:
+// destroying the receivers, disconnecting through the handles connect()
+// returned, and disconnecting by receiver pointer, which has to search.
+
+#include "sigslot.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <time.h>
+
+using namespace sigslot;
+
+class receiver : public has_slots<>
+{
+public:
+	void on_value(int)
+	{
+		;
+	}
+};
+
+static double now_ns()
+{
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+struct connected
+{
+	std::vector<receiver*> receivers;
+	std::vector<connection> handles;
+};
+
+static void connect_all(signal1<int>& sig, connected& c, size_t count)
+{
+	for(size_t i = 0; i < count; ++i)
+	{
+		c.receivers.push_back(new receiver);
+		c.handles.push_back(sig.connect(c.receivers.back(), &receiver::on_value));
+	}
+    
+	for(size_t i = count; i > 1; --i)
+	{
+		size_t j = rand() % i;
+		std::swap(c.receivers[i - 1], c.receivers[j]);
+		std::swap(c.handles[i - 1], c.handles[j]);
+	}
+}
+
+static double destroy_ns(size_t count)
+{
+	signal1<int> sig;
+	connected c;
+	connect_all(sig, c, count);
+    
+	double start = now_ns();
+    
+	for(size_t i = 0; i < count; ++i)
+	{
+		delete c.receivers[i];
+	}
+    
+	return (now_ns() - start) / count;
+}
+
+static double handle_ns(size_t count)
+{
+	signal1<int> sig;
+	connected c;
+	connect_all(sig, c, count);
+    
+	double start = now_ns();
+    
+	for(size_t i = 0; i < count; ++i)
+	{
+		sig.disconnect(c.handles[i]);
+	}
+    
+	double elapsed = now_ns() - start;
+    
+	for(size_t i = 0; i < count; ++i)
+	{
+		delete c.receivers[i];
+	}
+    
+	return elapsed / count;
+}
+
+static double pointer_ns(size_t count)
+{
+	signal1<int> sig;
+	connected c;
+	connect_all(sig, c, count);
+    
+	double start = now_ns();
+    
+	for(size_t i = 0; i < count; ++i)
+	{
+		sig.disconnect(c.receivers[i]);
+	}
+    
+	double elapsed = now_ns() - start;
+    
+	for(size_t i = 0; i < count; ++i)
+	{
+		delete c.receivers[i];
+	}
+    
+	return elapsed / count;
+}
+
+int main()
+{
+	static const size_t receiver_counts[] = { 100, 1000, 10000 };
+    
+	printf("%10s %14s %14s %14s\n", "receivers", "destroy ns", "handle ns", "pointer ns");
+    
+	for(size_t n = 0; n < sizeof(receiver_counts) / sizeof(receiver_counts[0]); ++n)
+	{
+		size_t count = receiver_counts[n];
+		printf("%10lu %14.1f %14.1f %14.1f\n", (unsigned long)count,
+			destroy_ns(count), handle_ns(count), pointer_ns(count));
+	}
+    
+	return 0;
+}
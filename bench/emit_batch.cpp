@@ -0,0 +1,122 @@
+// emit_batch.cpp: compares the per-event cost of a loop of emit() calls
+// with emit_batch() in event-major and slot-major order, and with a slot
+// that takes the whole batch as a span. The signal uses
+// multi_threaded_local, so the loop of emit() calls takes the lock once per
+// event and emit_batch() takes it once per batch.
+//
+// Build with, for example:
+//		g++ -O2 -I.. emit_batch.cpp -o emit_batch -lpthread
+
+#include "sigslot.h"
+
+#include <cstdio>
+#include <vector>
+#include <time.h>
+
+using namespace sigslot;
+
+typedef signal<int> int_signal;
+typedef int_signal::event_type int_event;
+
+class receiver : public has_slots<>
+{
+public:
+	receiver()
+    : m_total(0)
+	{
+		;
+	}
+    
+	void on_value(int value)
+	{
+		m_total += value;
+	}
+    
+	void on_values(const int_event* pevents, size_t count)
+	{
+		for(size_t i = 0; i < count; ++i)
+		{
+			m_total += std::get<0>(pevents[i]);
+		}
+	}
+    
+	long m_total;
+};
+
+static double now_ns()
+{
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+enum mode
+{
+	emit_loop,
+	batch_event_major,
+	batch_slot_major,
+	batch_span
+};
+
+static double ns_per_event(std::vector<receiver>& receivers, const std::vector<int_event>& events, int batches, mode m)
+{
+	int_signal sig;
+    
+	for(size_t i = 0; i < receivers.size(); ++i)
+	{
+		if(m == batch_span)
+		{
+			sig.connect(&receivers[i], &receiver::on_values);
+		}
+		else
+		{
+			sig.connect(&receivers[i], &receiver::on_value);
+		}
+	}
+    
+	double start = now_ns();
+    
+	for(int i = 0; i < batches; ++i)
+	{
+		if(m == emit_loop)
+		{
+			for(size_t e = 0; e < events.size(); ++e)
+			{
+				sig(std::get<0>(events[e]));
+			}
+		}
+		else
+		{
+			sig.emit_batch(&events[0], events.size(), m == batch_event_major ? event_major : slot_major);
+		}
+	}
+    
+	return (now_ns() - start) / (double(batches) * events.size());
+}
+
+int main()
+{
+	static const size_t slot_counts[] = { 1, 8, 64 };
+	static const size_t batch_sizes[] = { 1, 16, 256 };
+    
+	printf("%8s %8s %14s %14s %14s %14s\n", "slots", "batch", "emit ns/event", "event-major", "slot-major", "span");
+    
+	for(size_t n = 0; n < sizeof(slot_counts) / sizeof(slot_counts[0]); ++n)
+	{
+		for(size_t b = 0; b < sizeof(batch_sizes) / sizeof(batch_sizes[0]); ++b)
+		{
+			std::vector<receiver> receivers(slot_counts[n]);
+			std::vector<int_event> events(batch_sizes[b], int_event(1));
+			int batches = int(4000000 / (slot_counts[n] * batch_sizes[b])) + 100;
+			double loop_ns = ns_per_event(receivers, events, batches, emit_loop);
+			double event_ns = ns_per_event(receivers, events, batches, batch_event_major);
+			double slot_ns = ns_per_event(receivers, events, batches, batch_slot_major);
+			double span_ns = ns_per_event(receivers, events, batches, batch_span);
+    
+			printf("%8lu %8lu %14.2f %14.2f %14.2f %14.2f\n", (unsigned long)slot_counts[n],
+				(unsigned long)batch_sizes[b], loop_ns, event_ns, slot_ns, span_ns);
+		}
+	}
+    
+	return 0;
+}
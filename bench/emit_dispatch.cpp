@@ -0,0 +1,104 @@
+// emit_dispatch.cpp: compares the per-slot cost of emit() for slots
+// connected with connect(pclass, &method), which calls through a stored
+// member function pointer, with connect<type, &method>(pclass), whose
+// member function is bound at compile time, and with connect(lambda) for
+// a lambda that captures the receiver and calls the method.
+//
+// Build with, for example:
+//		g++ -O2 -I.. emit_dispatch.cpp -o emit_dispatch -lpthread
+
+#include "sigslot.h"
+
+#include <cstdio>
+#include <vector>
+#include <time.h>
+
+using namespace sigslot;
+
+class receiver : public has_slots<single_threaded>
+{
+public:
+	receiver()
+    : m_total(0)
+	{
+		;
+	}
+    
+	void on_value(int value)
+	{
+		m_total += value;
+	}
+    
+	long m_total;
+};
+
+static double now_ns()
+{
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+enum dispatch
+{
+	pointer,
+	bound,
+	lambda
+};
+
+static double emit_ns_per_slot(std::vector<receiver>& receivers, int emits, dispatch d)
+{
+	signal1<int, single_threaded, vector_storage> sig;
+    
+	for(size_t i = 0; i < receivers.size(); ++i)
+	{
+		receiver* precv = &receivers[i];
+        
+		if(d == bound)
+		{
+			sig.connect<receiver, &receiver::on_value>(precv);
+		}
+		else if(d == lambda)
+		{
+			sig.connect([precv](int value) { precv->on_value(value); });
+		}
+		else
+		{
+			sig.connect(precv, &receiver::on_value);
+		}
+	}
+    
+	for(int i = 0; i < emits / 10; ++i)
+	{
+		sig(1);
+	}
+    
+	double start = now_ns();
+    
+	for(int i = 0; i < emits; ++i)
+	{
+		sig(i);
+	}
+    
+	return (now_ns() - start) / (double(emits) * receivers.size());
+}
+
+int main()
+{
+	static const size_t slot_counts[] = { 1, 8, 64, 1024 };
+    
+	printf("%8s %16s %16s %16s\n", "slots", "pointer ns/slot", "bound ns/slot", "lambda ns/slot");
+    
+	for(size_t n = 0; n < sizeof(slot_counts) / sizeof(slot_counts[0]); ++n)
+	{
+		std::vector<receiver> receivers(slot_counts[n]);
+		int emits = int(4000000 / slot_counts[n]) + 1000;
+		double pointer_ns = emit_ns_per_slot(receivers, emits, pointer);
+		double bound_ns = emit_ns_per_slot(receivers, emits, bound);
+		double lambda_ns = emit_ns_per_slot(receivers, emits, lambda);
+        
+		printf("%8lu %16.2f %16.2f %16.2f\n", (unsigned long)slot_counts[n], pointer_ns, bound_ns, lambda_ns);
+	}
+    
+	return 0;
+}
@@ -0,0 +1,106 @@
+// emit_parallel.cpp: measures how emit_parallel() scales with the number of
+// threads in a thread_pool, for a signal whose slots each do a fixed amount
+// of arithmetic. The emit() row is a plain serial emit for reference, and
+// the speedup column is relative to it, so it can only reach the number of
+// processors the machine has.
+//
+// Build with, for example:
+//		g++ -O2 -I.. emit_parallel.cpp -o emit_parallel -lpthread
+
+#include "sigslot.h"
+
+#include <cstdio>
+#include <vector>
+#include <time.h>
+
+using namespace sigslot;
+
+class receiver : public has_slots<>
+{
+public:
+	receiver()
+    : m_state(1)
+	{
+		;
+	}
+    
+	void on_work(int rounds)
+	{
+		unsigned long state = m_state;
+        
+		for(int i = 0; i < rounds; ++i)
+		{
+			state = state * 6364136223846793005UL + 1442695040888963407UL;
+		}
+        
+		m_state = state;
+	}
+    
+	unsigned long m_state;
+};
+
+static double now_ns()
+{
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static double emit_us(signal<int>& sig, thread_pool* ppool, int rounds, int emits)
+{
+	double start = now_ns();
+    
+	for(int i = 0; i < emits; ++i)
+	{
+		if(ppool == NULL)
+		{
+			sig(rounds);
+		}
+		else
+		{
+			sig.emit_parallel(*ppool, rounds);
+		}
+	}
+    
+	return (now_ns() - start) / (1e3 * emits);
+}
+
+int main()
+{
+	static const size_t slots = 256;
+	static const int rounds[] = { 100, 10000 };
+	size_t max_threads = thread_pool().concurrency();
+    
+	if(max_threads < 8)
+	{
+		max_threads = 8;
+	}
+    
+	std::vector<receiver> receivers(slots);
+	signal<int> sig;
+    
+	for(size_t i = 0; i < receivers.size(); ++i)
+	{
+		sig.connect(&receivers[i], &receiver::on_work);
+	}
+    
+	printf("%8s %8s %14s %10s\n", "rounds", "threads", "us/emit", "speedup");
+    
+	for(size_t r = 0; r < sizeof(rounds) / sizeof(rounds[0]); ++r)
+	{
+		int emits = int(20000000 / (rounds[r] * slots)) + 10;
+		double serial_us = emit_us(sig, NULL, rounds[r], emits);
+        
+		printf("%8d %8s %14.2f %10.2f\n", rounds[r], "emit()", serial_us, 1.0);
+        
+		for(size_t threads = 1; threads <= max_threads; threads *= 2)
+		{
+			thread_pool pool(threads);
+			double parallel_us = emit_us(sig, &pool, rounds[r], emits);
+            
+			printf("%8d %8lu %14.2f %10.2f\n", rounds[r], (unsigned long)threads, parallel_us, serial_us / parallel_us);
+		}
+	}
+    
+	return 0;
+}
@@ -0,0 +1,114 @@
+// emit_storage.cpp: compares the per-slot cost of emit() for list_storage
+// and vector_storage.
+//
+// Build with, for example:
+//		g++ -O2 -I.. emit_storage.cpp -o emit_storage -lpthread
+//
+// Receivers are allocated with unrelated allocations in between them, and
+// connected in shuffled order, so that neither layout gets the benefit of
+// neighbouring heap blocks the way it would in a freshly started program.
+
+#include "sigslot.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <time.h>
+
+using namespace sigslot;
+
+class receiver : public has_slots<single_threaded>
+{
+public:
+	receiver()
+    : m_total(0)
+	{
+		;
+	}
+    
+	void on_value(int value)
+	{
+		m_total += value;
+	}
+    
+	long m_total;
+};
+
+static double now_ns()
+{
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+template<class storage_policy>
+static double emit_ns_per_slot(const std::vector<receiver*>& receivers, int emits)
+{
+	signal1<int, single_threaded, storage_policy> sig;
+	std::vector<void*> padding;
+    
+	for(size_t i = 0; i < receivers.size(); ++i)
+	{
+		sig.connect(receivers[i], &receiver::on_value);
+		padding.push_back(malloc(64 + (rand() % 256)));
+	}
+    
+	for(int i = 0; i < emits / 10; ++i)
+	{
+		sig(1);
+	}
+    
+	double start = now_ns();
+    
+	for(int i = 0; i < emits; ++i)
+	{
+		sig(i);
+	}
+    
+	double elapsed = now_ns() - start;
+    
+	for(size_t i = 0; i < padding.size(); ++i)
+	{
+		free(padding[i]);
+	}
+    
+	return elapsed / (double(emits) * receivers.size());
+}
+
+int main()
+{
+	static const size_t slot_counts[] = { 1, 8, 20, 64, 200, 1024 };
+    
+	printf("%8s %14s %14s\n", "slots", "list ns/slot", "vector ns/slot");
+    
+	for(size_t n = 0; n < sizeof(slot_counts) / sizeof(slot_counts[0]); ++n)
+	{
+		std::vector<receiver*> receivers;
+		std::vector<void*> padding;
+        
+		for(size_t i = 0; i < slot_counts[n]; ++i)
+		{
+			receivers.push_back(new receiver);
+			padding.push_back(malloc(64 + (rand() % 256)));
+		}
+        
+		for(size_t i = receivers.size(); i > 1; --i)
+		{
+			std::swap(receivers[i - 1], receivers[rand() % i]);
+		}
+        
+		int emits = int(2000000 / slot_counts[n]) + 1000;
+		double list_ns = emit_ns_per_slot<list_storage>(receivers, emits);
+		double vector_ns = emit_ns_per_slot<vector_storage>(receivers, emits);
+        
+		printf("%8lu %14.2f %14.2f\n", (unsigned long)slot_counts[n], list_ns, vector_ns);
+        
+		for(size_t i = 0; i < receivers.size(); ++i)
+		{
+			delete receivers[i];
+			free(padding[i]);
+		}
+	}
+    
+	return 0;
+}
@@ -0,0 +1,91 @@
+// emit_trace.cpp: the cost of emit_tracing, which this file selects as the
+// instrumentation policy. Reports the per-slot cost of emit() while every
+// slot call is recorded, and the cost per record of write_chrome_trace()
+// writing them out. Build emit_dispatch for the cost of emit() without it.
+//
+// Build with, for example:
+//		g++ -O2 -I.. emit_trace.cpp -o emit_trace -lpthread
+
+#define SIGSLOT_INSTRUMENTATION_POLICY sigslot::emit_tracing
+#include "sigslot.h"
+
+#include <cstdio>
+#include <vector>
+#include <time.h>
+
+using namespace sigslot;
+
+class receiver : public has_slots<single_threaded>
+{
+public:
+	receiver()
+    : m_total(0)
+	{
+		;
+	}
+    
+	void on_value(int value)
+	{
+		m_total += value;
+	}
+    
+	long m_total;
+};
+
+static double now_ns()
+{
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+int main()
+{
+	static const size_t slot_counts[] = { 1, 8, 64 };
+	FILE* pnull = fopen("/dev/null", "w");
+    
+	if(pnull == NULL)
+	{
+		return 1;
+	}
+    
+	printf("%8s %16s %18s\n", "slots", "emit ns/slot", "write ns/record");
+    
+	for(size_t n = 0; n < sizeof(slot_counts) / sizeof(slot_counts[0]); ++n)
+	{
+		std::vector<receiver> receivers(slot_counts[n]);
+		signal1<int, single_threaded, vector_storage> sig;
+        
+		for(size_t i = 0; i < receivers.size(); ++i)
+		{
+			sig.connect(&receivers[i], &receiver::on_value);
+		}
+        
+		// Each round fits the thread's buffer, so that nothing is dropped.
+		int emits = int(SIGSLOT_TRACE_RECORDS / (slot_counts[n] + 1));
+		double emit_ns = 0;
+		double write_ns = 0;
+		size_t records = 0;
+        
+		for(int round = 0; round < 200; ++round)
+		{
+			double start = now_ns();
+            
+			for(int i = 0; i < emits; ++i)
+			{
+				sig(i);
+			}
+            
+			double written = now_ns();
+			records += emit_tracing::write_chrome_trace(pnull);
+			emit_ns += written - start;
+			write_ns += now_ns() - written;
+		}
+        
+		printf("%8lu %16.2f %18.2f\n", (unsigned long)slot_counts[n], emit_ns / (200.0 * emits * slot_counts[n]),
+			write_ns / double(records));
+	}
+    
+	fclose(pnull);
+	return 0;
+}
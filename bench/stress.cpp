@@ -0,0 +1,577 @@
+// stress.cpp: emitters, connectors and has_slots destroyers running at
+// once against the same signals, for every threading policy and from 1 to
+// 64 threads. Threads take the roles in turn: emitter, destroyer,
+// connector, emitter, and so on.
+//
+//		emitter			- emits the shared signals in turn, timing each emit()
+//		destroyer		- creates a receiver, connects it to several of the
+//						  signals, disconnects it with disconnect_all() and
+//						  destroys it
+//		connector		- connects receivers of its own to the signals and
+//						  disconnects them again by handle
+//
+// Every signal also has receivers that stay connected throughout. Results
+// go to stdout as CSV, one row per policy and thread count:
+//
+//		policy,threads,emits_per_s,connects_per_s,teardowns_per_s,p50_ns,p99_ns,p999_ns
+//
+// The latencies are of single emit() calls, to the nearest 1/16 of a power
+// of two. Pass a policy name to run just that one, and --check for the
+// checking mode: shorter runs, a check in every slot that its receiver
+// has not been destroyed, and after each run a check that every emit
+// reached each receiver that stays connected and that the signals still
+// take new connections. It then checks that slots run by emit_parallel()
+// can disconnect themselves, destroy their receivers and emit again,
+// under the policies that allow it. It exits with 1 if a check fails. "make check"
+// runs it built with ThreadSanitizer, which also catches races in the
+// teardown paths, slots left connected to freed receivers and lock order
+// inversions other than the one tsan.supp names.
+//
+// Build with "make" in this directory, or for example:
+//		g++ -O2 -I.. stress.cpp -o stress -lpthread
+
+#include "sigslot.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <pthread.h>
+#include <sched.h>
+#include <vector>
+#include <time.h>
+
+using namespace sigslot;
+
+static double now_ns()
+{
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static const char* policy_name(multi_threaded_global*)
+{
+	return "global";
+}
+
+static const char* policy_name(multi_threaded_local*)
+{
+	return "local";
+}
+
+static const char* policy_name(multi_threaded_adaptive*)
+{
+	return "adaptive";
+}
+
+static const char* policy_name(multi_threaded_rw*)
+{
+	return "rw";
+}
+
+static const char* policy_name(multi_threaded_cow*)
+{
+	return "cow";
+}
+
+static bool g_check = false;
+static volatile long g_failures = 0;
+
+static void check(bool ok, const char* policy, const char* what)
+{
+	if(!ok)
+	{
+		fprintf(stderr, "check failed: %s: %s\n", policy, what);
+		__atomic_add_fetch(&g_failures, 1, __ATOMIC_SEQ_CST);
+	}
+}
+
+// Emit latencies in buckets of 1/16 of a power of two: values below 16ns
+// have a bucket each, and each power of two above that has 16.
+class latency_histogram
+{
+public:
+	enum { sub_buckets = 16, buckets = sub_buckets * 40 };
+    
+	latency_histogram()
+    : m_counts(buckets, 0), m_total(0)
+	{
+		;
+	}
+    
+	void add(double ns)
+	{
+		unsigned long value = ns > 0 ? (unsigned long)ns : 0;
+		size_t bucket = value;
+    
+		if(value >= sub_buckets)
+		{
+			int exponent = 63 - __builtin_clzl(value);
+			bucket = sub_buckets * (exponent - 3) + ((value >> (exponent - 4)) & (sub_buckets - 1));
+		}
+    
+		++m_counts[std::min<size_t>(bucket, buckets - 1)];
+		++m_total;
+	}
+    
+	void merge(const latency_histogram& other)
+	{
+		for(size_t i = 0; i < buckets; ++i)
+		{
+			m_counts[i] += other.m_counts[i];
+		}
+    
+		m_total += other.m_total;
+	}
+    
+	// The lowest value in the bucket that holds the given fraction.
+	double percentile(double fraction) const
+	{
+		unsigned long long wanted = (unsigned long long)(fraction * m_total);
+		unsigned long long seen = 0;
+    
+		for(size_t i = 0; i < buckets; ++i)
+		{
+			seen += m_counts[i];
+    
+			if(seen > wanted)
+			{
+				return lowest(i);
+			}
+		}
+    
+		return 0;
+	}
+    
+private:
+	static double lowest(size_t bucket)
+	{
+		if(bucket < sub_buckets)
+		{
+			return double(bucket);
+		}
+    
+		int exponent = int(bucket / sub_buckets) + 3;
+		return double((sub_buckets + bucket % sub_buckets) << (exponent - 4));
+	}
+    
+	std::vector<unsigned long long> m_counts;
+	unsigned long long m_total;
+};
+
+enum { alive_mark = 0x51075, dead_mark = 0xdead };
+
+template<class mt_policy>
+class receiver : public has_slots<mt_policy>
+{
+public:
+	receiver()
+    : m_mark(alive_mark), m_calls(0)
+	{
+		;
+	}
+    
+	~receiver()
+	{
+		m_mark = dead_mark;
+	}
+    
+	void on_value(int)
+	{
+		if(m_mark != alive_mark)
+		{
+			__atomic_add_fetch(&g_failures, 1, __ATOMIC_SEQ_CST);
+		}
+    
+		__atomic_add_fetch(&m_calls, 1, __ATOMIC_RELAXED);
+	}
+    
+	volatile int m_mark;
+	long m_calls;
+};
+
+template<class mt_policy>
+class stress_run
+{
+public:
+	enum { signals = 16, fixed_receivers = 8, destroyer_signals = 4, connector_receivers = 4 };
+    
+	typedef basic_signal<mt_policy, list_storage, int> signal_type;
+	typedef receiver<mt_policy> receiver_type;
+    
+	stress_run(int threads, double duration_ns)
+    : m_signals(signals), m_fixed(signals * fixed_receivers), m_threads(threads), m_duration_ns(duration_ns),
+	m_started(0), m_stop(0), m_emits(0), m_connects(0), m_teardowns(0)
+	{
+		for(size_t s = 0; s < signals; ++s)
+		{
+			m_emit_counts[s] = 0;
+    
+			for(size_t r = 0; r < fixed_receivers; ++r)
+			{
+				m_signals[s].connect(&m_fixed[s * fixed_receivers + r], &receiver_type::on_value);
+			}
+		}
+	}
+    
+	void run()
+	{
+		std::vector<pthread_t> threads(m_threads);
+		std::vector<worker> workers(m_threads);
+    
+		for(int i = 0; i < m_threads; ++i)
+		{
+			workers[i].m_prun = this;
+			workers[i].m_index = i;
+			pthread_create(&threads[i], NULL, &work, &workers[i]);
+		}
+    
+		// The workers wait until every thread exists, so that the first
+		// ones do not run alone while the rest are being created.
+		double start = now_ns();
+		__atomic_store_n(&m_started, 1, __ATOMIC_SEQ_CST);
+    
+		while(now_ns() - start < m_duration_ns)
+		{
+			timespec pause = { 0, 1000000 };
+			nanosleep(&pause, NULL);
+		}
+    
+		__atomic_store_n(&m_stop, 1, __ATOMIC_SEQ_CST);
+    
+		for(int i = 0; i < m_threads; ++i)
+		{
+			pthread_join(threads[i], NULL);
+			m_latency.merge(workers[i].m_latency);
+		}
+    
+		m_elapsed_ns = now_ns() - start;
+	}
+    
+	// Every emit reached each fixed receiver of its signal, and a receiver
+	// connected now sees the next emit alongside them.
+	void verify()
+	{
+		const char* policy = policy_name((mt_policy*)NULL);
+    
+		for(size_t s = 0; s < signals; ++s)
+		{
+			for(size_t r = 0; r < fixed_receivers; ++r)
+			{
+				check(m_fixed[s * fixed_receivers + r].m_calls == m_emit_counts[s], policy,
+					"a fixed receiver missed an emit");
+			}
+    
+			receiver_type probe;
+			m_signals[s].connect(&probe, &receiver_type::on_value);
+			m_signals[s](0);
+			m_signals[s].disconnect_all();
+    
+			check(probe.m_calls == 1, policy, "a receiver connected after the run missed an emit");
+			check(m_fixed[s * fixed_receivers].m_calls == m_emit_counts[s] + 1, policy,
+				"a fixed receiver was lost");
+		}
+	}
+    
+	void report() const
+	{
+		double seconds = m_elapsed_ns / 1e9;
+		printf("%s,%d,%.0f,%.0f,%.0f,%.0f,%.0f,%.0f\n", policy_name((mt_policy*)NULL), m_threads, m_emits / seconds,
+			m_connects / seconds, m_teardowns / seconds, m_latency.percentile(0.5), m_latency.percentile(0.99),
+			m_latency.percentile(0.999));
+	}
+    
+private:
+	struct worker
+	{
+		stress_run* m_prun;
+		int m_index;
+		latency_histogram m_latency;
+	};
+    
+	bool stopping() const
+	{
+		return __atomic_load_n(&m_stop, __ATOMIC_RELAXED) != 0;
+	}
+    
+	static void* work(void* pcontext)
+	{
+		worker* pworker = static_cast<worker*>(pcontext);
+		stress_run* pself = pworker->m_prun;
+    
+		while(__atomic_load_n(&pself->m_started, __ATOMIC_ACQUIRE) == 0)
+		{
+			sched_yield();
+		}
+    
+		switch(pworker->m_index % 4)
+		{
+		case 1:
+			pself->destroy(pworker->m_index);
+			break;
+    
+		case 2:
+			pself->connect(pworker->m_index);
+			break;
+    
+		default:
+			pself->emit(pworker->m_index, pworker->m_latency);
+			break;
+		}
+    
+		return NULL;
+	}
+    
+	void emit(int index, latency_histogram& latency)
+	{
+		long emits = 0;
+    
+		for(size_t s = index % signals; !stopping(); s = (s + 1) % signals)
+		{
+			double start = now_ns();
+			m_signals[s](int(s));
+			latency.add(now_ns() - start);
+			++emits;
+    
+			if(g_check)
+			{
+				__atomic_add_fetch(&m_emit_counts[s], 1, __ATOMIC_RELAXED);
+			}
+		}
+    
+		__atomic_add_fetch(&m_emits, emits, __ATOMIC_RELAXED);
+	}
+    
+	void destroy(int index)
+	{
+		long teardowns = 0;
+    
+		for(size_t s = index % signals; !stopping(); s = (s + 1) % signals)
+		{
+			receiver_type* precv = new receiver_type;
+    
+			for(size_t i = 0; i < destroyer_signals; ++i)
+			{
+				m_signals[(s + i) % signals].connect(precv, &receiver_type::on_value);
+			}
+    
+			// By the time disconnect_all() returns, no slot may still be
+			// running on the receiver, so marking it dead is safe.
+			precv->disconnect_all();
+			delete precv;
+			++teardowns;
+		}
+    
+		__atomic_add_fetch(&m_teardowns, teardowns, __ATOMIC_RELAXED);
+	}
+    
+	void connect(int index)
+	{
+		std::vector<receiver_type> receivers(connector_receivers);
+		connection handles[connector_receivers];
+		long connects = 0;
+    
+		for(size_t s = index % signals; !stopping(); s = (s + 1) % signals)
+		{
+			for(size_t r = 0; r < connector_receivers; ++r)
+			{
+				handles[r] = m_signals[(s + r) % signals].connect(&receivers[r], &receiver_type::on_value);
+			}
+    
+			for(size_t r = 0; r < connector_receivers; ++r)
+			{
+				m_signals[(s + r) % signals].disconnect(handles[r]);
+			}
+    
+			connects += connector_receivers;
+		}
+    
+		__atomic_add_fetch(&m_connects, connects, __ATOMIC_RELAXED);
+	}
+    
+	std::vector<signal_type> m_signals;
+	std::vector<receiver_type> m_fixed;
+	int m_threads;
+	double m_duration_ns;
+	double m_elapsed_ns;
+	volatile long m_started;
+	volatile long m_stop;
+	long m_emits;
+	long m_connects;
+	long m_teardowns;
+	long m_emit_counts[signals];
+	latency_histogram m_latency;
+};
+
+// A receiver for the emit_parallel() check. Its slot does one of the
+// things that a slot run there may do with the emitting signal.
+template<class mt_policy>
+class parallel_receiver : public has_slots<mt_policy>
+{
+public:
+	enum action { disconnect_self, destroy_self, emit_again };
+	typedef basic_signal<mt_policy, list_storage, int> signal_type;
+    
+	parallel_receiver(signal_type* psignal, action act, long* pcalls)
+    : m_psignal(psignal), m_action(act), m_pcalls(pcalls)
+	{
+		m_connection = psignal->connect(this, &parallel_receiver::on_value);
+	}
+    
+	void on_value(int depth)
+	{
+		__atomic_add_fetch(m_pcalls, 1, __ATOMIC_RELAXED);
+    
+		switch(m_action)
+		{
+		case disconnect_self:
+			m_psignal->disconnect(m_connection);
+			break;
+    
+		case destroy_self:
+			delete this;
+			break;
+    
+		case emit_again:
+			if(depth == 0)
+			{
+				m_psignal->emit(1);
+			}
+			break;
+		}
+	}
+    
+private:
+	signal_type* m_psignal;
+	action m_action;
+	long* m_pcalls;
+	connection m_connection;
+};
+
+// Checks that slots run by emit_parallel() can disconnect themselves,
+// destroy their receivers and emit the signal again without deadlocking
+// on the lock the emitting thread holds.
+template<class mt_policy>
+static void check_parallel(const char* only)
+{
+	typedef parallel_receiver<mt_policy> receiver_type;
+	enum { receivers = 64 };
+	const char* policy = policy_name((mt_policy*)NULL);
+    
+	if(only != NULL && strcmp(only, policy) != 0)
+	{
+		return;
+	}
+    
+	thread_pool pool(4);
+    
+	{
+		typename receiver_type::signal_type sig;
+		long calls[receivers] = { 0 };
+		std::vector<receiver_type*> kept;
+    
+		for(int i = 0; i < receivers; ++i)
+		{
+			if(i % 2 == 0)
+			{
+				kept.push_back(new receiver_type(&sig, receiver_type::disconnect_self, &calls[i]));
+			}
+			else
+			{
+				new receiver_type(&sig, receiver_type::destroy_self, &calls[i]);
+			}
+		}
+    
+		sig.emit_parallel(pool, 0);
+		sig.emit_parallel(pool, 0);
+    
+		for(int i = 0; i < receivers; ++i)
+		{
+			check(calls[i] == 1, policy, "emit_parallel() slot that removed itself");
+		}
+    
+		for(size_t i = 0; i < kept.size(); ++i)
+		{
+			delete kept[i];
+		}
+	}
+    
+	{
+		typename receiver_type::signal_type sig;
+		long calls = 0;
+		std::vector<receiver_type*> kept;
+    
+		for(int i = 0; i < receivers; ++i)
+		{
+			kept.push_back(new receiver_type(&sig, receiver_type::emit_again, &calls));
+		}
+    
+		sig.emit_parallel(pool, 0);
+		check(calls == receivers * (receivers + 1), policy, "emit_parallel() slot that emits again");
+    
+		for(size_t i = 0; i < kept.size(); ++i)
+		{
+			delete kept[i];
+		}
+	}
+}
+
+template<class mt_policy>
+static void run_policy(const char* only)
+{
+	static const int thread_counts[] = { 1, 2, 4, 8, 16, 32, 64 };
+    
+	if(only != NULL && strcmp(only, policy_name((mt_policy*)NULL)) != 0)
+	{
+		return;
+	}
+    
+	for(size_t n = 0; n < sizeof(thread_counts) / sizeof(thread_counts[0]); ++n)
+	{
+		stress_run<mt_policy> run(thread_counts[n], g_check ? 20e6 : 200e6);
+		run.run();
+    
+		if(g_check)
+		{
+			run.verify();
+		}
+    
+		run.report();
+		fflush(stdout);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const char* only = NULL;
+    
+	for(int i = 1; i < argc; ++i)
+	{
+		if(strcmp(argv[i], "--check") == 0)
+		{
+			g_check = true;
+		}
+		else
+		{
+			only = argv[i];
+		}
+	}
+    
+	printf("policy,threads,emits_per_s,connects_per_s,teardowns_per_s,p50_ns,p99_ns,p999_ns\n");
+    
+	run_policy<multi_threaded_global>(only);
+	run_policy<multi_threaded_local>(only);
+	run_policy<multi_threaded_adaptive>(only);
+	run_policy<multi_threaded_rw>(only);
+	run_policy<multi_threaded_cow>(only);
+    
+	if(g_check)
+	{
+		check_parallel<multi_threaded_global>(only);
+		check_parallel<multi_threaded_local>(only);
+		check_parallel<multi_threaded_adaptive>(only);
+	}
+    
+	return g_failures != 0 ? 1 : 0;
+}
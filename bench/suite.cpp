@@ -0,0 +1,994 @@
+// suite.cpp: the benchmark suite. Each benchmark runs a fixed amount of
+// work five times after a warm up, and reports the median, so that runs
+// on the same machine can be compared. Results go to stdout as CSV with
+// a header line, one row per measurement:
+//
+//		benchmark,policy,storage,arity,slots,threads,ns_per_op
+//
+// For teardown, slots is the number of signals each receiver is connected
+// to; benchmarks that use a single int argument report arity 1. Pass a
+// benchmark name as the only argument to run just that one:
+//
+//		emit			- one emit() to every slot, by slot count and arity
+//		churn			- one connect() plus disconnect() of its handle on a
+//						  signal that already has 64 connections
+//		teardown		- destroying a has_slots connected to many signals,
+//						  per connection; the "teardown_weak" rows destroy a
+//						  has_weak_slots instead
+//		copy			- copy constructing a signal and destroying the copy,
+//						  per connection
+//		move			- move constructing a signal and moving it back, per
+//						  connection
+//		handled			- emit_until_handled() on a signal whose highest
+//						  priority slot handles the call, per emit
+//		queued			- emit() to slots queued on 4 dispatchers, then
+//						  dispatching them, per emit, by slot count
+//		routed			- the same with emit_routed(), which posts one event
+//						  per dispatcher rather than one per slot
+//		bulk			- connect_many() of a set of receivers and then
+//						  disconnect_many() of their handles, per connection,
+//						  by receiver count; the "bulk_loop" rows make the
+//						  same changes one connect() and disconnect() at a time
+//		static			- emit() to 4 slots wired in with static_signal, per
+//						  emit; storage "vector" is the same slots connected at
+//						  run time with connect<type, &method>()
+//		coalesced		- emit() to slots connected with coalesced_on, with a
+//						  dispatch() after every 1000 emits, per emit, by slot
+//						  count; storage "queued" is the same with queued_on
+//		hub				- emit(key) by string key on a signal_hub, per emit, by
+//						  topic count, each topic with one slot; storage
+//						  "map" is the same through a std::map of signals
+//		contended		- emit() from several threads at once on one signal
+//						  with 8 slots, per emit, by threading policy
+//
+// Build with "make" in this directory, or for example:
+//		g++ -O2 -I.. suite.cpp -o suite -lpthread
+
+#include "sigslot.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <pthread.h>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <time.h>
+
+using namespace sigslot;
+
+// Footprint: a signal nothing has connected to is a single pointer, a
+// policy adds to has_slots only what its lock itself takes, and a
+// has_slots with no connections pays for SIGSLOT_INLINE_SENDERS links.
+static_assert(sizeof(signal<int>) == sizeof(void*), "an empty signal is one pointer");
+static_assert(sizeof(basic_signal<multi_threaded_rw, vector_storage, int, int>) == sizeof(void*),
+	"an empty signal is one pointer whatever its policies");
+static_assert(std::is_empty<single_threaded>::value, "single_threaded takes no space");
+static_assert(!std::is_polymorphic<multi_threaded_local>::value, "policies have no vtable");
+static_assert(sizeof(has_slots<multi_threaded_local>) == sizeof(has_slots<single_threaded>) + sizeof(multi_threaded_local),
+	"has_slots adds nothing for its policy beyond the lock");
+static_assert(sizeof(has_slots<single_threaded>) <= 3 * sizeof(void*) + 2 * sizeof(unsigned int) +
+	SIGSLOT_INLINE_SENDERS * sizeof(_sender_link<single_threaded>),
+	"an idle has_slots is its vtable and dispatcher pointers, its link counts and its inline links");
+
+static double now_ns()
+{
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void report(const char* benchmark, const char* policy, const char* storage,
+	int arity, size_t slots, int threads, double ns_per_op)
+{
+	printf("%s,%s,%s,%d,%lu,%d,%.2f\n", benchmark, policy, storage, arity, (unsigned long)slots, threads, ns_per_op);
+	fflush(stdout);
+}
+
+// Runs bench() once to warm up and then five more times, and returns the
+// median of the five in nanoseconds per op.
+template<class bench_type>
+static double median_ns(bench_type& bench, double ops)
+{
+	static const int runs = 5;
+	double results[runs];
+	bench();
+    
+	for(int i = 0; i < runs; ++i)
+	{
+		double start = now_ns();
+		bench();
+		results[i] = (now_ns() - start) / ops;
+	}
+    
+	std::sort(results, results + runs);
+	return results[runs / 2];
+}
+
+static const char* policy_name(multi_threaded_global*)
+{
+	return "global";
+}
+
+static const char* policy_name(multi_threaded_local*)
+{
+	return "local";
+}
+
+static const char* policy_name(multi_threaded_adaptive*)
+{
+	return "adaptive";
+}
+
+static const char* policy_name(multi_threaded_rw*)
+{
+	return "rw";
+}
+
+static const char* policy_name(multi_threaded_cow*)
+{
+	return "cow";
+}
+
+static const char* storage_name(list_storage*)
+{
+	return "list";
+}
+
+static const char* storage_name(vector_storage*)
+{
+	return "vector";
+}
+
+template<class mt_policy>
+class receiver : public has_slots<mt_policy>
+{
+public:
+	receiver()
+    : m_total(0)
+	{
+		;
+	}
+    
+	template<class... arg_types>
+	void on_ints(arg_types... args)
+	{
+		int values[] = { 0, args... };
+		m_total += values[sizeof...(args)];
+	}
+    
+	bool on_claim(int value)
+	{
+		m_total += value;
+		return true;
+	}
+    
+	long m_total;
+};
+
+class weak_receiver : public has_weak_slots
+{
+public:
+	weak_receiver()
+    : m_total(0)
+	{
+		;
+	}
+    
+	void on_int(int value)
+	{
+		m_total += value;
+	}
+    
+	long m_total;
+};
+
+// basic_signal with arity int arguments.
+template<class mt_policy, class storage_policy, int arity, class... arg_types>
+struct int_signal : int_signal<mt_policy, storage_policy, arity - 1, int, arg_types...>
+{
+};
+
+template<class mt_policy, class storage_policy, class... arg_types>
+struct int_signal<mt_policy, storage_policy, 0, arg_types...>
+{
+	typedef basic_signal<mt_policy, storage_policy, arg_types...> type;
+    
+	static void connect(type& sig, receiver<mt_policy>* precv)
+	{
+		void (receiver<mt_policy>::* pmemfun)(arg_types...) = &receiver<mt_policy>::template on_ints<arg_types...>;
+		sig.connect(precv, pmemfun);
+	}
+    
+	static void emit(type& sig)
+	{
+		sig.emit(arg_types(1)...);
+	}
+};
+
+// emit
+template<class storage_policy, int arity>
+class emit_bench
+{
+public:
+	typedef int_signal<multi_threaded_local, storage_policy, arity> signal_info;
+    
+	emit_bench(std::vector<receiver<multi_threaded_local> >& receivers, int emits)
+    : m_emits(emits)
+	{
+		for(size_t i = 0; i < receivers.size(); ++i)
+		{
+			signal_info::connect(m_sig, &receivers[i]);
+		}
+	}
+    
+	void operator()()
+	{
+		for(int i = 0; i < m_emits; ++i)
+		{
+			signal_info::emit(m_sig);
+		}
+	}
+    
+private:
+	typename signal_info::type m_sig;
+	int m_emits;
+};
+
+template<class storage_policy, int arity>
+static void run_emit_arity()
+{
+	static const size_t slot_counts[] = { 0, 1, 8, 64, 1024 };
+    
+	for(size_t n = 0; n < sizeof(slot_counts) / sizeof(slot_counts[0]); ++n)
+	{
+		std::vector<receiver<multi_threaded_local> > receivers(slot_counts[n]);
+		int emits = int(200000 / (slot_counts[n] + 1)) + 100;
+		emit_bench<storage_policy, arity> bench(receivers, emits);
+		report("emit", "local", storage_name((storage_policy*)NULL), arity, slot_counts[n], 1, median_ns(bench, emits));
+	}
+}
+
+template<class storage_policy>
+static void run_emit()
+{
+	run_emit_arity<storage_policy, 0>();
+	run_emit_arity<storage_policy, 1>();
+	run_emit_arity<storage_policy, 2>();
+	run_emit_arity<storage_policy, 3>();
+	run_emit_arity<storage_policy, 4>();
+	run_emit_arity<storage_policy, 5>();
+	run_emit_arity<storage_policy, 6>();
+	run_emit_arity<storage_policy, 7>();
+	run_emit_arity<storage_policy, 8>();
+}
+
+// churn
+template<class storage_policy>
+class churn_bench
+{
+public:
+	enum { existing = 64, rounds = 20000 };
+    
+	churn_bench()
+    : m_receivers(existing + 1)
+	{
+		for(size_t i = 0; i < existing; ++i)
+		{
+			m_sig.connect(&m_receivers[i], &receiver<multi_threaded_local>::on_ints<int>);
+		}
+	}
+    
+	void operator()()
+	{
+		receiver<multi_threaded_local>* precv = &m_receivers[existing];
+    
+		for(int i = 0; i < rounds; ++i)
+		{
+			m_sig.disconnect(m_sig.connect(precv, &receiver<multi_threaded_local>::on_ints<int>));
+		}
+	}
+    
+private:
+	std::vector<receiver<multi_threaded_local> > m_receivers;
+	basic_signal<multi_threaded_local, storage_policy, int> m_sig;
+};
+
+template<class storage_policy>
+static void run_churn()
+{
+	churn_bench<storage_policy> bench;
+	report("churn", "local", storage_name((storage_policy*)NULL), 1, churn_bench<storage_policy>::existing, 1,
+		median_ns(bench, churn_bench<storage_policy>::rounds));
+}
+
+// teardown
+template<class storage_policy, class receiver_type>
+class teardown_bench
+{
+public:
+	enum { receivers = 200 };
+    
+	explicit teardown_bench(size_t senders)
+    : m_signals(senders)
+	{
+		;
+	}
+    
+	// Connecting is not timed: only the loop that destroys the receivers.
+	void operator()()
+	{
+		std::vector<receiver_type*> precvs;
+    
+		for(int r = 0; r < receivers; ++r)
+		{
+			precvs.push_back(new receiver_type);
+    
+			for(size_t s = 0; s < m_signals.size(); ++s)
+			{
+				connect(m_signals[s], precvs.back());
+			}
+		}
+    
+		double start = now_ns();
+    
+		for(int r = 0; r < receivers; ++r)
+		{
+			delete precvs[r];
+		}
+    
+		m_elapsed_ns = now_ns() - start;
+	}
+    
+	double m_elapsed_ns;
+    
+private:
+	typedef basic_signal<multi_threaded_local, storage_policy, int> signal_type;
+    
+	static void connect(signal_type& sig, receiver<multi_threaded_local>* precv)
+	{
+		sig.connect(precv, &receiver<multi_threaded_local>::on_ints<int>);
+	}
+    
+	static void connect(signal_type& sig, weak_receiver* precv)
+	{
+		sig.connect(precv, &weak_receiver::on_int);
+	}
+    
+	std::vector<signal_type> m_signals;
+};
+
+template<class storage_policy, class receiver_type>
+static void run_teardown(const char* name)
+{
+	static const size_t sender_counts[] = { 1, 16, 256 };
+	static const int runs = 5;
+    
+	for(size_t n = 0; n < sizeof(sender_counts) / sizeof(sender_counts[0]); ++n)
+	{
+		teardown_bench<storage_policy, receiver_type> bench(sender_counts[n]);
+		double results[runs];
+		bench();
+    
+		for(int i = 0; i < runs; ++i)
+		{
+			bench();
+			results[i] = bench.m_elapsed_ns / (double(teardown_bench<storage_policy, receiver_type>::receivers) * sender_counts[n]);
+		}
+    
+		std::sort(results, results + runs);
+		report(name, "local", storage_name((storage_policy*)NULL), 1, sender_counts[n], 1, results[runs / 2]);
+	}
+}
+
+// copy
+template<class storage_policy>
+class copy_bench
+{
+public:
+	copy_bench(std::vector<receiver<multi_threaded_local> >& receivers, int copies)
+    : m_copies(copies)
+	{
+		for(size_t i = 0; i < receivers.size(); ++i)
+		{
+			m_sig.connect(&receivers[i], &receiver<multi_threaded_local>::on_ints<int>);
+		}
+	}
+    
+	void operator()()
+	{
+		for(int i = 0; i < m_copies; ++i)
+		{
+			basic_signal<multi_threaded_local, storage_policy, int> copy(m_sig);
+		}
+	}
+    
+private:
+	basic_signal<multi_threaded_local, storage_policy, int> m_sig;
+	int m_copies;
+};
+
+template<class storage_policy>
+static void run_copy()
+{
+	static const size_t slot_counts[] = { 1, 64, 1024 };
+    
+	for(size_t n = 0; n < sizeof(slot_counts) / sizeof(slot_counts[0]); ++n)
+	{
+		std::vector<receiver<multi_threaded_local> > receivers(slot_counts[n]);
+		int copies = int(100000 / slot_counts[n]) + 10;
+		copy_bench<storage_policy> bench(receivers, copies);
+		report("copy", "local", storage_name((storage_policy*)NULL), 1, slot_counts[n], 1,
+			median_ns(bench, double(copies) * slot_counts[n]));
+	}
+}
+
+// move
+template<class storage_policy>
+class move_bench
+{
+public:
+	move_bench(std::vector<receiver<multi_threaded_local> >& receivers, int moves)
+    : m_moves(moves)
+	{
+		for(size_t i = 0; i < receivers.size(); ++i)
+		{
+			m_sig.connect(&receivers[i], &receiver<multi_threaded_local>::on_ints<int>);
+		}
+	}
+    
+	void operator()()
+	{
+		for(int i = 0; i < m_moves; ++i)
+		{
+			basic_signal<multi_threaded_local, storage_policy, int> moved(std::move(m_sig));
+			m_sig = std::move(moved);
+		}
+	}
+    
+private:
+	basic_signal<multi_threaded_local, storage_policy, int> m_sig;
+	int m_moves;
+};
+
+template<class storage_policy>
+static void run_move()
+{
+	static const size_t slot_counts[] = { 1, 64, 1024 };
+    
+	for(size_t n = 0; n < sizeof(slot_counts) / sizeof(slot_counts[0]); ++n)
+	{
+		std::vector<receiver<multi_threaded_local> > receivers(slot_counts[n]);
+		int moves = int(100000 / slot_counts[n]) + 10;
+		move_bench<storage_policy> bench(receivers, moves);
+		report("move", "local", storage_name((storage_policy*)NULL), 1, slot_counts[n], 1,
+			median_ns(bench, 2.0 * moves * slot_counts[n]));
+	}
+}
+
+// handled
+template<class storage_policy>
+class handled_bench
+{
+public:
+	enum { emits = 200000 };
+    
+	handled_bench(std::vector<receiver<multi_threaded_local> >& receivers)
+	{
+		for(size_t i = 1; i < receivers.size(); ++i)
+		{
+			m_sig.connect(&receivers[i], &receiver<multi_threaded_local>::on_ints<int>);
+		}
+        
+		m_sig.connect(&receivers[0], &receiver<multi_threaded_local>::on_claim, 1);
+	}
+    
+	void operator()()
+	{
+		for(int i = 0; i < emits; ++i)
+		{
+			m_sig.emit_until_handled(1);
+		}
+	}
+    
+private:
+	basic_signal<multi_threaded_local, storage_policy, int> m_sig;
+};
+
+template<class storage_policy>
+static void run_handled()
+{
+	static const size_t slot_counts[] = { 1, 64, 1024 };
+    
+	for(size_t n = 0; n < sizeof(slot_counts) / sizeof(slot_counts[0]); ++n)
+	{
+		std::vector<receiver<multi_threaded_local> > receivers(slot_counts[n]);
+		handled_bench<storage_policy> bench(receivers);
+		report("handled", "local", storage_name((storage_policy*)NULL), 1, slot_counts[n], 1,
+			median_ns(bench, handled_bench<storage_policy>::emits));
+	}
+}
+
+// queued and routed
+template<class storage_policy, bool routed>
+class queued_bench
+{
+public:
+	enum { dispatchers = 4, emits = 20000 };
+    
+	queued_bench(std::vector<receiver<multi_threaded_local> >& receivers)
+	{
+		for(size_t i = 0; i < receivers.size(); ++i)
+		{
+			receivers[i].set_dispatcher(&m_dispatchers[i % dispatchers]);
+			m_sig.connect(&receivers[i], &receiver<multi_threaded_local>::on_ints<int>, queued_on());
+		}
+	}
+    
+	void operator()()
+	{
+		for(int i = 0; i < emits; ++i)
+		{
+			if(routed)
+			{
+				m_sig.emit_routed(i);
+			}
+			else
+			{
+				m_sig.emit(i);
+			}
+            
+			for(int d = 0; d < dispatchers; ++d)
+			{
+				m_dispatchers[d].dispatch();
+			}
+		}
+	}
+    
+private:
+	dispatcher m_dispatchers[dispatchers];
+	basic_signal<multi_threaded_local, storage_policy, int> m_sig;
+};
+
+template<class storage_policy, bool routed>
+static void run_queued()
+{
+	static const size_t slot_counts[] = { 4, 64, 1024 };
+    
+	for(size_t n = 0; n < sizeof(slot_counts) / sizeof(slot_counts[0]); ++n)
+	{
+		std::vector<receiver<multi_threaded_local> > receivers(slot_counts[n]);
+		queued_bench<storage_policy, routed> bench(receivers);
+		report(routed ? "routed" : "queued", "local", storage_name((storage_policy*)NULL), 1, slot_counts[n], 1,
+			median_ns(bench, queued_bench<storage_policy, routed>::emits));
+	}
+}
+
+// bulk
+template<class mt_policy, class storage_policy, bool many>
+class bulk_bench
+{
+public:
+	bulk_bench(size_t count)
+    : m_receivers(count), m_handles(count)
+	{
+		for(size_t i = 0; i < count; ++i)
+		{
+			m_preceivers.push_back(&m_receivers[i]);
+		}
+	}
+    
+	void operator()()
+	{
+		size_t count = m_preceivers.size();
+        
+		if(many)
+		{
+			m_sig.connect_many(&m_preceivers[0], count, &receiver<mt_policy>::template on_ints<int>, &m_handles[0]);
+			m_sig.disconnect_many(&m_handles[0], count);
+			return;
+		}
+        
+		for(size_t i = 0; i < count; ++i)
+		{
+			m_handles[i] = m_sig.connect(m_preceivers[i], &receiver<mt_policy>::template on_ints<int>);
+		}
+        
+		for(size_t i = 0; i < count; ++i)
+		{
+			m_sig.disconnect(m_handles[i]);
+		}
+	}
+    
+private:
+	std::vector<receiver<mt_policy> > m_receivers;
+	std::vector<receiver<mt_policy>*> m_preceivers;
+	std::vector<connection> m_handles;
+	basic_signal<mt_policy, storage_policy, int> m_sig;
+};
+
+template<class mt_policy, class storage_policy>
+static void run_bulk()
+{
+	static const size_t counts[] = { 64, 4096 };
+    
+	for(size_t n = 0; n < sizeof(counts) / sizeof(counts[0]); ++n)
+	{
+		bulk_bench<mt_policy, storage_policy, true> many(counts[n]);
+		report("bulk", policy_name((mt_policy*)NULL), storage_name((storage_policy*)NULL), 1, counts[n], 1,
+			median_ns(many, double(counts[n])));
+        
+		bulk_bench<mt_policy, storage_policy, false> loop(counts[n]);
+		report("bulk_loop", policy_name((mt_policy*)NULL), storage_name((storage_policy*)NULL), 1, counts[n], 1,
+			median_ns(loop, double(counts[n])));
+	}
+}
+
+// static
+template<class mt_policy, bool wired>
+class static_bench
+{
+public:
+	static_bench(std::vector<receiver<mt_policy> >& receivers, int emits)
+    : m_static(&receivers[0], &receivers[1], &receivers[2], &receivers[3]), m_emits(emits)
+	{
+		for(size_t i = 0; i < 4; ++i)
+		{
+			m_dynamic.template connect<receiver<mt_policy>, &receiver<mt_policy>::template on_ints<int> >(&receivers[i]);
+		}
+	}
+    
+	void operator()()
+	{
+		for(int i = 0; i < m_emits; ++i)
+		{
+			if(wired)
+			{
+				m_static(i);
+			}
+			else
+			{
+				m_dynamic(i);
+			}
+		}
+	}
+    
+private:
+	typedef basic_signal<mt_policy, vector_storage, int> signal_type;
+	typedef typename signal_type::template static_slot<receiver<mt_policy>, &receiver<mt_policy>::template on_ints<int> >
+		slot_type;
+    
+	static_signal<signal_type, slot_type, slot_type, slot_type, slot_type> m_static;
+	signal_type m_dynamic;
+	int m_emits;
+};
+
+template<class mt_policy>
+static void run_static()
+{
+	static const int emits = 200000;
+	std::vector<receiver<mt_policy> > receivers(4);
+    
+	static_bench<mt_policy, true> wired(receivers, emits);
+	report("static", policy_name((mt_policy*)NULL), "static", 1, 4, 1, median_ns(wired, emits));
+    
+	static_bench<mt_policy, false> dynamic(receivers, emits);
+	report("static", policy_name((mt_policy*)NULL), "vector", 1, 4, 1, median_ns(dynamic, emits));
+}
+
+// coalesced
+template<class storage_policy, bool coalesced>
+class coalesced_bench
+{
+public:
+	enum { emits = 20000, emits_per_dispatch = 1000 };
+    
+	coalesced_bench(std::vector<receiver<multi_threaded_local> >& receivers)
+	{
+		for(size_t i = 0; i < receivers.size(); ++i)
+		{
+			if(coalesced)
+			{
+				m_sig.connect(&receivers[i], &receiver<multi_threaded_local>::on_ints<int>, coalesced_on(m_dispatcher));
+			}
+			else
+			{
+				m_sig.connect(&receivers[i], &receiver<multi_threaded_local>::on_ints<int>, queued_on(m_dispatcher));
+			}
+		}
+	}
+    
+	void operator()()
+	{
+		for(int i = 0; i < emits; ++i)
+		{
+			m_sig.emit(i);
+            
+			if(i % emits_per_dispatch == emits_per_dispatch - 1)
+			{
+				m_dispatcher.dispatch();
+			}
+		}
+	}
+    
+private:
+	dispatcher m_dispatcher;
+	basic_signal<multi_threaded_local, storage_policy, int> m_sig;
+};
+
+template<class storage_policy, bool coalesced>
+static void run_coalesced()
+{
+	static const size_t slot_counts[] = { 4, 64 };
+    
+	for(size_t n = 0; n < sizeof(slot_counts) / sizeof(slot_counts[0]); ++n)
+	{
+		std::vector<receiver<multi_threaded_local> > receivers(slot_counts[n]);
+		coalesced_bench<storage_policy, coalesced> bench(receivers);
+		report("coalesced", "local", coalesced ? storage_name((storage_policy*)NULL) : "queued", 1, slot_counts[n], 1,
+			median_ns(bench, coalesced_bench<storage_policy, coalesced>::emits));
+	}
+}
+
+// hub
+static std::string topic_name(size_t topic)
+{
+	char name[32];
+	snprintf(name, sizeof(name), "topic/%lu", (unsigned long)topic);
+	return name;
+}
+
+class hub_bench
+{
+public:
+	enum { emits = 200000 };
+    
+	hub_bench(std::vector<receiver<multi_threaded_local> >& receivers)
+    : m_keys(receivers.size())
+	{
+		for(size_t i = 0; i < receivers.size(); ++i)
+		{
+			m_keys[i] = topic_name(i);
+			m_hub.connect(m_keys[i], &receivers[i], &receiver<multi_threaded_local>::on_ints<int>);
+		}
+	}
+    
+	void operator()()
+	{
+		for(int i = 0; i < emits; ++i)
+		{
+			m_hub.emit(m_keys[i % m_keys.size()], i);
+		}
+	}
+    
+private:
+	std::vector<std::string> m_keys;
+	basic_signal_hub<multi_threaded_local, std::string, int> m_hub;
+};
+
+class map_bench
+{
+public:
+	enum { emits = 200000 };
+    
+	typedef basic_signal<multi_threaded_local, list_storage, int> signal_type;
+    
+	map_bench(std::vector<receiver<multi_threaded_local> >& receivers)
+    : m_keys(receivers.size())
+	{
+		for(size_t i = 0; i < receivers.size(); ++i)
+		{
+			m_keys[i] = topic_name(i);
+			signal_type*& psig = m_signals[m_keys[i]];
+			psig = new signal_type;
+			psig->connect(&receivers[i], &receiver<multi_threaded_local>::on_ints<int>);
+		}
+	}
+    
+	~map_bench()
+	{
+		for(std::map<std::string, signal_type*>::iterator it = m_signals.begin(); it != m_signals.end(); ++it)
+		{
+			delete it->second;
+		}
+	}
+    
+	void operator()()
+	{
+		for(int i = 0; i < emits; ++i)
+		{
+			std::map<std::string, signal_type*>::iterator it = m_signals.find(m_keys[i % m_keys.size()]);
+            
+			if(it != m_signals.end())
+			{
+				it->second->emit(i);
+			}
+		}
+	}
+    
+private:
+	std::vector<std::string> m_keys;
+	std::map<std::string, signal_type*> m_signals;
+};
+
+static void run_hub()
+{
+	static const size_t topic_counts[] = { 16, 1024, 16384 };
+    
+	for(size_t n = 0; n < sizeof(topic_counts) / sizeof(topic_counts[0]); ++n)
+	{
+		std::vector<receiver<multi_threaded_local> > receivers(topic_counts[n]);
+        
+		{
+			hub_bench bench(receivers);
+			report("hub", "local", "hub", 1, topic_counts[n], 1, median_ns(bench, hub_bench::emits));
+		}
+        
+		{
+			map_bench bench(receivers);
+			report("hub", "local", "map", 1, topic_counts[n], 1, median_ns(bench, map_bench::emits));
+		}
+	}
+}
+
+// contended
+template<class mt_policy>
+class contended_bench
+{
+public:
+	enum { slots = 8, emits_per_thread = 50000 };
+    
+	explicit contended_bench(int threads)
+    : m_receivers(slots), m_threads(threads)
+	{
+		for(size_t i = 0; i < slots; ++i)
+		{
+			m_sig.connect(&m_receivers[i], &receiver<mt_policy>::template on_ints<int>);
+		}
+	}
+    
+	void operator()()
+	{
+		std::vector<pthread_t> threads(m_threads);
+    
+		for(int i = 0; i < m_threads; ++i)
+		{
+			pthread_create(&threads[i], NULL, &emitter, this);
+		}
+    
+		for(int i = 0; i < m_threads; ++i)
+		{
+			pthread_join(threads[i], NULL);
+		}
+	}
+    
+private:
+	static void* emitter(void* pcontext)
+	{
+		contended_bench* pself = static_cast<contended_bench*>(pcontext);
+    
+		for(int i = 0; i < emits_per_thread; ++i)
+		{
+			pself->m_sig.emit(i);
+		}
+    
+		return NULL;
+	}
+    
+	std::vector<receiver<mt_policy> > m_receivers;
+	basic_signal<mt_policy, list_storage, int> m_sig;
+	int m_threads;
+};
+
+template<class mt_policy>
+static void run_contended()
+{
+	static const int thread_counts[] = { 1, 2, 4, 8 };
+    
+	for(size_t n = 0; n < sizeof(thread_counts) / sizeof(thread_counts[0]); ++n)
+	{
+		contended_bench<mt_policy> bench(thread_counts[n]);
+		report("contended", policy_name((mt_policy*)NULL), "list", 1, contended_bench<mt_policy>::slots, thread_counts[n],
+			median_ns(bench, double(contended_bench<mt_policy>::emits_per_thread) * thread_counts[n]));
+	}
+}
+
+static bool selected(const char* only, const char* benchmark)
+{
+	return only == NULL || strcmp(only, benchmark) == 0;
+}
+
+int main(int argc, char** argv)
+{
+	const char* only = argc > 1 ? argv[1] : NULL;
+    
+	printf("benchmark,policy,storage,arity,slots,threads,ns_per_op\n");
+    
+	if(selected(only, "emit"))
+	{
+		run_emit<list_storage>();
+		run_emit<vector_storage>();
+	}
+    
+	if(selected(only, "churn"))
+	{
+		run_churn<list_storage>();
+		run_churn<vector_storage>();
+	}
+    
+	if(selected(only, "teardown"))
+	{
+		run_teardown<list_storage, receiver<multi_threaded_local> >("teardown");
+		run_teardown<vector_storage, receiver<multi_threaded_local> >("teardown");
+		run_teardown<list_storage, weak_receiver>("teardown_weak");
+		run_teardown<vector_storage, weak_receiver>("teardown_weak");
+	}
+    
+	if(selected(only, "copy"))
+	{
+		run_copy<list_storage>();
+		run_copy<vector_storage>();
+	}
+    
+	if(selected(only, "move"))
+	{
+		run_move<list_storage>();
+		run_move<vector_storage>();
+	}
+    
+	if(selected(only, "handled"))
+	{
+		run_handled<list_storage>();
+		run_handled<vector_storage>();
+	}
+    
+	if(selected(only, "queued"))
+	{
+		run_queued<list_storage, false>();
+		run_queued<vector_storage, false>();
+	}
+    
+	if(selected(only, "routed"))
+	{
+		run_queued<list_storage, true>();
+		run_queued<vector_storage, true>();
+	}
+    
+	if(selected(only, "bulk"))
+	{
+		run_bulk<multi_threaded_local, list_storage>();
+		run_bulk<multi_threaded_local, vector_storage>();
+		run_bulk<multi_threaded_cow, list_storage>();
+	}
+    
+	if(selected(only, "static"))
+	{
+		run_static<multi_threaded_local>();
+		run_static<multi_threaded_adaptive>();
+	}
+    
+	if(selected(only, "coalesced"))
+	{
+		run_coalesced<list_storage, true>();
+		run_coalesced<vector_storage, true>();
+		run_coalesced<list_storage, false>();
+	}
+    
+	if(selected(only, "hub"))
+	{
+		run_hub();
+	}
+    
+	if(selected(only, "contended"))
+	{
+		run_contended<multi_threaded_global>();
+		run_contended<multi_threaded_local>();
+		run_contended<multi_threaded_adaptive>();
+		run_contended<multi_threaded_rw>();
+		run_contended<multi_threaded_cow>();
+	}
+    
+	return 0;
+}
@@ -24,6 +24,40 @@
 //										  override the default. In pure ISO mode, anything other than
 //										  single_threaded will cause a compiler error.
 //
+//			SIGSLOT_DEFAULT_STORAGE_POLICY	- The connection storage used when a signal does not name one.
+//										  Defaults to list_storage.
+//
+//			SIGSLOT_INLINE_CONNECTION_SIZE	- Size in bytes of one connection cell in vector_storage. Defaults
+//										  to eight pointers, which holds any member function connection on
+//										  the supported compilers.
+//
+//			SIGSLOT_ALLOCATOR			- The allocator template used for connection objects, for the list
+//										  nodes of list_storage and for the arrays that has_slots keeps
+//										  its senders in once they outgrow the inline ones. Defaults to
+//										  std::allocator. Define it as
+//										  sigslot::pool_allocator to serve all of these from per-thread
+//										  fixed size pools, or name any allocator template of your own.
+//
+//			SIGSLOT_SPIN_LIMIT			- The most pause instructions multi_threaded_adaptive spins through in
+//										  one round before it waits in the OS; defaults to 1024.
+//
+//			SIGSLOT_INLINE_SENDERS		- How many connections a has_slots records inside itself before it
+//										  allocates an array for them. Defaults to 1, which keeps a has_slots
+//										  as small as one that recorded its senders in a std::set.
+//
+//			SIGSLOT_INSTRUMENTATION_POLICY	- What every signal records about its emits. Defaults to
+//										  no_instrumentation, which records nothing and costs nothing.
+//										  Define it as sigslot::emit_statistics to count emits and slot
+//										  calls, time lock waits and slot calls, and report on every live
+//										  signal through emit_statistics::collect() and dump().
+//										  Define it as sigslot::emit_tracing to record a timeline of slot
+//										  calls and lock waits instead, for emit_tracing::write_chrome_trace(),
+//										  which drains into a FILE* or, given a path, a mapping of the file.
+//
+//			SIGSLOT_TRACE_RECORDS		- How many records each thread's emit_tracing buffer holds between
+//										  drains; a power of two, defaulting to 8192. Records past that
+//										  are dropped and counted.
+//
 //		PLATFORM NOTES
 //
 //			Win32						- On Win32, the WIN32 symbol must be #defined. Most mainstream
@@ -35,7 +69,8 @@
 //										  available, so they are used automatically. You can override this
 //										  (as under Windows) with the SIGSLOT_PURE_ISO switch. If you're using
 //										  something other than gcc but still want to use Posix threads, you
-//										  need to #define SIGSLOT_USE_POSIX_THREADS.
+//										  need to #define SIGSLOT_USE_POSIX_THREADS. shared_signal uses
+//										  POSIX shared memory, which older C libraries need -lrt for.
 //
 //			ISO C++						- If none of the supported platforms are detected, or if
 //										  SIGSLOT_PURE_ISO is defined, all multithreading support is turned off,
@@ -69,6 +104,148 @@
 //										  absolutely essential. However, on some platforms, creating a lot of 
 //										  mutexes can slow down the whole OS, so use this option with care.
 //
+//			multi_threaded_adaptive		- Like multi_threaded_local, but each lock is one word. Taking it spins
+//										  for a short, doubling while, which is all most connects and emits
+//										  need, and only then waits in the OS: a futex on Linux, WaitOnAddress
+//										  on Windows 8 and later (link with Synchronization.lib). Elsewhere the
+//										  wait yields the CPU instead. On a single CPU it does not spin at all.
+//										  SIGSLOT_SPIN_LIMIT sets the longest spin. Not recursive, like
+//										  multi_threaded_local.
+//
+//			multi_threaded_cow			- Like multi_threaded_local for connecting and disconnecting, but emit()
+//										  takes no lock. It walks an immutable copy of the connection list that
+//										  is republished whenever connections change, so any number of threads
+//										  can emit the same signal at once and a slow slot never holds up
+//										  connect(). Disconnecting waits until emits that were already running
+//										  have finished. On POSIX this needs gcc style atomic builtins.
+//
+//			multi_threaded_rw			- Each signal and each has_slots object has its own reader/writer lock
+//										  (pthread_rwlock_t, or an SRWLOCK on Windows Vista and later). emit()
+//										  takes the shared side, so emits of one signal run concurrently;
+//										  connecting, disconnecting and copying take the exclusive side.
+//
+//		STORAGE POLICIES
+//
+//			Every signalN takes a storage_policy template parameter after mt_policy.
+//
+//			list_storage				- Each connection is allocated separately and linked into a std::list.
+//										  Emitting visits a list node and then the connection it points to.
+//
+//			vector_storage				- Connections are constructed in place in one contiguous array, so
+//										  emitting walks memory linearly. Disconnecting leaves an empty cell,
+//										  and the array is closed up once half of it is empty, so the cost
+//										  is amortised; connecting in the middle moves the later ones up.
+//										  Best for signals with many slots that are emitted far more often
+//										  than they are connected to.
+//
+//		SIGNALS
+//
+//			The library needs C++11. signal<arg_types...> takes any number of arguments and uses
+//			the default policies; basic_signal<mt_policy, storage_policy, arg_types...> names them.
+//			signal0 .. signal8 remain as aliases of basic_signal, with the policies as trailing
+//			template parameters as before. emit() takes arguments that are not scalars by const
+//			reference and hands them on to every slot that way, so they are only copied into
+//			slots that take them by value.
+//
+//			A signal is a single pointer until something connects to it. The first connect()
+//			allocates its lock, its connections and their bookkeeping, which stay until the signal
+//			is destroyed; emitting a signal that was never connected to costs a load and a test.
+//			The policies are plain classes with no virtual functions, so single_threaded takes no
+//			space in the objects that use it.
+//
+//			Signals and has_slots objects can be moved as well as copied. Moving a signal hands
+//			over its pointer, so the connections and their receivers are untouched. Moving a
+//			has_slots hands its connections over as they are and points their signals at the new
+//			address. Either way a std::vector of objects with signals or slots grows cheaply, and
+//			handles keep working with the signal their connection moved to. As with copying,
+//			neither object may be in use on another thread while it is moved. Assigning a signal
+//			or a has_slots, by copy or by move, first drops the connections the target had; copy
+//			assignment then duplicates those of the source.
+//
+//			With single_threaded, multi_threaded_global, multi_threaded_local or
+//			multi_threaded_adaptive, a slot may use the signal that is calling it: connect to it,
+//			disconnect any of its connections, destroy a receiver connected to it, or emit it again.
+//			A connection removed during an emit is only marked as gone, and the signal compacts its
+//			storage when the outermost emit returns. Under multi_threaded_rw and multi_threaded_cow
+//			a slot must not change the signal that is calling it.
+//
+//			Every form of connect() takes an optional int priority as its last argument. Slots run
+//			highest priority first, and slots of equal priority in the order they were connected;
+//			the order is settled when connecting, so emit() still just walks the connections. A
+//			slot may return bool instead of void: emit_until_handled(args...) stops after the
+//			first slot that returns true and says whether one did, while emit() runs them all.
+//
+//			connect(callable) connects a free function, a lambda or any other function object that
+//			takes the signal's arguments, with no has_slots object involved. The signal keeps a copy
+//			of it; one small enough to share a vector_storage cell with its connection is kept in
+//			the connection itself, with no further allocation. It stays connected until its handle is
+//			passed to disconnect(), or disconnect_all() is called, or the signal is destroyed.
+//
+//			connect(pclass, &method, queued_on(d)) makes a queued connection: emit() stores a copy
+//			of the arguments in dispatcher d, and the slot runs on whichever thread calls
+//			d.dispatch(). See queued_on for the details.
+//
+//			static_signal<signal_type, slots...> is for wiring fixed at build time: each of slots is
+//			a signal_type::static_slot<class, &class::method>, and the constructor takes a pointer
+//			to each receiver in the same order. emit() calls those slots directly, inline, with no
+//			lock or allocation, and then emits the signal_type it derives from, which takes any
+//			connections made at run time as usual.
+//
+//			connect_many(pclasses, count, &method, handles) connects an array of receivers at once,
+//			and disconnect_many(handles, count) disconnects an array of handles. Each takes the
+//			signal's lock once rather than once per connection, which suits mass subscription.
+//
+//			A receiver may derive from has_weak_slots instead of has_slots. It connects with the
+//			same connect(pclass, &method) and connect_many(), but a signal holds only a weak
+//			reference to it, and destroying it never touches the signal: it marks itself dead and
+//			waits for any of its slots still running. Under the per-object policies a has_slots
+//			receiver locks itself and then each of its signals when it is destroyed, the reverse
+//			of connect(), so the two must not race; has_weak_slots receivers have no such order.
+//			Signals skip a dead receiver's slots and remove its connections on a later connect().
+//			Every call into one of its slots costs two more atomic operations.
+//
+//			connect(pclass, &method, coalesced_on(d)) suits a slot that needs only the latest
+//			value of a signal emitted faster than that: the connection keeps just the latest
+//			arguments, and the slot runs with them at most once per d.dispatch().
+//			coalesced_on(d, interval) also limits it to once per interval. A value held back by
+//			the interval wakes nobody, so an event loop that waits between dispatches should also
+//			wake by d.next_deadline().
+//
+//			emit_routed(args...) is for signals whose receivers live on other threads. Give each
+//			receiver its owning thread's dispatcher with set_dispatcher() and connect it with a
+//			plain queued_on(); emit_routed() then posts each dispatcher a single event, with a
+//			single copy of the arguments, that runs all of its slots in order on that thread.
+//			Direct connections run on the emitting thread, as they do in emit().
+//
+//			signal_hub<key_type, arg_types...> stands in for a map of many signals with the same
+//			arguments: connect(key, pclass, &method) and the other forms of connect() take the key
+//			first, and emit(key, args...) runs the slots connected under that key. The hub has one
+//			lock and one hash index for all its keys, and a key with nothing connected takes no
+//			memory. basic_signal_hub<mt_policy, key_type, arg_types...> names the policy.
+//
+//			emit_batch(events, count) emits an array of signal::event_type tuples under one lock.
+//			By default every slot sees the first event before any slot sees the second, as with a
+//			loop of emit() calls; passing slot_major runs each slot over all of the events instead.
+//			A slot of the form void method(const event_type*, size_t) gets the whole batch at once.
+//
+//			emit_parallel(executor, args...) spreads the slots over the threads of a
+//			parallel_executor, such as thread_pool, and returns when they have all run. It suits
+//			signals with many slow, independent slots; see emit_parallel for what the slots may do.
+//
+//			shared_signal<arg_types...> sends a signal to other processes on the same host through
+//			shared memory. One side calls create(name, capacity) and the other open(name); emit()
+//			then writes the arguments straight into the shared region, and in another process
+//			shared_signal_pump<arg_types...>::pump(sig) takes what has arrived and emits it into an
+//			ordinary local signal. Neither end makes a system call per event. The arguments must be
+//			trivially copyable, and a full region drops new events rather than wait.
+//
+//			With C++20 coroutines, co_await sig.next() suspends a coroutine until sig is next
+//			emitted and gives it a std::optional of the arguments, empty if the signal is destroyed
+//			or disconnect_all() is called first. The wait allocates nothing: the awaiter lives in
+//			the coroutine frame and is linked into the signal. The coroutine resumes on the
+//			emitting thread after the slots have run, or with next(d) on dispatcher d's thread.
+//			A coroutine waiting on a signal must not be destroyed while an emit may be waking it.
+//
 //		USING THE LIBRARY
 //
 //			See the full documentation at http://sigslot.sourceforge.net/
@@ -78,8 +255,25 @@
 #ifndef SIGSLOT_H__
 #define SIGSLOT_H__
 
-#include <set>
 #include <list>
+#include <algorithm>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <type_traits>
+#include <tuple>
+#include <utility>
+#include <new>
+#include <cstddef>
+#include <climits>
+#include <cstdio>
+#include <cstdarg>
+#include <cstring>
+#include <chrono>
+#ifdef __cpp_impl_coroutine
+#include <coroutine>
+#include <optional>
+#endif
 
 #if defined(SIGSLOT_PURE_ISO) || (!defined(WIN32) && !defined(__GNUG__) && !defined(SIGSLOT_USE_POSIX_THREADS))
 #	define _SIGSLOT_SINGLE_THREADED
@@ -89,6 +283,15 @@
 #elif defined(__GNUG__) || defined(SIGSLOT_USE_POSIX_THREADS)
 #	define _SIGSLOT_HAS_POSIX_THREADS
 #	include <pthread.h>
+#	include <sched.h>
+#	include <unistd.h>
+#	include <fcntl.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#	ifdef __linux__
+#		include <linux/futex.h>
+#		include <sys/syscall.h>
+#	endif
 #else
 #	define _SIGSLOT_SINGLE_THREADED
 #endif
@@ -101,6 +304,52 @@
 #	endif
 #endif
 
+// thread_local rather than __thread or __declspec(thread), which cannot
+// hold objects with constructors or destructors.
+#if defined(_SIGSLOT_SINGLE_THREADED)
+#	define _SIGSLOT_THREAD_LOCAL
+#else
+#	define _SIGSLOT_THREAD_LOCAL thread_local
+#endif
+
+#if defined(SIGSLOT_PURE_ISO)
+#	define _SIGSLOT_NOINLINE
+#elif defined(_MSC_VER)
+#	define _SIGSLOT_NOINLINE __declspec(noinline)
+#elif defined(__GNUC__)
+#	define _SIGSLOT_NOINLINE __attribute__((noinline))
+#else
+#	define _SIGSLOT_NOINLINE
+#endif
+
+#ifndef SIGSLOT_DEFAULT_STORAGE_POLICY
+#	define SIGSLOT_DEFAULT_STORAGE_POLICY list_storage
+#endif
+
+#ifndef SIGSLOT_INLINE_CONNECTION_SIZE
+#	define SIGSLOT_INLINE_CONNECTION_SIZE (8 * sizeof(void*))
+#endif
+
+#ifndef SIGSLOT_ALLOCATOR
+#	define SIGSLOT_ALLOCATOR std::allocator
+#endif
+
+#ifndef SIGSLOT_SPIN_LIMIT
+#	define SIGSLOT_SPIN_LIMIT 1024
+#endif
+
+#ifndef SIGSLOT_INLINE_SENDERS
+#	define SIGSLOT_INLINE_SENDERS 1
+#endif
+
+#ifndef SIGSLOT_INSTRUMENTATION_POLICY
+#	define SIGSLOT_INSTRUMENTATION_POLICY no_instrumentation
+#endif
+
+#ifndef SIGSLOT_TRACE_RECORDS
+#	define SIGSLOT_TRACE_RECORDS 8192
+#endif
+
 
 namespace sigslot {
     
@@ -112,7 +361,7 @@ namespace sigslot {
 			;
 		}
         
-		virtual ~single_threaded()
+		~single_threaded()
 		{
 			;
 		}
@@ -135,13 +384,7 @@ namespace sigslot {
 	public:
 		multi_threaded_global()
 		{
-			static bool isinitialised = false;
-            
-			if(!isinitialised)
-			{
-				InitializeCriticalSection(get_critsec());
-				isinitialised = true;
-			}
+			;
 		}
         
 		multi_threaded_global(const multi_threaded_global&)
@@ -149,7 +392,7 @@ namespace sigslot {
 			;
 		}
         
-		virtual ~multi_threaded_global()
+		~multi_threaded_global()
 		{
 			;
 		}
@@ -165,11 +408,25 @@ namespace sigslot {
 		}
         
 	private:
-		CRITICAL_SECTION* get_critsec()
+		// Created once, before the first object that uses it.
+		static BOOL CALLBACK init_critsec(PINIT_ONCE, PVOID, PVOID*)
+		{
+			InitializeCriticalSection(critsec());
+			return TRUE;
+		}
+        
+		static CRITICAL_SECTION* critsec()
 		{
 			static CRITICAL_SECTION g_critsec;
 			return &g_critsec;
 		}
+        
+		CRITICAL_SECTION* get_critsec()
+		{
+			static INIT_ONCE s_once = INIT_ONCE_STATIC_INIT;
+			InitOnceExecuteOnce(&s_once, init_critsec, NULL, NULL);
+			return critsec();
+		}
 	};
     
 	class multi_threaded_local
@@ -185,7 +442,7 @@ namespace sigslot {
 			InitializeCriticalSection(&m_critsec);
 		}
         
-		virtual ~multi_threaded_local()
+		~multi_threaded_local()
 		{
 			DeleteCriticalSection(&m_critsec);
 		}
@@ -202,2334 +459,8737 @@ namespace sigslot {
         
 	private:
 		CRITICAL_SECTION m_critsec;
-	};
-#endif // _SIGSLOT_HAS_WIN32_THREADS
-    
-#ifdef _SIGSLOT_HAS_POSIX_THREADS
-	// The multi threading policies only get compiled in if they are enabled.
-	class multi_threaded_global
+	};    
+	// Slim reader/writer locks need Windows Vista or later.
+	class multi_threaded_rw
 	{
 	public:
-		multi_threaded_global()
+		multi_threaded_rw()
 		{
-			pthread_mutex_init(get_mutex(), NULL);
+			InitializeSRWLock(&m_srwlock);
 		}
         
-		multi_threaded_global(const multi_threaded_global&)
+		multi_threaded_rw(const multi_threaded_rw&)
 		{
-			;
+			InitializeSRWLock(&m_srwlock);
 		}
         
-		virtual ~multi_threaded_global()
+		~multi_threaded_rw()
 		{
 			;
 		}
         
 		void lock()
 		{
-			pthread_mutex_lock(get_mutex());
+			AcquireSRWLockExclusive(&m_srwlock);
 		}
         
 		void unlock()
 		{
-			pthread_mutex_unlock(get_mutex());
-		}
-        
-	private:
-		pthread_mutex_t* get_mutex()
-		{
-			static pthread_mutex_t g_mutex;
-			return &g_mutex;
-		}
-	};
-    
-	class multi_threaded_local
-	{
-	public:
-		multi_threaded_local()
-		{
-			pthread_mutex_init(&m_mutex, NULL);
-		}
-        
-		multi_threaded_local(const multi_threaded_local&)
-		{
-			pthread_mutex_init(&m_mutex, NULL);
-		}
-        
-        virtual ~multi_threaded_local()
-		{
-			pthread_mutex_destroy(&m_mutex);
+			ReleaseSRWLockExclusive(&m_srwlock);
 		}
         
-		void lock()
+		void lock_shared()
 		{
-			pthread_mutex_lock(&m_mutex);
+			AcquireSRWLockShared(&m_srwlock);
 		}
         
-		void unlock()
+		void unlock_shared()
 		{
-			pthread_mutex_unlock(&m_mutex);
+			ReleaseSRWLockShared(&m_srwlock);
 		}
         
 	private:
-		pthread_mutex_t m_mutex;
+		SRWLOCK m_srwlock;
 	};
-#endif // _SIGSLOT_HAS_POSIX_THREADS
+
     
-	template<class mt_policy>
-	class lock_block
+	// Atomic operations used by multi_threaded_cow, dispatcher, emit_tracing
+	// and the lazy storage of basic_signal. Every one of them is a full
+	// memory barrier, except for the relaxed, acquire and release ones.
+	inline long _atomic_add(volatile long* pvalue, long delta)
 	{
-	public:
-		mt_policy *m_mutex;
-        
-		lock_block(mt_policy *mtx)
-        : m_mutex(mtx)
-		{
-			m_mutex->lock();
-		}
-        
-		~lock_block()
-		{
-			m_mutex->unlock();
-		}
-	};
+		return InterlockedExchangeAdd(pvalue, delta) + delta;
+	}
     
-	template<class mt_policy>
-	class has_slots;
+	inline long _atomic_load(volatile long* pvalue)
+	{
+		long value = *pvalue;
+		MemoryBarrier();
+		return value;
+	}
     
-	template<class mt_policy>
-	class _connection_base0
+	inline void _atomic_store(volatile long* pvalue, long value)
 	{
-	public:
-        virtual ~_connection_base0() { }
-		virtual has_slots<mt_policy>* getdest() const = 0;
-		virtual void emit() = 0;
-		virtual _connection_base0* clone() = 0;
-		virtual _connection_base0* duplicate(has_slots<mt_policy>* pnewdest) = 0;
-	};
+		InterlockedExchange(pvalue, value);
+	}
     
-	template<class arg1_type, class mt_policy>
-	class _connection_base1
+	inline long _atomic_exchange(volatile long* pvalue, long value)
 	{
-	public:
-        virtual ~_connection_base1() { }
-		virtual has_slots<mt_policy>* getdest() const = 0;
-		virtual void emit(arg1_type) = 0;
-		virtual _connection_base1<arg1_type, mt_policy>* clone() = 0;
-		virtual _connection_base1<arg1_type, mt_policy>* duplicate(has_slots<mt_policy>* pnewdest) = 0;
-	};
+		return InterlockedExchange(pvalue, value);
+	}
     
-	template<class arg1_type, class arg2_type, class mt_policy>
-	class _connection_base2
+	inline bool _atomic_compare_exchange(volatile long* pvalue, long expected, long desired)
 	{
-	public:
-        virtual ~_connection_base2() { }
-		virtual has_slots<mt_policy>* getdest() const = 0;
-		virtual void emit(arg1_type, arg2_type) = 0;
-		virtual _connection_base2<arg1_type, arg2_type, mt_policy>* clone() = 0;
-		virtual _connection_base2<arg1_type, arg2_type, mt_policy>* duplicate(has_slots<mt_policy>* pnewdest) = 0;
-	};
+		return InterlockedCompareExchange(pvalue, desired, expected) == expected;
+	}
     
-	template<class arg1_type, class arg2_type, class arg3_type, class mt_policy>
-	class _connection_base3
+	template<class T>
+	inline T* _atomic_load(T* volatile* ppointer)
 	{
-	public:
-        virtual ~_connection_base3() { }
-		virtual has_slots<mt_policy>* getdest() const = 0;
-		virtual void emit(arg1_type, arg2_type, arg3_type) = 0;
-		virtual _connection_base3<arg1_type, arg2_type, arg3_type, mt_policy>* clone() = 0;
-		virtual _connection_base3<arg1_type, arg2_type, arg3_type, mt_policy>* duplicate(has_slots<mt_policy>* pnewdest) = 0;
-	};
+		T* pointer = *ppointer;
+		MemoryBarrier();
+		return pointer;
+	}
     
-	template<class arg1_type, class arg2_type, class arg3_type, class arg4_type, class mt_policy>
-	class _connection_base4
+	template<class T>
+	inline void _atomic_store(T* volatile* ppointer, T* pointer)
 	{
-	public:
-        virtual ~_connection_base4() { }
-		virtual has_slots<mt_policy>* getdest() const = 0;
-		virtual void emit(arg1_type, arg2_type, arg3_type, arg4_type) = 0;
-		virtual _connection_base4<arg1_type, arg2_type, arg3_type, arg4_type, mt_policy>* clone() = 0;
-		virtual _connection_base4<arg1_type, arg2_type, arg3_type, arg4_type, mt_policy>* duplicate(has_slots<mt_policy>* pnewdest) = 0;
-	};
+		InterlockedExchangePointer((PVOID volatile*)ppointer, pointer);
+	}
     
-	template<class arg1_type, class arg2_type, class arg3_type, class arg4_type,
-	class arg5_type, class mt_policy>
-	class _connection_base5
+	template<class T>
+	inline T* _atomic_exchange(T* volatile* ppointer, T* pointer)
 	{
-	public:
-        virtual ~_connection_base5() { }
-		virtual has_slots<mt_policy>* getdest() const = 0;
-		virtual void emit(arg1_type, arg2_type, arg3_type, arg4_type, 
-                          arg5_type) = 0;
-		virtual _connection_base5<arg1_type, arg2_type, arg3_type, arg4_type,
-        arg5_type, mt_policy>* clone() = 0;
-		virtual _connection_base5<arg1_type, arg2_type, arg3_type, arg4_type,
-        arg5_type, mt_policy>* duplicate(has_slots<mt_policy>* pnewdest) = 0;
-	};
+		return static_cast<T*>(InterlockedExchangePointer((PVOID volatile*)ppointer, pointer));
+	}
     
-	template<class arg1_type, class arg2_type, class arg3_type, class arg4_type,
-	class arg5_type, class arg6_type, class mt_policy>
-	class _connection_base6
+	template<class T>
+	inline bool _atomic_compare_exchange(T* volatile* ppointer, T* expected, T* desired)
 	{
-	public:
-        virtual ~_connection_base6() { }
-		virtual has_slots<mt_policy>* getdest() const = 0;
-		virtual void emit(arg1_type, arg2_type, arg3_type, arg4_type, arg5_type,
-                          arg6_type) = 0;
-		virtual _connection_base6<arg1_type, arg2_type, arg3_type, arg4_type,
-        arg5_type, arg6_type, mt_policy>* clone() = 0;
-		virtual _connection_base6<arg1_type, arg2_type, arg3_type, arg4_type,
-        arg5_type, arg6_type, mt_policy>* duplicate(has_slots<mt_policy>* pnewdest) = 0;
-	};
+		return InterlockedCompareExchangePointer((PVOID volatile*)ppointer, desired, expected) == expected;
+	}
     
-	template<class arg1_type, class arg2_type, class arg3_type, class arg4_type,
-	class arg5_type, class arg6_type, class arg7_type, class mt_policy>
-	class _connection_base7
+	// Untorn, but with no ordering against other memory.
+	template<class T>
+	inline T* _atomic_load_relaxed(T* volatile* ppointer)
 	{
-	public:
-        virtual ~_connection_base7() { }
-		virtual has_slots<mt_policy>* getdest() const = 0;
-		virtual void emit(arg1_type, arg2_type, arg3_type, arg4_type, arg5_type,
-                          arg6_type, arg7_type) = 0;
-		virtual _connection_base7<arg1_type, arg2_type, arg3_type, arg4_type,
-        arg5_type, arg6_type, arg7_type, mt_policy>* clone() = 0;
-		virtual _connection_base7<arg1_type, arg2_type, arg3_type, arg4_type,
-        arg5_type, arg6_type, arg7_type, mt_policy>* duplicate(has_slots<mt_policy>* pnewdest) = 0;
-	};
+		return *ppointer;
+	}
     
-	template<class arg1_type, class arg2_type, class arg3_type, class arg4_type,
-	class arg5_type, class arg6_type, class arg7_type, class arg8_type, class mt_policy>
-	class _connection_base8
+	template<class T>
+	inline void _atomic_store_relaxed(T* volatile* ppointer, T* pointer)
 	{
-	public:
-        virtual ~_connection_base8() { }
-		virtual has_slots<mt_policy>* getdest() const = 0;
-		virtual void emit(arg1_type, arg2_type, arg3_type, arg4_type, arg5_type,
-                          arg6_type, arg7_type, arg8_type) = 0;
-		virtual _connection_base8<arg1_type, arg2_type, arg3_type, arg4_type,
-        arg5_type, arg6_type, arg7_type, arg8_type, mt_policy>* clone() = 0;
-		virtual _connection_base8<arg1_type, arg2_type, arg3_type, arg4_type,
-        arg5_type, arg6_type, arg7_type, arg8_type, mt_policy>* duplicate(has_slots<mt_policy>* pnewdest) = 0;
-	};
+		*ppointer = pointer;
+	}
     
-	template<class mt_policy>
-	class _signal_base : public mt_policy
+	// A store that orders only what comes before it, and a load that
+	// orders only what comes after, for one thread publishing to another.
+	inline long _atomic_load_acquire(volatile long* pvalue)
 	{
-	public:
-		virtual void slot_disconnect(has_slots<mt_policy>* pslot) = 0;
-		virtual void slot_duplicate(const has_slots<mt_policy>* poldslot, has_slots<mt_policy>* pnewslot) = 0;
-	};
+		long value = *pvalue;
+		MemoryBarrier();
+		return value;
+	}
     
-	template<class  mt_policy = SIGSLOT_DEFAULT_MT_POLICY>
-	class has_slots : public mt_policy 
+	inline void _atomic_store_release(volatile long* pvalue, long value)
+	{
+		MemoryBarrier();
+		*pvalue = value;
+	}
+    
+	inline void _thread_yield()
+	{
+		SwitchToThread();
+	}
+    
+	inline unsigned long _os_thread_id()
+	{
+		return (unsigned long)GetCurrentThreadId();
+	}
+    
+	// Used by multi_threaded_adaptive: a hint to the CPU inside a spin loop,
+	// and a wait for a word to change from a value, with its wake up.
+	inline void _cpu_relax()
+	{
+		YieldProcessor();
+	}
+    
+#if defined(_WIN32_WINNT) && _WIN32_WINNT >= 0x0602
+	inline void _address_wait(volatile long* pvalue, long value)
+	{
+		WaitOnAddress(pvalue, &value, sizeof(value), INFINITE);
+	}
+    
+	inline void _address_wake_one(volatile long* pvalue)
+	{
+		WakeByAddressSingle((PVOID)pvalue);
+	}
+#else
+	inline void _address_wait(volatile long*, long)
+	{
+		Sleep(0);
+	}
+    
+	inline void _address_wake_one(volatile long*)
+	{
+		;
+	}
+#endif
+    
+	// Used by _block_pool: a process wide lock for its shared depot, and a
+	// hook that hands a thread's free blocks back when the thread exits.
+	inline void _block_pool_thread_exit(void* pcache);
+    
+	inline SRWLOCK* _block_pool_mutex()
+	{
+		static SRWLOCK s_srwlock = SRWLOCK_INIT;
+		return &s_srwlock;
+	}
+    
+	inline void _block_pool_lock()
+	{
+		AcquireSRWLockExclusive(_block_pool_mutex());
+	}
+    
+	inline void _block_pool_unlock()
+	{
+		ReleaseSRWLockExclusive(_block_pool_mutex());
+	}
+    
+	// Used by emit_statistics to guard its list of live signals, and by
+	// emit_tracing for its list of thread buffers.
+	inline SRWLOCK* _stats_registry_mutex()
+	{
+		static SRWLOCK s_srwlock = SRWLOCK_INIT;
+		return &s_srwlock;
+	}
+    
+	inline void _stats_registry_lock()
+	{
+		AcquireSRWLockExclusive(_stats_registry_mutex());
+	}
+    
+	inline void _stats_registry_unlock()
+	{
+		ReleaseSRWLockExclusive(_stats_registry_mutex());
+	}
+    
+	inline void NTAPI _block_pool_fls_callback(PVOID pcache)
+	{
+		_block_pool_thread_exit(pcache);
+	}
+    
+	inline BOOL CALLBACK _block_pool_fls_alloc(PINIT_ONCE, PVOID, PVOID* pindex)
+	{
+		*pindex = (PVOID)(ULONG_PTR)FlsAlloc(_block_pool_fls_callback);
+		return TRUE;
+	}
+    
+	inline void _block_pool_at_thread_exit(void* pcache)
+	{
+		static INIT_ONCE s_once = INIT_ONCE_STATIC_INIT;
+		PVOID index;
+		InitOnceExecuteOnce(&s_once, _block_pool_fls_alloc, NULL, &index);
+		FlsSetValue((DWORD)(ULONG_PTR)index, pcache);
+	}
+    
+	// Used by thread_pool: a lock with a condition to wait on, and the
+	// threads that run _thread_pool_worker().
+	inline void _thread_pool_worker(void* ppool);
+    
+	class _pool_sync
 	{
-	private:
-		typedef typename std::set<_signal_base<mt_policy> *> sender_set;
-		typedef typename sender_set::const_iterator const_iterator;
-        
 	public:
-		has_slots()
+		_pool_sync()
 		{
-			;
+			InitializeCriticalSection(&m_critsec);
+			InitializeConditionVariable(&m_cond);
 		}
         
-		has_slots(const has_slots& hs)
-        : mt_policy(hs)
+		~_pool_sync()
 		{
-			lock_block<mt_policy> lock(this);
-			const_iterator it = hs.m_senders.begin();
-			const_iterator itEnd = hs.m_senders.end();
-            
-			while(it != itEnd)
-			{
-				(*it)->slot_duplicate(&hs, this);
-				m_senders.insert(*it);
-				++it;
-			}
-		} 
+			DeleteCriticalSection(&m_critsec);
+		}
         
-		void signal_connect(_signal_base<mt_policy>* sender)
+		void lock()
 		{
-			lock_block<mt_policy> lock(this);
-			m_senders.insert(sender);
+			EnterCriticalSection(&m_critsec);
 		}
         
-		void signal_disconnect(_signal_base<mt_policy>* sender)
+		void unlock()
 		{
-			lock_block<mt_policy> lock(this);
-			m_senders.erase(sender);
+			LeaveCriticalSection(&m_critsec);
 		}
         
-		virtual ~has_slots()
+		// Called with the lock held.
+		void wait()
 		{
-			disconnect_all();
+			SleepConditionVariableCS(&m_cond, &m_critsec, INFINITE);
 		}
         
-		void disconnect_all()
+		void wake_all()
 		{
-			lock_block<mt_policy> lock(this);
-			const_iterator it = m_senders.begin();
-			const_iterator itEnd = m_senders.end();
-            
-			while(it != itEnd)
-			{
-				(*it)->slot_disconnect(this);
-				++it;
-			}
-            
-			m_senders.erase(m_senders.begin(), m_senders.end());
+			WakeAllConditionVariable(&m_cond);
 		}
         
 	private:
-		sender_set m_senders;
+		CRITICAL_SECTION m_critsec;
+		CONDITION_VARIABLE m_cond;
 	};
     
-	template<class mt_policy>
-	class _signal_base0 : public _signal_base<mt_policy>
+	typedef HANDLE _pool_thread;
+    
+	inline DWORD WINAPI _pool_thread_entry(LPVOID ppool)
+	{
+		_thread_pool_worker(ppool);
+		return 0;
+	}
+    
+	inline bool _pool_thread_start(_pool_thread* pthread, void* ppool)
+	{
+		*pthread = CreateThread(NULL, 0, _pool_thread_entry, ppool, 0, NULL);
+		return *pthread != NULL;
+	}
+    
+	inline void _pool_thread_join(_pool_thread thread)
+	{
+		WaitForSingleObject(thread, INFINITE);
+		CloseHandle(thread);
+	}
+    
+	inline size_t _hardware_threads()
+	{
+		SYSTEM_INFO info;
+		GetSystemInfo(&info);
+		return info.dwNumberOfProcessors;
+	}
+    
+	// A named region of memory that other processes can map as well, for
+	// shared_signal. create() fails if the name is taken, and open() maps
+	// the whole of a region that another process created. The region goes
+	// once every process has closed it. create_file() maps a file instead,
+	// for emit_tracing, and close_file() cuts it to the bytes used.
+	class _shared_mapping
 	{
 	public:
-		typedef typename std::list<_connection_base0<mt_policy> *>  connections_list;
-		typedef typename connections_list::const_iterator const_iterator;
-		typedef typename connections_list::iterator iterator;
-        
-		_signal_base0()
+		_shared_mapping()
+        : m_hfile(NULL), m_hmapping(NULL), m_paddress(NULL), m_size(0)
 		{
 			;
 		}
         
-		_signal_base0(const _signal_base0& s)
-        : _signal_base<mt_policy>(s)
+		~_shared_mapping()
 		{
-			lock_block<mt_policy> lock(this);
-			const_iterator  it = s.m_connected_slots.begin();
-			const_iterator itEnd = s.m_connected_slots.end();
+			close();
+		}
+        
+		bool create(const char* name, size_t size)
+		{
+			m_hmapping = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE,
+				DWORD((unsigned long long)size >> 32), DWORD(size), name);
             
-			while(it != itEnd)
+			if(m_hmapping != NULL && GetLastError() == ERROR_ALREADY_EXISTS)
 			{
-				(*it)->getdest()->signal_connect(this);
-				m_connected_slots.push_back((*it)->clone());
-                
-				++it;
+				close();
+				return false;
 			}
+            
+			return map(size);
 		}
         
-		~_signal_base0()
+		bool open(const char* name)
 		{
-			disconnect_all();
+			m_hmapping = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, name);
+			return map(0);
 		}
         
-		void disconnect_all()
+		// Makes the file at path, or empties it, with size bytes mapped.
+		bool create_file(const char* path, size_t size)
 		{
-			lock_block<mt_policy> lock(this);
-			const_iterator it  = m_connected_slots.begin();
+			m_hfile = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+            
+			if(m_hfile == INVALID_HANDLE_VALUE)
+			{
+				m_hfile = NULL;
+				return false;
+			}
+            
+			m_hmapping = CreateFileMappingA(m_hfile, NULL, PAGE_READWRITE,
+				DWORD((unsigned long long)size >> 32), DWORD(size), NULL);
+			return map(size);
+		}
+        
+		void close_file(size_t used)
+		{
+			HANDLE hfile = m_hfile;
+			m_hfile = NULL;
+			close();
+            
+			if(hfile != NULL)
+			{
+				LARGE_INTEGER end;
+				end.QuadPart = LONGLONG(used);
+				SetFilePointerEx(hfile, end, NULL, FILE_BEGIN);
+				SetEndOfFile(hfile);
+				CloseHandle(hfile);
+			}
+		}
+        
+		void close()
+		{
+			if(m_paddress != NULL)
+			{
+				UnmapViewOfFile(m_paddress);
+				m_paddress = NULL;
+			}
+            
+			if(m_hmapping != NULL)
+			{
+				CloseHandle(m_hmapping);
+				m_hmapping = NULL;
+			}
+            
+			if(m_hfile != NULL)
+			{
+				CloseHandle(m_hfile);
+				m_hfile = NULL;
+			}
+            
+			m_size = 0;
+		}
+        
+		void* address() const
+		{
+			return m_paddress;
+		}
+        
+		size_t size() const
+		{
+			return m_size;
+		}
+        
+	private:
+		_shared_mapping(const _shared_mapping&);
+		_shared_mapping& operator=(const _shared_mapping&);
+        
+		// A size of 0 maps all of it, and asks how large that is.
+		bool map(size_t size)
+		{
+			if(m_hmapping != NULL)
+			{
+				m_paddress = MapViewOfFile(m_hmapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+			}
+            
+			MEMORY_BASIC_INFORMATION info;
+            
+			if(m_paddress == NULL || VirtualQuery(m_paddress, &info, sizeof(info)) == 0)
+			{
+				close();
+				return false;
+			}
+            
+			m_size = size != 0 ? size : info.RegionSize;
+			return true;
+		}
+        
+		HANDLE m_hfile;
+		HANDLE m_hmapping;
+		void* m_paddress;
+		size_t m_size;
+	};
+#endif // _SIGSLOT_HAS_WIN32_THREADS
+    
+#ifdef _SIGSLOT_HAS_POSIX_THREADS
+	inline void _init_recursive_mutex(pthread_mutex_t* pmutex)
+	{
+		pthread_mutexattr_t attr;
+		pthread_mutexattr_init(&attr);
+		pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+		pthread_mutex_init(pmutex, &attr);
+		pthread_mutexattr_destroy(&attr);
+	}
+    
+	// The multi threading policies only get compiled in if they are enabled.
+	class multi_threaded_global
+	{
+	public:
+		multi_threaded_global()
+		{
+			;
+		}
+        
+		multi_threaded_global(const multi_threaded_global&)
+		{
+			;
+		}
+        
+		~multi_threaded_global()
+		{
+			;
+		}
+        
+		void lock()
+		{
+			pthread_mutex_lock(get_mutex());
+		}
+        
+		void unlock()
+		{
+			pthread_mutex_unlock(get_mutex());
+		}
+        
+	private:
+		// Recursive, since connecting locks the signal and then the
+		// receiver, which share this one mutex. Created once, before the
+		// first object that uses it.
+		static void init_mutex()
+		{
+			_init_recursive_mutex(mutex());
+		}
+        
+		static pthread_mutex_t* mutex()
+		{
+			static pthread_mutex_t g_mutex;
+			return &g_mutex;
+		}
+        
+		pthread_mutex_t* get_mutex()
+		{
+			static pthread_once_t s_once = PTHREAD_ONCE_INIT;
+			pthread_once(&s_once, init_mutex);
+			return mutex();
+		}
+	};
+    
+	class multi_threaded_local
+	{
+	public:
+		multi_threaded_local()
+		{
+			pthread_mutex_init(&m_mutex, NULL);
+		}
+        
+		multi_threaded_local(const multi_threaded_local&)
+		{
+			pthread_mutex_init(&m_mutex, NULL);
+		}
+        
+        ~multi_threaded_local()
+		{
+			pthread_mutex_destroy(&m_mutex);
+		}
+        
+		void lock()
+		{
+			pthread_mutex_lock(&m_mutex);
+		}
+        
+		void unlock()
+		{
+			pthread_mutex_unlock(&m_mutex);
+		}
+        
+	private:
+		pthread_mutex_t m_mutex;
+	};    
+	class multi_threaded_rw
+	{
+	public:
+		multi_threaded_rw()
+		{
+			pthread_rwlock_init(&m_rwlock, NULL);
+		}
+        
+		multi_threaded_rw(const multi_threaded_rw&)
+		{
+			pthread_rwlock_init(&m_rwlock, NULL);
+		}
+        
+		~multi_threaded_rw()
+		{
+			pthread_rwlock_destroy(&m_rwlock);
+		}
+        
+		void lock()
+		{
+			pthread_rwlock_wrlock(&m_rwlock);
+		}
+        
+		void unlock()
+		{
+			pthread_rwlock_unlock(&m_rwlock);
+		}
+        
+		void lock_shared()
+		{
+			pthread_rwlock_rdlock(&m_rwlock);
+		}
+        
+		void unlock_shared()
+		{
+			pthread_rwlock_unlock(&m_rwlock);
+		}
+        
+	private:
+		pthread_rwlock_t m_rwlock;
+	};
+
+    
+	// Atomic operations used by multi_threaded_cow, dispatcher, emit_tracing
+	// and the lazy storage of basic_signal. Every one of them is a full
+	// memory barrier, except for the relaxed, acquire and release ones.
+	// Compilers that predate the __atomic builtins get the older __sync ones.
+#ifdef __ATOMIC_SEQ_CST
+	inline long _atomic_add(volatile long* pvalue, long delta)
+	{
+		return __atomic_add_fetch(pvalue, delta, __ATOMIC_SEQ_CST);
+	}
+    
+	inline long _atomic_load(volatile long* pvalue)
+	{
+		return __atomic_load_n(pvalue, __ATOMIC_SEQ_CST);
+	}
+    
+	inline void _atomic_store(volatile long* pvalue, long value)
+	{
+		__atomic_store_n(pvalue, value, __ATOMIC_SEQ_CST);
+	}
+    
+	inline long _atomic_exchange(volatile long* pvalue, long value)
+	{
+		return __atomic_exchange_n(pvalue, value, __ATOMIC_SEQ_CST);
+	}
+    
+	inline bool _atomic_compare_exchange(volatile long* pvalue, long expected, long desired)
+	{
+		return __atomic_compare_exchange_n(pvalue, &expected, desired, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+	}
+    
+	template<class T>
+	inline T* _atomic_load(T* volatile* ppointer)
+	{
+		return __atomic_load_n(ppointer, __ATOMIC_SEQ_CST);
+	}
+    
+	template<class T>
+	inline void _atomic_store(T* volatile* ppointer, T* pointer)
+	{
+		__atomic_store_n(ppointer, pointer, __ATOMIC_SEQ_CST);
+	}
+    
+	template<class T>
+	inline T* _atomic_exchange(T* volatile* ppointer, T* pointer)
+	{
+		return __atomic_exchange_n(ppointer, pointer, __ATOMIC_SEQ_CST);
+	}
+    
+	template<class T>
+	inline bool _atomic_compare_exchange(T* volatile* ppointer, T* expected, T* desired)
+	{
+		return __atomic_compare_exchange_n(ppointer, &expected, desired, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+	}
+    
+	// Untorn, but with no ordering against other memory.
+	template<class T>
+	inline T* _atomic_load_relaxed(T* volatile* ppointer)
+	{
+		return __atomic_load_n(ppointer, __ATOMIC_RELAXED);
+	}
+    
+	template<class T>
+	inline void _atomic_store_relaxed(T* volatile* ppointer, T* pointer)
+	{
+		__atomic_store_n(ppointer, pointer, __ATOMIC_RELAXED);
+	}
+    
+	// A store that orders only what comes before it, and a load that
+	// orders only what comes after, for one thread publishing to another.
+	inline long _atomic_load_acquire(volatile long* pvalue)
+	{
+		return __atomic_load_n(pvalue, __ATOMIC_ACQUIRE);
+	}
+    
+	inline void _atomic_store_release(volatile long* pvalue, long value)
+	{
+		__atomic_store_n(pvalue, value, __ATOMIC_RELEASE);
+	}
+#else
+	inline long _atomic_add(volatile long* pvalue, long delta)
+	{
+		return __sync_add_and_fetch(pvalue, delta);
+	}
+    
+	inline long _atomic_load(volatile long* pvalue)
+	{
+		__sync_synchronize();
+		long value = *pvalue;
+		__sync_synchronize();
+		return value;
+	}
+    
+	inline void _atomic_store(volatile long* pvalue, long value)
+	{
+		__sync_synchronize();
+		*pvalue = value;
+		__sync_synchronize();
+	}
+    
+	inline long _atomic_exchange(volatile long* pvalue, long value)
+	{
+		long previous = __sync_lock_test_and_set(pvalue, value);
+		__sync_synchronize();
+		return previous;
+	}
+    
+	inline bool _atomic_compare_exchange(volatile long* pvalue, long expected, long desired)
+	{
+		return __sync_bool_compare_and_swap(pvalue, expected, desired);
+	}
+    
+	template<class T>
+	inline T* _atomic_load(T* volatile* ppointer)
+	{
+		__sync_synchronize();
+		T* pointer = *ppointer;
+		__sync_synchronize();
+		return pointer;
+	}
+    
+	template<class T>
+	inline void _atomic_store(T* volatile* ppointer, T* pointer)
+	{
+		__sync_synchronize();
+		*ppointer = pointer;
+		__sync_synchronize();
+	}
+    
+	template<class T>
+	inline T* _atomic_exchange(T* volatile* ppointer, T* pointer)
+	{
+		T* previous = __sync_lock_test_and_set(ppointer, pointer);
+		__sync_synchronize();
+		return previous;
+	}
+    
+	template<class T>
+	inline bool _atomic_compare_exchange(T* volatile* ppointer, T* expected, T* desired)
+	{
+		return __sync_bool_compare_and_swap(ppointer, expected, desired);
+	}
+    
+	template<class T>
+	inline T* _atomic_load_relaxed(T* volatile* ppointer)
+	{
+		return *ppointer;
+	}
+    
+	template<class T>
+	inline void _atomic_store_relaxed(T* volatile* ppointer, T* pointer)
+	{
+		*ppointer = pointer;
+	}
+    
+	// A store that orders only what comes before it, and a load that
+	// orders only what comes after, for one thread publishing to another.
+	inline long _atomic_load_acquire(volatile long* pvalue)
+	{
+		long value = *pvalue;
+		__sync_synchronize();
+		return value;
+	}
+    
+	inline void _atomic_store_release(volatile long* pvalue, long value)
+	{
+		__sync_synchronize();
+		*pvalue = value;
+	}
+#endif
+    
+	inline void _thread_yield()
+	{
+		sched_yield();
+	}
+    
+	// The kernel's number for the calling thread where there is one, as
+	// debuggers and profilers show it.
+	inline unsigned long _os_thread_id()
+	{
+#if defined(__linux__) && defined(SYS_gettid)
+		return (unsigned long)syscall(SYS_gettid);
+#else
+		return (unsigned long)(size_t)pthread_self();
+#endif
+	}
+    
+	// Used by multi_threaded_adaptive: a hint to the CPU inside a spin loop,
+	// and a wait for a word to change from a value, with its wake up. The
+	// futex works on the low 32 bits of the word, which on a big endian
+	// machine with 64 bit longs are the second half.
+	inline void _cpu_relax()
+	{
+#if defined(__i386__) || defined(__x86_64__)
+		__builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+		__asm__ __volatile__("yield");
+#endif
+	}
+    
+#if defined(__linux__) && defined(SYS_futex)
+	inline int* _futex_word(volatile long* pvalue)
+	{
+		int* pword = (int*)pvalue;
+		return sizeof(long) > sizeof(int) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__ ? pword + 1 : pword;
+	}
+    
+	inline void _address_wait(volatile long* pvalue, long value)
+	{
+		syscall(SYS_futex, _futex_word(pvalue), FUTEX_WAIT_PRIVATE, int(value), NULL, NULL, 0);
+	}
+    
+	inline void _address_wake_one(volatile long* pvalue)
+	{
+		syscall(SYS_futex, _futex_word(pvalue), FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+	}
+#else
+	inline void _address_wait(volatile long*, long)
+	{
+		sched_yield();
+	}
+    
+	inline void _address_wake_one(volatile long*)
+	{
+		;
+	}
+#endif
+    
+	// Used by _block_pool: a process wide lock for its shared depot, and a
+	// hook that hands a thread's free blocks back when the thread exits.
+	inline void _block_pool_thread_exit(void* pcache);
+    
+	inline pthread_mutex_t* _block_pool_mutex()
+	{
+		static pthread_mutex_t s_mutex = PTHREAD_MUTEX_INITIALIZER;
+		return &s_mutex;
+	}
+    
+	inline void _block_pool_lock()
+	{
+		pthread_mutex_lock(_block_pool_mutex());
+	}
+    
+	inline void _block_pool_unlock()
+	{
+		pthread_mutex_unlock(_block_pool_mutex());
+	}
+    
+	// Used by emit_statistics to guard its list of live signals, and by
+	// emit_tracing for its list of thread buffers.
+	inline pthread_mutex_t* _stats_registry_mutex()
+	{
+		static pthread_mutex_t s_mutex = PTHREAD_MUTEX_INITIALIZER;
+		return &s_mutex;
+	}
+    
+	inline void _stats_registry_lock()
+	{
+		pthread_mutex_lock(_stats_registry_mutex());
+	}
+    
+	inline void _stats_registry_unlock()
+	{
+		pthread_mutex_unlock(_stats_registry_mutex());
+	}
+    
+	inline pthread_key_t* _block_pool_key()
+	{
+		static pthread_key_t s_key;
+		return &s_key;
+	}
+    
+	inline void _block_pool_key_create()
+	{
+		pthread_key_create(_block_pool_key(), _block_pool_thread_exit);
+	}
+    
+	inline void _block_pool_at_thread_exit(void* pcache)
+	{
+		static pthread_once_t s_once = PTHREAD_ONCE_INIT;
+		pthread_once(&s_once, _block_pool_key_create);
+		pthread_setspecific(*_block_pool_key(), pcache);
+	}
+    
+	// Used by thread_pool: a lock with a condition to wait on, and the
+	// threads that run _thread_pool_worker().
+	inline void _thread_pool_worker(void* ppool);
+    
+	class _pool_sync
+	{
+	public:
+		_pool_sync()
+		{
+			pthread_mutex_init(&m_mutex, NULL);
+			pthread_cond_init(&m_cond, NULL);
+		}
+        
+		~_pool_sync()
+		{
+			pthread_cond_destroy(&m_cond);
+			pthread_mutex_destroy(&m_mutex);
+		}
+        
+		void lock()
+		{
+			pthread_mutex_lock(&m_mutex);
+		}
+        
+		void unlock()
+		{
+			pthread_mutex_unlock(&m_mutex);
+		}
+        
+		// Called with the lock held.
+		void wait()
+		{
+			pthread_cond_wait(&m_cond, &m_mutex);
+		}
+        
+		void wake_all()
+		{
+			pthread_cond_broadcast(&m_cond);
+		}
+        
+	private:
+		pthread_mutex_t m_mutex;
+		pthread_cond_t m_cond;
+	};
+    
+	typedef pthread_t _pool_thread;
+    
+	inline void* _pool_thread_entry(void* ppool)
+	{
+		_thread_pool_worker(ppool);
+		return NULL;
+	}
+    
+	inline bool _pool_thread_start(_pool_thread* pthread, void* ppool)
+	{
+		return pthread_create(pthread, NULL, _pool_thread_entry, ppool) == 0;
+	}
+    
+	inline void _pool_thread_join(_pool_thread thread)
+	{
+		pthread_join(thread, NULL);
+	}
+    
+	inline size_t _hardware_threads()
+	{
+		long count = sysconf(_SC_NPROCESSORS_ONLN);
+		return count > 0 ? size_t(count) : 1;
+	}
+    
+	// A named region of memory that other processes can map as well, for
+	// shared_signal: a POSIX shared memory object, so the name starts with
+	// a slash. create() fails if the name is taken, and open() maps the
+	// whole of a region that another process created. The creator removes
+	// the name when it closes; mappings that other processes hold stay.
+	// create_file() maps a file instead, for emit_tracing, and close_file()
+	// cuts it to the bytes used.
+	class _shared_mapping
+	{
+	public:
+		_shared_mapping()
+        : m_paddress(NULL), m_size(0), m_file(-1)
+		{
+			;
+		}
+        
+		~_shared_mapping()
+		{
+			close();
+		}
+        
+		bool create(const char* name, size_t size)
+		{
+			int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+            
+			if(fd < 0)
+			{
+				return false;
+			}
+            
+			if(ftruncate(fd, off_t(size)) != 0 || !map(fd, size))
+			{
+				::close(fd);
+				shm_unlink(name);
+				return false;
+			}
+            
+			::close(fd);
+			m_name.assign(name, name + std::strlen(name) + 1);
+			return true;
+		}
+        
+		bool open(const char* name)
+		{
+			int fd = shm_open(name, O_RDWR, 0);
+            
+			if(fd < 0)
+			{
+				return false;
+			}
+            
+			struct stat info;
+			bool mapped = fstat(fd, &info) == 0 && info.st_size > 0 && map(fd, size_t(info.st_size));
+			::close(fd);
+			return mapped;
+		}
+        
+		// Makes the file at path, or empties it, with size bytes mapped.
+		bool create_file(const char* path, size_t size)
+		{
+			int fd = ::open(path, O_CREAT | O_TRUNC | O_RDWR, 0644);
+            
+			if(fd < 0)
+			{
+				return false;
+			}
+            
+			if(ftruncate(fd, off_t(size)) != 0 || !map(fd, size))
+			{
+				::close(fd);
+				return false;
+			}
+            
+			m_file = fd;
+			return true;
+		}
+        
+		void close_file(size_t used)
+		{
+			int fd = m_file;
+			m_file = -1;
+			close();
+            
+			if(fd >= 0)
+			{
+				int cut = ftruncate(fd, off_t(used));
+				(void)cut;
+				::close(fd);
+			}
+		}
+        
+		void close()
+		{
+			if(m_paddress != NULL)
+			{
+				munmap(m_paddress, m_size);
+				m_paddress = NULL;
+				m_size = 0;
+			}
+            
+			if(m_file >= 0)
+			{
+				::close(m_file);
+				m_file = -1;
+			}
+            
+			if(!m_name.empty())
+			{
+				shm_unlink(&m_name[0]);
+				m_name.clear();
+			}
+		}
+        
+		void* address() const
+		{
+			return m_paddress;
+		}
+        
+		size_t size() const
+		{
+			return m_size;
+		}
+        
+	private:
+		_shared_mapping(const _shared_mapping&);
+		_shared_mapping& operator=(const _shared_mapping&);
+        
+		bool map(int fd, size_t size)
+		{
+			void* paddress = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            
+			if(paddress == MAP_FAILED)
+			{
+				return false;
+			}
+            
+			m_paddress = paddress;
+			m_size = size;
+			return true;
+		}
+        
+		void* m_paddress;
+		size_t m_size;
+		int m_file;
+		std::vector<char> m_name;
+	};
+#endif // _SIGSLOT_HAS_POSIX_THREADS
+    
+#ifdef _SIGSLOT_SINGLE_THREADED
+	// Without thread support the atomic operations are plain ones.
+	inline long _atomic_add(volatile long* pvalue, long delta)
+	{
+		return *pvalue += delta;
+	}
+    
+	inline long _atomic_load(volatile long* pvalue)
+	{
+		return *pvalue;
+	}
+    
+	inline void _atomic_store(volatile long* pvalue, long value)
+	{
+		*pvalue = value;
+	}
+    
+	inline long _atomic_exchange(volatile long* pvalue, long value)
+	{
+		long previous = *pvalue;
+		*pvalue = value;
+		return previous;
+	}
+    
+	inline bool _atomic_compare_exchange(volatile long* pvalue, long expected, long desired)
+	{
+		if(*pvalue != expected)
+		{
+			return false;
+		}
+        
+		*pvalue = desired;
+		return true;
+	}
+    
+	template<class T>
+	inline T* _atomic_load(T* volatile* ppointer)
+	{
+		return *ppointer;
+	}
+    
+	template<class T>
+	inline void _atomic_store(T* volatile* ppointer, T* pointer)
+	{
+		*ppointer = pointer;
+	}
+    
+	template<class T>
+	inline T* _atomic_exchange(T* volatile* ppointer, T* pointer)
+	{
+		T* previous = *ppointer;
+		*ppointer = pointer;
+		return previous;
+	}
+    
+	template<class T>
+	inline bool _atomic_compare_exchange(T* volatile* ppointer, T* expected, T* desired)
+	{
+		if(*ppointer != expected)
+		{
+			return false;
+		}
+        
+		*ppointer = desired;
+		return true;
+	}
+    
+	template<class T>
+	inline T* _atomic_load_relaxed(T* volatile* ppointer)
+	{
+		return *ppointer;
+	}
+    
+	template<class T>
+	inline void _atomic_store_relaxed(T* volatile* ppointer, T* pointer)
+	{
+		*ppointer = pointer;
+	}
+    
+	// A store that orders only what comes before it, and a load that
+	// orders only what comes after, for one thread publishing to another.
+	inline long _atomic_load_acquire(volatile long* pvalue)
+	{
+		return *pvalue;
+	}
+    
+	inline void _atomic_store_release(volatile long* pvalue, long value)
+	{
+		*pvalue = value;
+	}
+    
+	// There is no other thread to wait for.
+	inline void _thread_yield()
+	{
+		;
+	}
+    
+	inline unsigned long _os_thread_id()
+	{
+		return 1;
+	}
+#endif // _SIGSLOT_SINGLE_THREADED
+    
+	template<class mt_policy>
+	class lock_block
+	{
+	public:
+		mt_policy *m_mutex;
+        
+		lock_block(mt_policy *mtx)
+        : m_mutex(mtx)
+		{
+			m_mutex->lock();
+		}
+        
+		~lock_block()
+		{
+			m_mutex->unlock();
+		}
+	};
+    
+	// Takes the shared side of a reader/writer policy such as
+	// multi_threaded_rw.
+	template<class mt_policy>
+	class lock_block_shared
+	{
+	public:
+		mt_policy *m_mutex;
+        
+		lock_block_shared(mt_policy *mtx)
+        : m_mutex(mtx)
+		{
+			m_mutex->lock_shared();
+		}
+        
+		~lock_block_shared()
+		{
+			m_mutex->unlock_shared();
+		}
+	};
+    
+	// The lock emit() holds while it walks a signal's connections. For the
+	// mutex based policies this is simply their lock.
+	template<class mt_policy>
+	class emit_lock_block : public lock_block<mt_policy>
+	{
+	public:
+		emit_lock_block(mt_policy *mtx)
+        : lock_block<mt_policy>(mtx)
+		{
+			;
+		}
+	};
+    
+	// Whether connections can change while an emit is walking them under
+	// emit_lock_block. Only an emitting thread's own slots can change them
+	// otherwise.
+	template<class mt_policy>
+	struct _lock_free_emit
+	{
+		enum { value = false };
+	};
+    
+	// Whether the slots that an emit() calls may use the same signal again:
+	// connect to it, disconnect any of its connections, destroy receivers
+	// or emit it. Policies say so when emit() holds their exclusive lock,
+	// so that the signal can tell the calling thread has it already and
+	// not take it again.
+	template<class mt_policy>
+	struct _reentrant_emit
+	{
+		enum { value = false };
+	};
+    
+	template<>
+	struct _reentrant_emit<single_threaded>
+	{
+		enum { value = true };
+	};
+    
+	// A lock for a small piece of state that is only ever taken last and
+	// held for a few instructions, with no other lock taken inside it. Its
+	// type is never the policy's own, so that it cannot be the same mutex
+	// as a signal's: multi_threaded_global would make it the one mutex
+	// that every signal holds.
+	template<class mt_policy>
+	struct _leaf_lock
+	{
+		typedef mt_policy type;
+	};
+    
+	// Tells threads apart: the address of a variable that each thread has
+	// its own copy of.
+	inline void* _current_thread()
+	{
+		static _SIGSLOT_THREAD_LOCAL char s_tag;
+		return &s_tag;
+	}
+    
+	// The emit_parallel() job whose slots the calling thread is running, or
+	// NULL: the job's _parallel_lock.
+	inline void*& _current_job()
+	{
+		static _SIGSLOT_THREAD_LOCAL void* s_pjob = NULL;
+		return s_pjob;
+	}
+    
+	// Stands in for a signal's lock while an emit_parallel() job runs. The
+	// emitting thread holds the signal's lock throughout, so the threads
+	// running the job's slots, the emitting one among them, take this one
+	// instead. It is recursive, since a slot that emits the signal again
+	// holds it while the slots of that emit run.
+	template<class mt_policy>
+	class _parallel_lock
+	{
+	public:
+		_parallel_lock()
+        : m_powner(NULL), m_depth(0)
+		{
+			;
+		}
+        
+		void lock()
+		{
+			// Only the owner can find its own tag here.
+			if(_atomic_load_relaxed(&m_powner) != _current_thread())
+			{
+				m_lock.lock();
+				_atomic_store_relaxed(&m_powner, _current_thread());
+			}
+            
+			++m_depth;
+		}
+        
+		void unlock()
+		{
+			if(--m_depth == 0)
+			{
+				_atomic_store_relaxed(&m_powner, static_cast<void*>(NULL));
+				m_lock.unlock();
+			}
+		}
+        
+	private:
+		typename _leaf_lock<mt_policy>::type m_lock;
+		void* volatile m_powner;
+		int m_depth;
+	};
+    
+	// Locks a signal unless held says the calling thread holds its lock
+	// already, or locks pjob instead when the thread is running a slot of
+	// the signal's emit_parallel() job.
+	template<class mt_policy>
+	class _reentrant_lock_block
+	{
+	public:
+		_reentrant_lock_block(mt_policy *psignal, bool held, _parallel_lock<mt_policy>* pjob = NULL)
+        : m_mutex(held || pjob != NULL ? NULL : psignal), m_pjob(pjob)
+		{
+			if(m_pjob != NULL)
+			{
+				m_pjob->lock();
+			}
+			else if(m_mutex != NULL)
+			{
+				m_mutex->lock();
+			}
+		}
+        
+		~_reentrant_lock_block()
+		{
+			if(m_pjob != NULL)
+			{
+				m_pjob->unlock();
+			}
+			else if(m_mutex != NULL)
+			{
+				m_mutex->unlock();
+			}
+		}
+        
+	private:
+		mt_policy *m_mutex;
+		_parallel_lock<mt_policy>* m_pjob;
+	};
+    
+	// The lock emit() takes: emit_lock_block, or for a policy with
+	// _reentrant_emit nothing more when the thread is in an emit already,
+	// and the job's lock in a slot of an emit_parallel() job.
+	template<class mt_policy, bool reentrant = _reentrant_emit<mt_policy>::value>
+	class _emit_guard : public emit_lock_block<mt_policy>
+	{
+	public:
+		_emit_guard(mt_policy *psignal, bool, _parallel_lock<mt_policy>* = NULL)
+        : emit_lock_block<mt_policy>(psignal)
+		{
+			;
+		}
+	};
+    
+	template<class mt_policy>
+	class _emit_guard<mt_policy, true> : public _reentrant_lock_block<mt_policy>
+	{
+	public:
+		_emit_guard(mt_policy *psignal, bool held, _parallel_lock<mt_policy>* pjob = NULL)
+        : _reentrant_lock_block<mt_policy>(psignal, held, pjob)
+		{
+			;
+		}
+	};
+    
+#ifndef _SIGSLOT_SINGLE_THREADED
+	// Writers (connect, disconnect, copying) serialise on a mutex of their
+	// own, as with multi_threaded_local. Emitting takes no lock at all: it
+	// reads an immutable snapshot of the connections instead. See
+	// _cow_connections.
+	class multi_threaded_cow : public multi_threaded_local
+	{
+	};
+    
+	template<>
+	class emit_lock_block<multi_threaded_cow>
+	{
+	public:
+		emit_lock_block(multi_threaded_cow *)
+		{
+			;
+		}
+	};
+    
+	template<>
+	struct _lock_free_emit<multi_threaded_cow>
+	{
+		enum { value = true };
+	};
+    
+	// A lock in one word: 0 when free, 1 when held, and 2 when held with
+	// threads that may be waiting in the OS. lock() spins first, pausing
+	// twice as long each round up to SIGSLOT_SPIN_LIMIT, and then marks the
+	// word 2 and waits on it; unlock() only enters the OS to wake a waiter
+	// when the word was 2.
+	class multi_threaded_adaptive
+	{
+	public:
+		multi_threaded_adaptive()
+        : m_state(0)
+		{
+			;
+		}
+        
+		multi_threaded_adaptive(const multi_threaded_adaptive&)
+        : m_state(0)
+		{
+			;
+		}
+        
+		~multi_threaded_adaptive()
+		{
+			;
+		}
+        
+		void lock()
+		{
+			if(!_atomic_compare_exchange(&m_state, 0, 1))
+			{
+				lock_contended();
+			}
+		}
+        
+		void unlock()
+		{
+			if(_atomic_exchange(&m_state, 0) == 2)
+			{
+				_address_wake_one(&m_state);
+			}
+		}
+        
+	private:
+		void lock_contended()
+		{
+			static const bool s_spin = _hardware_threads() > 1;
+            
+			for(unsigned pauses = 1; s_spin && pauses <= SIGSLOT_SPIN_LIMIT; pauses *= 2)
+			{
+				for(unsigned i = 0; i < pauses; ++i)
+				{
+					_cpu_relax();
+				}
+                
+				if(_atomic_load(&m_state) == 0 && _atomic_compare_exchange(&m_state, 0, 1))
+				{
+					return;
+				}
+			}
+            
+			while(_atomic_exchange(&m_state, 2) != 0)
+			{
+				_address_wait(&m_state, 2);
+			}
+		}
+        
+		volatile long m_state;
+	};
+    
+	template<>
+	struct _leaf_lock<multi_threaded_global>
+	{
+		typedef multi_threaded_adaptive type;
+	};
+    
+	template<>
+	struct _leaf_lock<multi_threaded_local>
+	{
+		typedef multi_threaded_adaptive type;
+	};
+    
+	template<>
+	struct _leaf_lock<multi_threaded_rw>
+	{
+		typedef multi_threaded_adaptive type;
+	};
+    
+	template<>
+	struct _leaf_lock<multi_threaded_cow>
+	{
+		typedef multi_threaded_adaptive type;
+	};
+    
+	template<>
+	struct _reentrant_emit<multi_threaded_global>
+	{
+		enum { value = true };
+	};
+    
+	template<>
+	struct _reentrant_emit<multi_threaded_local>
+	{
+		enum { value = true };
+	};
+    
+	template<>
+	struct _reentrant_emit<multi_threaded_adaptive>
+	{
+		enum { value = true };
+	};
+    
+	// Any number of emits run at once; everything that changes the
+	// connections takes the exclusive side.
+	template<>
+	class emit_lock_block<multi_threaded_rw> : public lock_block_shared<multi_threaded_rw>
+	{
+	public:
+		emit_lock_block(multi_threaded_rw *mtx)
+        : lock_block_shared<multi_threaded_rw>(mtx)
+		{
+			;
+		}
+	};
+#endif // _SIGSLOT_SINGLE_THREADED
+    
+	// Instrumentation policies decide what a signal records about its
+	// emits; SIGSLOT_INSTRUMENTATION_POLICY picks the one every signal uses.
+	// A policy provides four types. signal_stats is a base class of every
+	// signal, and emit() calls its note_* functions. connection_stats is a
+	// base class of every connection; a signal being copied hands each
+	// connection it clones to stats_clone(). timer is started when constructed and
+	// handed to the note_* functions that take one. histogram is what a
+	// signal reports for each of its connections.
+	//
+	// no_instrumentation: all of it is empty and inline, so it compiles away.
+	class no_instrumentation
+	{
+	public:
+		class timer
+		{
+		};
+        
+		class connection_stats
+		{
+		};
+        
+		class histogram
+		{
+		};
+        
+		class signal_stats
+		{
+		public:
+			void note_emit(size_t)
+			{
+				;
+			}
+            
+			void note_lock_wait(const timer&)
+			{
+				;
+			}
+            
+			void note_slot_call(connection_stats&, const timer&)
+			{
+				;
+			}
+            
+		protected:
+			void stats_register()
+			{
+				;
+			}
+            
+			void stats_unregister()
+			{
+				;
+			}
+            
+			void stats_clone(connection_stats&)
+			{
+				;
+			}
+		};
+	};
+    
+	// emit_statistics: each signal counts its emits and slot calls and the
+	// time emit() spends waiting for the signal's lock, and each connection
+	// keeps a histogram of how long its slot takes. Signals register
+	// themselves while they are alive, so that collect() and dump() can
+	// report on all of them; set_name() gives a signal a name to report it
+	// by. The counters are atomic, so the cost is a clock read per slot
+	// call and a few locked adds per emit.
+	class emit_statistics
+	{
+	public:
+		class timer
+		{
+		public:
+			timer()
+            : m_start(std::chrono::steady_clock::now())
+			{
+				;
+			}
+            
+			long elapsed_ns() const
+			{
+				return long(std::chrono::duration_cast<std::chrono::nanoseconds>(
+					std::chrono::steady_clock::now() - m_start).count());
+			}
+            
+		private:
+			std::chrono::steady_clock::time_point m_start;
+		};
+        
+		// Slot call latencies in power of two buckets: bucket i counts calls
+		// that took from 2^i up to 2^(i+1) nanoseconds, and bucket 0 also
+		// counts anything quicker.
+		class histogram
+		{
+		public:
+			enum { buckets = 32 };
+            
+			histogram()
+			{
+				for(size_t i = 0; i < buckets; ++i)
+				{
+					m_counts[i] = 0;
+				}
+			}
+            
+			histogram(const histogram& other)
+			{
+				copy(other);
+			}
+            
+			histogram& operator=(const histogram& other)
+			{
+				copy(other);
+				return *this;
+			}
+            
+			void add(long ns)
+			{
+				size_t bucket = 0;
+                
+				while(ns > 1 && bucket < size_t(buckets) - 1)
+				{
+					ns >>= 1;
+					++bucket;
+				}
+                
+				_atomic_add(&m_counts[bucket], 1);
+			}
+            
+			long count(size_t bucket) const
+			{
+				return _atomic_load(const_cast<volatile long*>(&m_counts[bucket]));
+			}
+            
+			long total() const
+			{
+				long sum = 0;
+                
+				for(size_t i = 0; i < buckets; ++i)
+				{
+					sum += count(i);
+				}
+                
+				return sum;
+			}
+            
+		private:
+			void copy(const histogram& other)
+			{
+				for(size_t i = 0; i < buckets; ++i)
+				{
+					m_counts[i] = other.count(i);
+				}
+			}
+            
+			volatile long m_counts[buckets];
+		};
+        
+		// The histogram lives on the heap, so that connections still fit
+		// the cells of vector_storage.
+		class connection_stats
+		{
+		public:
+			connection_stats()
+            : m_platency(new histogram)
+			{
+				;
+			}
+            
+			connection_stats(const connection_stats& other)
+            : m_platency(new histogram(*other.m_platency))
+			{
+				;
+			}
+            
+			~connection_stats()
+			{
+				delete m_platency;
+			}
+            
+			histogram& latency() const
+			{
+				return *m_platency;
+			}
+            
+		private:
+			connection_stats& operator=(const connection_stats&);
+            
+			histogram* m_platency;
+		};
+        
+		class signal_stats
+		{
+		public:
+			signal_stats()
+            : m_emits(0), m_slot_calls(0), m_lock_wait_ns(0), m_name(NULL), m_pins(0)
+			{
+				;
+			}
+            
+			// A copy of a signal starts counting afresh.
+			signal_stats(const signal_stats& other)
+            : m_emits(0), m_slot_calls(0), m_lock_wait_ns(0), m_name(other.m_name), m_pins(0)
+			{
+				;
+			}
+            
+			virtual ~signal_stats()
+			{
+				;
+			}
+            
+			// The name has to outlive the signal; a string literal is ideal.
+			void set_name(const char* name)
+			{
+				m_name = name;
+			}
+            
+			void note_emit(size_t events)
+			{
+				_atomic_add(&m_emits, long(events));
+			}
+            
+			void note_lock_wait(const timer& wait)
+			{
+				_atomic_add(&m_lock_wait_ns, wait.elapsed_ns());
+			}
+            
+			void note_slot_call(connection_stats& stats, const timer& call)
+			{
+				_atomic_add(&m_slot_calls, 1);
+				stats.latency().add(call.elapsed_ns());
+			}
+            
+		protected:
+			// Called by the signal once it is fully constructed and before
+			// it starts to come apart, since collect() calls back into it.
+			void stats_register()
+			{
+				lock_registry();
+				registry().push_back(this);
+				unlock_registry();
+			}
+            
+			void stats_unregister()
+			{
+				lock_registry();
+#ifndef _SIGSLOT_SINGLE_THREADED
+				while(m_pins != 0)
+				{
+					unlock_registry();
+					_thread_yield();
+					lock_registry();
+				}
+#endif
+                
+				registry().remove(this);
+				unlock_registry();
+			}
+            
+			void stats_clone(connection_stats&)
+			{
+				;
+			}
+            
+			// Copies the histogram of every connection, in emit order.
+			virtual void collect_connections(std::vector<histogram>& stats) = 0;
+            
+		private:
+			signal_stats& operator=(const signal_stats&);
+            
+			friend class emit_statistics;
+            
+			volatile long m_emits;
+			volatile long m_slot_calls;
+			volatile long m_lock_wait_ns;
+			const char* m_name;
+			long m_pins;
+		};
+        
+		// What collect() reports about one signal. psignal is the address
+		// of the storage the signal allocated when first connected, which
+		// stays put if the signal is moved; a signal never connected to is
+		// not reported.
+		struct report
+		{
+			const void* psignal;
+			const char* name;
+			long emits;
+			long slot_calls;
+			long lock_wait_ns;
+			std::vector<histogram> connections;
+		};
+        
+		// Appends a report for every live signal. Each signal is locked
+		// only while its connections are read, and the registry is not
+		// locked meanwhile, so this is safe to call at any time from any
+		// thread other than from a slot of a signal being reported on.
+		static void collect(std::vector<report>& reports)
+		{
+			lock_registry();
+			registry_list& signals = registry();
+			registry_list::iterator it = signals.begin();
+            
+			while(it != signals.end())
+			{
+				signal_stats* pstats = *it;
+				++pstats->m_pins;
+				unlock_registry();
+                
+				reports.push_back(report());
+				report& r = reports.back();
+				r.psignal = pstats;
+				r.name = pstats->m_name;
+				r.emits = _atomic_load(&pstats->m_emits);
+				r.slot_calls = _atomic_load(&pstats->m_slot_calls);
+				r.lock_wait_ns = _atomic_load(&pstats->m_lock_wait_ns);
+				pstats->collect_connections(r.connections);
+                
+				lock_registry();
+				--pstats->m_pins;
+				++it;
+			}
+            
+			unlock_registry();
+		}
+        
+		// Writes the reports from collect() to pfile as text, one line per
+		// signal and one per connection that has been called.
+		static void dump(FILE* pfile)
+		{
+			std::vector<report> reports;
+			collect(reports);
+            
+			for(size_t i = 0; i < reports.size(); ++i)
+			{
+				const report& r = reports[i];
+				fprintf(pfile, "signal %p %s: emits %ld, slot calls %ld, lock wait %ld ns\n",
+					r.psignal, r.name ? r.name : "(unnamed)", r.emits, r.slot_calls, r.lock_wait_ns);
+                
+				for(size_t c = 0; c < r.connections.size(); ++c)
+				{
+					const histogram& h = r.connections[c];
+                    
+					if(h.total() == 0)
+					{
+						continue;
+					}
+                    
+					fprintf(pfile, "\tconnection %lu: %ld calls, ns buckets", (unsigned long)c, h.total());
+                    
+					for(size_t b = 0; b < histogram::buckets; ++b)
+					{
+						if(h.count(b) != 0)
+						{
+							fprintf(pfile, " [%lu]=%ld", 1UL << b, h.count(b));
+						}
+					}
+                    
+					fprintf(pfile, "\n");
+				}
+			}
+		}
+        
+	private:
+		typedef std::list<signal_stats*> registry_list;
+        
+		static registry_list& registry()
+		{
+			static registry_list s_signals;
+			return s_signals;
+		}
+        
+		static void lock_registry()
+		{
+#ifndef _SIGSLOT_SINGLE_THREADED
+			_stats_registry_lock();
+#endif
+		}
+        
+		static void unlock_registry()
+		{
+#ifndef _SIGSLOT_SINGLE_THREADED
+			_stats_registry_unlock();
+#endif
+		}
+	};
+    
+	// emit_tracing: a timeline rather than totals. Every slot call and
+	// every wait for a signal's lock becomes a fixed size record, with the
+	// signal, the connection, and its start and end in clock ticks, written
+	// to a ring buffer of the calling thread's own with no lock taken.
+	// write_chrome_trace() drains every thread's buffer into the JSON
+	// format that chrome://tracing and Perfetto open. A buffer that fills
+	// between drains drops records and counts them.
+	//
+	// The ticks are the processor's time stamp counter on x86 with GCC or
+	// Clang, converted to time when the trace is written, and steady_clock
+	// nanoseconds elsewhere.
+	class emit_tracing
+	{
+	public:
+		enum record_kind
+		{
+			slot_call,
+			lock_wait
+		};
+        
+		struct record
+		{
+			const void* psignal;
+			const char* name;
+			unsigned long connection;
+			long long begin;
+			long long end;
+			record_kind kind;
+		};
+        
+		class timer
+		{
+		public:
+			timer()
+            : m_begin(ticks())
+			{
+				;
+			}
+            
+			long long begin() const
+			{
+				return m_begin;
+			}
+            
+		private:
+			long long m_begin;
+		};
+        
+		// Numbers every connection, for the trace to tell them apart. A
+		// connection moved between cells of vector_storage keeps its number;
+		// one cloned for a copy of its signal is given a new one.
+		class connection_stats
+		{
+		public:
+			connection_stats()
+            : m_id(next_id())
+			{
+				;
+			}
+            
+			unsigned long id() const
+			{
+				return m_id;
+			}
+            
+			void renumber()
+			{
+				m_id = next_id();
+			}
+            
+		private:
+			connection_stats& operator=(const connection_stats&);
+            
+			unsigned long m_id;
+		};
+        
+		class histogram
+		{
+		};
+        
+		class signal_stats
+		{
+		public:
+			signal_stats()
+            : m_name(NULL)
+			{
+				;
+			}
+            
+			// The name has to outlive the trace being written, as records
+			// keep it; a string literal is ideal.
+			void set_name(const char* name)
+			{
+				m_name = name;
+			}
+            
+			void note_emit(size_t)
+			{
+				;
+			}
+            
+			void note_lock_wait(const timer& wait)
+			{
+				add(lock_wait, 0, wait);
+			}
+            
+			void note_slot_call(connection_stats& stats, const timer& call)
+			{
+				add(slot_call, stats.id(), call);
+			}
+            
+		protected:
+			void stats_register()
+			{
+				;
+			}
+            
+			void stats_unregister()
+			{
+				;
+			}
+            
+			void stats_clone(connection_stats& clone)
+			{
+				clone.renumber();
+			}
+            
+		private:
+			signal_stats& operator=(const signal_stats&);
+            
+			void add(record_kind kind, unsigned long connection, const timer& t)
+			{
+				record r;
+				r.psignal = this;
+				r.name = m_name;
+				r.connection = connection;
+				r.begin = t.begin();
+				r.end = ticks();
+				r.kind = kind;
+				local_buffer().push(r);
+			}
+            
+			const char* m_name;
+		};
+        
+		// Writes every record made since the last call as one complete
+		// trace, and returns how many there were. Threads may go on
+		// recording meanwhile; what they add now is left for the next call.
+		static size_t write_chrome_trace(FILE* pfile)
+		{
+			std::vector<long> marks;
+			file_sink sink(pfile);
+			lock_buffers();
+			size_t written = format_trace(sink, calibrate(), marks, true);
+			unlock_buffers();
+			return written;
+		}
+        
+		// The same, into the file at path, which it makes or empties. The
+		// trace is measured first and then formatted straight into a mapping
+		// of the file, so a long one is drained without a write call per
+		// record; where files cannot be mapped it goes through a FILE*.
+		// Returns 0, and drains nothing, if the file cannot be written.
+		static size_t write_chrome_trace(const char* path)
+		{
+			size_t written = 0;
+#if defined(_SIGSLOT_HAS_POSIX_THREADS) || defined(_SIGSLOT_HAS_WIN32_THREADS)
+			std::vector<long> marks;
+			memory_sink measure(NULL, 0);
+			double ns_per_tick = calibrate();
+			_shared_mapping mapping;
+            
+			lock_buffers();
+			format_trace(measure, ns_per_tick, marks, false);
+            
+			// vsnprintf() ends every piece with a NUL, so one byte spare.
+			if(mapping.create_file(path, measure.m_used + 1))
+			{
+				memory_sink sink(static_cast<char*>(mapping.address()), mapping.size());
+				written = format_trace(sink, ns_per_tick, marks, true);
+				mapping.close_file(sink.m_used);
+				unlock_buffers();
+				return written;
+			}
+            
+			unlock_buffers();
+#endif
+			FILE* pfile = fopen(path, "wb");
+            
+			if(pfile != NULL)
+			{
+				written = write_chrome_trace(pfile);
+				fclose(pfile);
+			}
+            
+			return written;
+		}
+        
+	private:
+		enum { capacity = SIGSLOT_TRACE_RECORDS };
+        
+		// One thread's records, from m_tail up to m_head. Only the owning
+		// thread moves m_head, and only write_chrome_trace() moves m_tail.
+		// m_thread is the owner's _os_thread_id(). A buffer whose thread
+		// has exited is handed to the next new one once its records have
+		// all been written, so that none are put down to the wrong thread.
+		struct buffer
+		{
+			buffer(unsigned long thread)
+            : m_head(0), m_tail(0), m_dropped(0), m_owned(1), m_thread(thread), m_pnext(NULL)
+			{
+				;
+			}
+            
+			void push(const record& r)
+			{
+				long head = m_head;
+                
+				if(head - _atomic_load_acquire(&m_tail) == long(capacity))
+				{
+					_atomic_add(&m_dropped, 1);
+					return;
+				}
+                
+				m_records[head & (capacity - 1)] = r;
+				_atomic_store_release(&m_head, head + 1);
+			}
+            
+			record m_records[capacity];
+			volatile long m_head;
+			volatile long m_tail;
+			volatile long m_dropped;
+			volatile long m_owned;
+			unsigned long m_thread;
+			buffer* m_pnext;
+		};
+        
+		// Gives the thread's buffer back as the thread exits.
+		struct thread_buffer
+		{
+			thread_buffer()
+            : m_pbuffer(NULL)
+			{
+				;
+			}
+            
+			~thread_buffer()
+			{
+				if(m_pbuffer != NULL)
+				{
+					_atomic_store(&m_pbuffer->m_owned, 0);
+				}
+			}
+            
+			buffer* m_pbuffer;
+		};
+        
+		struct clock_point
+		{
+			long long m_ticks;
+			std::chrono::steady_clock::time_point m_time;
+		};
+        
+		// Where format_trace() puts the text: a FILE*, or memory of
+		// m_size bytes. A memory_sink with no memory only counts.
+		struct file_sink
+		{
+			file_sink(FILE* pfile)
+            : m_pfile(pfile)
+			{
+				;
+			}
+            
+			void put(char c)
+			{
+				fputc(c, m_pfile);
+			}
+            
+			void print(const char* format, ...)
+			{
+				va_list args;
+				va_start(args, format);
+				vfprintf(m_pfile, format, args);
+				va_end(args);
+			}
+            
+			FILE* m_pfile;
+		};
+        
+		struct memory_sink
+		{
+			memory_sink(char* pbegin, size_t size)
+            : m_pbegin(pbegin), m_size(size), m_used(0)
+			{
+				;
+			}
+            
+			void put(char c)
+			{
+				if(m_pbegin != NULL && m_used < m_size)
+				{
+					m_pbegin[m_used] = c;
+				}
+                
+				++m_used;
+			}
+            
+			void print(const char* format, ...)
+			{
+				bool room = m_pbegin != NULL && m_used < m_size;
+				va_list args;
+				va_start(args, format);
+				int length = vsnprintf(room ? m_pbegin + m_used : NULL, room ? m_size - m_used : 0, format, args);
+				va_end(args);
+				m_used += length > 0 ? size_t(length) : 0;
+			}
+            
+			char* m_pbegin;
+			size_t m_size;
+			size_t m_used;
+		};
+        
+		// Formats every buffer from m_tail to its head, and moves m_tail
+		// there if drain is set. The first call on an empty marks records
+		// each buffer's head and dropped count, and later calls stick to
+		// them, so that a measured trace and the written one match. The
+		// caller holds lock_buffers(), which keeps the list of buffers still.
+		template<class sink_type>
+		static size_t format_trace(sink_type& sink, double ns_per_tick, std::vector<long>& marks, bool drain)
+		{
+			long long origin = clock_origin().m_ticks;
+			bool marked = !marks.empty();
+			size_t next_mark = 0;
+			size_t written = 0;
+            
+			sink.print("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+			sink.print("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"sigslot\"}}");
+            
+			for(buffer* pbuffer = buffers(); pbuffer != NULL; pbuffer = pbuffer->m_pnext)
+			{
+				if(!marked)
+				{
+					marks.push_back(_atomic_load_acquire(&pbuffer->m_head));
+					marks.push_back(_atomic_load(&pbuffer->m_dropped));
+				}
+                
+				long head = marks[next_mark++];
+				long dropped = marks[next_mark++];
+				long tail = pbuffer->m_tail;
+                
+				sink.print(",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%lu,"
+					"\"args\":{\"name\":\"thread %lu, %ld dropped\"}}", pbuffer->m_thread, pbuffer->m_thread, dropped);
+                
+				for(; tail != head; ++tail)
+				{
+					const record& r = pbuffer->m_records[tail & (capacity - 1)];
+					double ts = double(r.begin - origin) * ns_per_tick / 1000.0;
+					double dur = double(r.end - r.begin) * ns_per_tick / 1000.0;
+                    
+					sink.print(",\n{\"name\":");
+					write_string(sink, r.name ? r.name : "(unnamed)");
+					sink.print(",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%lu,"
+						"\"args\":{\"signal\":\"%p\",\"connection\":%lu}}", r.kind == slot_call ? "slot" : "lock wait",
+						ts, dur, pbuffer->m_thread, r.psignal, r.connection);
+					++written;
+				}
+                
+				if(drain)
+				{
+					_atomic_store_release(&pbuffer->m_tail, tail);
+				}
+			}
+            
+			sink.print("\n]}\n");
+			return written;
+		}
+        
+		template<class sink_type>
+		static void write_string(sink_type& sink, const char* text)
+		{
+			sink.put('"');
+            
+			for(; *text != '\0'; ++text)
+			{
+				if(*text == '"' || *text == '\\')
+				{
+					sink.put('\\');
+				}
+                
+				if((unsigned char)*text >= ' ')
+				{
+					sink.put(*text);
+				}
+			}
+            
+			sink.put('"');
+		}
+        
+		static long long ticks()
+		{
+#if (defined(__i386__) || defined(__x86_64__)) && defined(__GNUG__) && !defined(SIGSLOT_PURE_ISO)
+			return (long long)__builtin_ia32_rdtsc();
+#else
+			return (long long)std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+		}
+        
+		static clock_point now()
+		{
+			clock_point point;
+			point.m_time = std::chrono::steady_clock::now();
+			point.m_ticks = ticks();
+			return point;
+		}
+        
+		// Taken when the first buffer is made; the trace's times count
+		// from here.
+		static clock_point& clock_origin()
+		{
+			static clock_point s_origin = now();
+			return s_origin;
+		}
+        
+		static double calibrate()
+		{
+			clock_point origin = clock_origin();
+			clock_point point = now();
+			double ns = double(std::chrono::duration_cast<std::chrono::nanoseconds>(point.m_time - origin.m_time).count());
+			return point.m_ticks > origin.m_ticks && ns > 0 ? ns / double(point.m_ticks - origin.m_ticks) : 1.0;
+		}
+        
+		static unsigned long next_id()
+		{
+			static volatile long s_next = 0;
+			return (unsigned long)_atomic_add(&s_next, 1);
+		}
+        
+		static buffer*& buffers()
+		{
+			static buffer* s_pbuffers = NULL;
+			return s_pbuffers;
+		}
+        
+		static buffer& local_buffer()
+		{
+			static _SIGSLOT_THREAD_LOCAL thread_buffer s_local;
+            
+			if(s_local.m_pbuffer == NULL)
+			{
+				s_local.m_pbuffer = claim_buffer();
+			}
+            
+			return *s_local.m_pbuffer;
+		}
+        
+		static buffer* claim_buffer()
+		{
+			clock_origin();
+			lock_buffers();
+            
+			for(buffer* pbuffer = buffers(); pbuffer != NULL; pbuffer = pbuffer->m_pnext)
+			{
+				if(_atomic_load(&pbuffer->m_owned) == 0 && pbuffer->m_tail == _atomic_load_acquire(&pbuffer->m_head))
+				{
+					_atomic_store(&pbuffer->m_owned, 1);
+					_atomic_store(&pbuffer->m_dropped, 0);
+					pbuffer->m_thread = _os_thread_id();
+					unlock_buffers();
+					return pbuffer;
+				}
+			}
+            
+			buffer* pbuffer = new buffer(_os_thread_id());
+			pbuffer->m_pnext = buffers();
+			buffers() = pbuffer;
+			unlock_buffers();
+			return pbuffer;
+		}
+        
+		static void lock_buffers()
+		{
+#ifndef _SIGSLOT_SINGLE_THREADED
+			_stats_registry_lock();
+#endif
+		}
+        
+		static void unlock_buffers()
+		{
+#ifndef _SIGSLOT_SINGLE_THREADED
+			_stats_registry_unlock();
+#endif
+		}
+	};
+    
+	typedef SIGSLOT_INSTRUMENTATION_POLICY _instrumentation;
+    
+	// Fixed size block pools behind pool_allocator. Requests are rounded up
+	// to a multiple of granularity bytes and served from one free list per
+	// size class. Every thread keeps free lists of its own, so the common
+	// case takes no lock. A thread whose list grows past two slabs' worth of
+	// blocks (typically one that frees what another allocates) moves the
+	// surplus to a shared depot, an empty list is refilled from the depot
+	// before a new slab is carved, and a thread's blocks all go to the depot
+	// when it exits. Slabs are never handed back to the system.
+	class _block_pool
+	{
+	public:
+		enum { granularity = 16, max_block_size = 256, slab_size = 4096 };
+        
+		static void* allocate(size_t size)
+		{
+			if(size > max_block_size)
+			{
+				return ::operator new(size);
+			}
+            
+			size_t index = size_class(size);
+			block_lists& cache = local_cache();
+            
+			if(cache.m_head[index] == NULL)
+			{
+				refill(cache, index);
+			}
+            
+			block* pblock = cache.m_head[index];
+			cache.m_head[index] = pblock->m_next;
+			--cache.m_count[index];
+			return pblock;
+		}
+        
+		static void deallocate(void* p, size_t size)
+		{
+			if(p == NULL)
+			{
+				return;
+			}
+            
+			if(size > max_block_size)
+			{
+				::operator delete(p);
+				return;
+			}
+            
+			size_t index = size_class(size);
+			block_lists& cache = local_cache();
+			block* pblock = static_cast<block*>(p);
+			pblock->m_next = cache.m_head[index];
+			cache.m_head[index] = pblock;
+            
+			if(++cache.m_count[index] > 2 * blocks_per_slab(index))
+			{
+				give_back(cache, index, blocks_per_slab(index));
+			}
+		}
+        
+		// Called as a thread exits, with the cache local_cache() registered.
+		static void thread_exit(void* pcache)
+		{
+			block_lists& cache = *static_cast<block_lists*>(pcache);
+            
+			for(size_t index = 0; index < size_classes; ++index)
+			{
+				give_back(cache, index, 0);
+			}
+            
+			cache.m_registered = false;
+		}
+        
+	private:
+		enum { size_classes = max_block_size / granularity };
+        
+		struct block
+		{
+			block* m_next;
+		};
+        
+		struct block_lists
+		{
+			block* m_head[size_classes];
+			size_t m_count[size_classes];
+			bool m_registered;
+		};
+        
+		static size_t size_class(size_t size)
+		{
+			return size == 0 ? 0 : (size - 1) / granularity;
+		}
+        
+		static size_t blocks_per_slab(size_t index)
+		{
+			return slab_size / ((index + 1) * granularity);
+		}
+        
+		static block_lists& local_cache()
+		{
+			static _SIGSLOT_THREAD_LOCAL block_lists s_cache;
+#ifndef _SIGSLOT_SINGLE_THREADED
+			if(!s_cache.m_registered)
+			{
+				s_cache.m_registered = true;
+				_block_pool_at_thread_exit(&s_cache);
+			}
+#endif
+			return s_cache;
+		}
+        
+		static block_lists& depot()
+		{
+			static block_lists s_depot;
+			return s_depot;
+		}
+        
+		static void lock()
+		{
+#ifndef _SIGSLOT_SINGLE_THREADED
+			_block_pool_lock();
+#endif
+		}
+        
+		static void unlock()
+		{
+#ifndef _SIGSLOT_SINGLE_THREADED
+			_block_pool_unlock();
+#endif
+		}
+        
+		// Moves all but the first keep blocks of one of the thread's lists
+		// to the depot.
+		static void give_back(block_lists& cache, size_t index, size_t keep)
+		{
+			if(cache.m_count[index] <= keep)
+			{
+				return;
+			}
+            
+			block** pcut = &cache.m_head[index];
+            
+			for(size_t i = 0; i < keep; ++i)
+			{
+				pcut = &(*pcut)->m_next;
+			}
+            
+			block* pfirst = *pcut;
+			block* plast = pfirst;
+            
+			while(plast->m_next != NULL)
+			{
+				plast = plast->m_next;
+			}
+            
+			*pcut = NULL;
+            
+			size_t count = cache.m_count[index] - keep;
+			cache.m_count[index] = keep;
+            
+			lock();
+			block_lists& shared = depot();
+			plast->m_next = shared.m_head[index];
+			shared.m_head[index] = pfirst;
+			shared.m_count[index] += count;
+			unlock();
+		}
+        
+		static void refill(block_lists& cache, size_t index)
+		{
+			lock();
+			block_lists& shared = depot();
+			cache.m_head[index] = shared.m_head[index];
+			cache.m_count[index] = shared.m_count[index];
+			shared.m_head[index] = NULL;
+			shared.m_count[index] = 0;
+			unlock();
+            
+			if(cache.m_head[index] != NULL)
+			{
+				return;
+			}
+            
+			size_t block_size = (index + 1) * granularity;
+			size_t count = blocks_per_slab(index);
+			char* pslab = static_cast<char*>(::operator new(slab_size));
+            
+			for(size_t i = count; i != 0; --i)
+			{
+				block* pblock = reinterpret_cast<block*>(pslab + (i - 1) * block_size);
+				pblock->m_next = cache.m_head[index];
+				cache.m_head[index] = pblock;
+			}
+            
+			cache.m_count[index] = count;
+		}
+	};
+    
+#ifndef _SIGSLOT_SINGLE_THREADED
+	inline void _block_pool_thread_exit(void* pcache)
+	{
+		_block_pool::thread_exit(pcache);
+	}
+#endif
+    
+	// A standard allocator over _block_pool, for use as SIGSLOT_ALLOCATOR.
+	// Connection objects, list nodes and set nodes whose sizes fall in the
+	// same size class share one free list.
+	template<class T>
+	class pool_allocator
+	{
+	public:
+		typedef T value_type;
+		typedef T* pointer;
+		typedef const T* const_pointer;
+		typedef T& reference;
+		typedef const T& const_reference;
+		typedef size_t size_type;
+		typedef ptrdiff_t difference_type;
+        
+		template<class U>
+		struct rebind
+		{
+			typedef pool_allocator<U> other;
+		};
+        
+		pool_allocator()
+		{
+			;
+		}
+        
+		pool_allocator(const pool_allocator&)
+		{
+			;
+		}
+        
+		template<class U>
+		pool_allocator(const pool_allocator<U>&)
+		{
+			;
+		}
+        
+		pointer address(reference x) const
+		{
+			return &x;
+		}
+        
+		const_pointer address(const_reference x) const
+		{
+			return &x;
+		}
+        
+		pointer allocate(size_type n, const void* = 0)
+		{
+			return static_cast<pointer>(_block_pool::allocate(n * sizeof(T)));
+		}
+        
+		void deallocate(pointer p, size_type n)
+		{
+			_block_pool::deallocate(p, n * sizeof(T));
+		}
+        
+		size_type max_size() const
+		{
+			return size_type(-1) / sizeof(T);
+		}
+        
+		void construct(pointer p, const T& val)
+		{
+			new(static_cast<void*>(p)) T(val);
+		}
+        
+		void destroy(pointer p)
+		{
+			p->~T();
+		}
+	};
+    
+	template<class T, class U>
+	inline bool operator==(const pool_allocator<T>&, const pool_allocator<U>&)
+	{
+		return true;
+	}
+    
+	template<class T, class U>
+	inline bool operator!=(const pool_allocator<T>&, const pool_allocator<U>&)
+	{
+		return false;
+	}
+    
+	// Connection objects are created with new and destroyed through their
+	// virtual destructor, which hands the dynamic size to operator delete,
+	// so both can be routed through SIGSLOT_ALLOCATOR here. The placement
+	// forms keep clone_at() working alongside the class specific operators.
+	class _connection_allocation
+	{
+	public:
+		static void* operator new(size_t size)
+		{
+			return SIGSLOT_ALLOCATOR<char>().allocate(size);
+		}
+        
+		static void operator delete(void* p, size_t size)
+		{
+			SIGSLOT_ALLOCATOR<char>().deallocate(static_cast<char*>(p), size);
+		}
+        
+		static void* operator new(size_t, void* pmem)
+		{
+			return pmem;
+		}
+        
+		static void operator delete(void*, void*)
+		{
+			;
+		}
+	};
+    
+	// The part of a connection its signal uses to find the connection's
+	// entry in the signal's table of handles, and to record its calls.
+	class _connection_node : public _connection_allocation, public _instrumentation::connection_stats
+	{
+	public:
+		_connection_node()
+        : m_slot(0)
+		{
+			;
+		}
+        
+		size_t m_slot;
+	};
+    
+	template<class mt_policy>
+	class has_slots;
+    
+	// Storage policies decide how a signal keeps its connections. Each one
+	// provides a container template for a given connection base type; the
+	// container owns the connection objects it holds.
+	//
+	// Connections are inserted before an iterator, which the signal picks
+	// to keep them in order of priority. Every insert returns a position,
+	// which erase_at() and at() take to reach that connection again. A list position is its iterator; the
+	// other containers move connections about, so their position is the
+	// connection's slot number and finding it takes a search.
+	//
+	// Containers are walked by emit() through their emit_iterator. While
+	// any emit is walking a container, erasing a connection destroys it but
+	// leaves its place empty, and the container is compacted once the
+	// outermost emit has finished. So the slots an emit calls may
+	// disconnect any connection, their own or one the emit has still to
+	// reach, without upsetting the walk. The list fills an empty place with
+	// the connection type's tombstone, whose slot does nothing, so that its
+	// emit_iterator need not check for one.
+	//
+	// With shared_emit set, several emits may walk the container at once
+	// under the shared side of a reader/writer lock. Nothing can change it
+	// while they do, so they are not counted.
+    
+	template<class conn_type, bool shared_emit = false>
+	class _connection_list
+	{
+	private:
+		typedef std::list<conn_type *, SIGSLOT_ALLOCATOR<conn_type *> > list_type;
+        
+		template<class list_iterator>
+		class basic_iterator
+		{
+		public:
+			basic_iterator(list_iterator it, list_iterator itEnd)
+            : m_it(it), m_end(itEnd)
+			{
+				skip_empty();
+			}
+            
+			// Lets an iterator convert to a const_iterator.
+			template<class other_iterator>
+			basic_iterator(const basic_iterator<other_iterator>& it)
+            : m_it(it.base()), m_end(it.base_end())
+			{
+				;
+			}
+            
+			conn_type* operator*() const
+			{
+				return *m_it;
+			}
+            
+			basic_iterator& operator++()
+			{
+				++m_it;
+				skip_empty();
+				return *this;
+			}
+            
+			bool operator==(const basic_iterator& it) const
+			{
+				return m_it == it.m_it;
+			}
+            
+			bool operator!=(const basic_iterator& it) const
+			{
+				return m_it != it.m_it;
+			}
+            
+			list_iterator base() const
+			{
+				return m_it;
+			}
+            
+			list_iterator base_end() const
+			{
+				return m_end;
+			}
+            
+		private:
+			void skip_empty()
+			{
+				while(m_it != m_end && *m_it == conn_type::tombstone())
+				{
+					++m_it;
+				}
+			}
+            
+			list_iterator m_it;
+			list_iterator m_end;
+		};
+        
+	public:
+		typedef basic_iterator<typename list_type::iterator> iterator;
+		typedef basic_iterator<typename list_type::const_iterator> const_iterator;
+		typedef typename list_type::iterator position;
+        
+		class emit_iterator
+		{
+		public:
+			emit_iterator(_connection_list& conns)
+            : m_conns(conns), m_next(conns.m_list.begin()), m_end(conns.m_list.end()), m_current(NULL)
+			{
+				if(!shared_emit)
+				{
+					++m_conns.m_emitting;
+				}
+			}
+            
+			~emit_iterator()
+			{
+				if(!shared_emit && --m_conns.m_emitting == 0 && m_conns.m_tombstones != 0)
+				{
+					m_conns.compact();
+				}
+			}
+            
+			bool next()
+			{
+				if(m_next == m_end)
+				{
+					return false;
+				}
+                
+				m_current = *m_next;
+				++m_next;
+				return true;
+			}
+            
+			conn_type* operator*() const
+			{
+				return m_current;
+			}
+            
+		private:
+			_connection_list& m_conns;
+			typename list_type::const_iterator m_next;
+			typename list_type::const_iterator m_end;
+			conn_type* m_current;
+		};
+        
+		_connection_list()
+        : m_tombstones(0), m_emitting(0)
+		{
+			;
+		}
+        
+		~_connection_list()
+		{
+			clear();
+		}
+        
+		iterator begin()
+		{
+			return iterator(m_list.begin(), m_list.end());
+		}
+        
+		iterator end()
+		{
+			return iterator(m_list.end(), m_list.end());
+		}
+        
+		const_iterator begin() const
+		{
+			return const_iterator(m_list.begin(), m_list.end());
+		}
+        
+		const_iterator end() const
+		{
+			return const_iterator(m_list.end(), m_list.end());
+		}
+        
+		// Takes ownership of a heap allocated connection.
+		position insert(iterator before, conn_type* pconn)
+		{
+			return m_list.insert(before.base(), pconn);
+		}
+        
+		template<class conn_impl>
+		position insert_copy(iterator before, const conn_impl& conn)
+		{
+			return m_list.insert(before.base(), new conn_impl(conn));
+		}
+        
+		conn_type* at(position pos) const
+		{
+			return *pos;
+		}
+        
+		iterator erase(iterator it)
+		{
+			return iterator(erase_node(it.base()), m_list.end());
+		}
+        
+		void erase_at(position pos)
+		{
+			erase_node(pos);
+		}
+        
+		// Points a connection at the object its receiver was moved to.
+		template<class dest_type>
+		void retarget(position pos, dest_type* pnewdest)
+		{
+			(*pos)->retarget(pnewdest);
+		}
+        
+		// A list can take an insert anywhere, even during an emit.
+		bool can_insert_inside() const
+		{
+			return true;
+		}
+        
+		// For a batch of changes; see _cow_connections. A list has nothing
+		// to reserve and nothing to hold back.
+		void reserve(size_t)
+		{
+			;
+		}
+        
+		void begin_changes()
+		{
+			;
+		}
+        
+		void end_changes()
+		{
+			;
+		}
+        
+		// Erases every connection that pred picks, in one pass.
+		template<class pred_type>
+		void erase_if(pred_type pred)
+		{
+			typename list_type::iterator it = m_list.begin();
+			typename list_type::iterator itEnd = m_list.end();
+            
+			while(it != itEnd)
+			{
+				if(*it != conn_type::tombstone() && pred(*it))
+				{
+					it = erase_node(it);
+				}
+				else
+				{
+					++it;
+				}
+			}
+		}
+        
+		template<class order_type>
+		void sort(order_type before)
+		{
+			m_list.sort(before);
+		}
+        
+		void clear()
+		{
+			typename list_type::iterator it = m_list.begin();
+			typename list_type::iterator itEnd = m_list.end();
+            
+			while(it != itEnd)
+			{
+				if(*it != conn_type::tombstone())
+				{
+					delete *it;
+					*it = conn_type::tombstone();
+				}
+                
+				++it;
+			}
+            
+			if(!shared_emit && m_emitting != 0)
+			{
+				m_tombstones = m_list.size();
+			}
+			else
+			{
+				m_list.clear();
+				m_tombstones = 0;
+			}
+		}
+        
+	private:
+		_connection_list(const _connection_list&);
+		_connection_list& operator=(const _connection_list&);
+        
+		typename list_type::iterator erase_node(typename list_type::iterator it)
+		{
+			delete *it;
+            
+			if(!shared_emit && m_emitting != 0)
+			{
+				*it = conn_type::tombstone();
+				++m_tombstones;
+				return ++it;
+			}
+            
+			return m_list.erase(it);
+		}
+        
+		// Called from the end of emit(). The test is left to remove_if() so
+		// that emit() does not hold the tombstone's initialisation inline,
+		// which costs it registers in its loop.
+		void compact()
+		{
+			m_list.remove_if(&is_tombstone);
+			m_tombstones = 0;
+		}
+        
+		static bool is_tombstone(conn_type* pconn)
+		{
+			return pconn == conn_type::tombstone();
+		}
+        
+		list_type m_list;
+		size_t m_tombstones;
+		int m_emitting;
+	};
+    
+	// Connections are constructed in place in one contiguous array of
+	// fixed size cells, so emit() walks memory linearly instead of chasing
+	// a list node and then a separately allocated connection per slot.
+	// Erased cells are only marked empty, and the array is compacted once
+	// the outermost emit has finished, or outside an emit once half of it
+	// is empty; an erase does not move the cells after it, and the cells
+	// stay put under the emit loop. For the same reason, a connection
+	// inserted during an emit is appended, whatever iterator it is inserted
+	// before, and can_insert_inside() says so; the signal puts it in order
+	// with sort() once the emit has finished. m_index maps each slot to its
+	// cell and follows every move, so a position is found without a search.
+	//
+	// With shared_emit set, several emits may walk the array at once under
+	// the shared side of a reader/writer lock. Nothing can change the array
+	// while they do, so they are not counted.
+	template<class conn_type, bool shared_emit = false>
+	class _connection_vector
+	{
+	private:
+		struct cell
+		{
+			conn_type* m_pconn;
+			union
+			{
+				char m_storage[SIGSLOT_INLINE_CONNECTION_SIZE];
+				void* m_align_pointer;
+				double m_align_double;
+			};
+		};
+        
+		template<class vector_type>
+		class basic_iterator
+		{
+		public:
+			basic_iterator(vector_type* pvector, size_t index)
+            : m_pvector(pvector), m_index(index)
+			{
+				skip_empty();
+			}
+            
+			// Lets an iterator convert to a const_iterator.
+			template<class other_type>
+			basic_iterator(const basic_iterator<other_type>& it)
+            : m_pvector(it.pvector()), m_index(it.index())
+			{
+				;
+			}
+            
+			conn_type* operator*() const
+			{
+				return m_pvector->m_cells[m_index].m_pconn;
+			}
+            
+			basic_iterator& operator++()
+			{
+				++m_index;
+				skip_empty();
+				return *this;
+			}
+            
+			bool operator==(const basic_iterator& it) const
+			{
+				return m_index == it.m_index;
+			}
+            
+			bool operator!=(const basic_iterator& it) const
+			{
+				return m_index != it.m_index;
+			}
+            
+			vector_type* pvector() const
+			{
+				return m_pvector;
+			}
+            
+			size_t index() const
+			{
+				return m_index;
+			}
+            
+		private:
+			void skip_empty()
+			{
+				while(m_index < m_pvector->m_size && m_pvector->m_cells[m_index].m_pconn == NULL)
+				{
+					++m_index;
+				}
+			}
+            
+			vector_type* m_pvector;
+			size_t m_index;
+		};
+        
+	public:
+		typedef basic_iterator<_connection_vector> iterator;
+		typedef basic_iterator<const _connection_vector> const_iterator;
+		typedef size_t position;
+        
+		class emit_iterator
+		{
+		public:
+			emit_iterator(_connection_vector& conns)
+            : m_conns(conns), m_index(0), m_current(NULL)
+			{
+				if(!shared_emit)
+				{
+					++m_conns.m_emitting;
+				}
+			}
+            
+			~emit_iterator()
+			{
+				if(!shared_emit && --m_conns.m_emitting == 0 && m_conns.m_empty_cells != 0)
+				{
+					m_conns.compact();
+				}
+			}
+            
+			bool next()
+			{
+				// A slot may connect to this signal and so reallocate the
+				// cells; load them afresh on every step.
+				cell* cells = m_conns.m_cells;
+				size_t size = m_conns.m_size;
+				size_t index = m_index;
+                
+				while(index < size)
+				{
+					if(cells[index].m_pconn != NULL)
+					{
+						m_current = cells[index].m_pconn;
+						m_index = index + 1;
+						return true;
+					}
+                    
+					++index;
+				}
+                
+				m_index = index;
+				return false;
+			}
+            
+			conn_type* operator*() const
+			{
+				return m_current;
+			}
+            
+		private:
+			_connection_vector& m_conns;
+			size_t m_index;
+			conn_type* m_current;
+		};
+        
+		_connection_vector()
+        : m_cells(NULL), m_size(0), m_capacity(0), m_empty_cells(0), m_emitting(0)
+		{
+			;
+		}
+        
+		~_connection_vector()
+		{
+			clear();
+			::operator delete(m_cells);
+		}
+        
+		iterator begin()
+		{
+			return iterator(this, 0);
+		}
+        
+		iterator end()
+		{
+			return iterator(this, m_size);
+		}
+        
+		const_iterator begin() const
+		{
+			return const_iterator(this, 0);
+		}
+        
+		const_iterator end() const
+		{
+			return const_iterator(this, m_size);
+		}
+        
+		// Takes ownership of a heap allocated connection. The connection is
+		// copied into the array and the heap copy is released.
+		position insert(iterator before, conn_type* pconn)
+		{
+			size_t index = insert_cell(before.index());
+			m_cells[index].m_pconn = pconn->clone_at(m_cells[index].m_storage);
+			delete pconn;
+			return placed(index);
+		}
+        
+		template<class conn_impl>
+		position insert_copy(iterator before, const conn_impl& conn)
+		{
+			// If this fails to compile, the connection type does not fit in a
+			// cell; raise SIGSLOT_INLINE_CONNECTION_SIZE.
+			(void)sizeof(char[sizeof(conn_impl) <= SIGSLOT_INLINE_CONNECTION_SIZE ? 1 : -1]);
+            
+			size_t index = insert_cell(before.index());
+			m_cells[index].m_pconn = new(m_cells[index].m_storage) conn_impl(conn);
+			return placed(index);
+		}
+        
+		conn_type* at(position pos) const
+		{
+			return m_cells[m_index[pos]].m_pconn;
+		}
+        
+		void erase_at(position pos)
+		{
+			erase(iterator(this, m_index[pos]));
+		}
+        
+		template<class dest_type>
+		void retarget(position pos, dest_type* pnewdest)
+		{
+			at(pos)->retarget(pnewdest);
+		}
+        
+		bool can_insert_inside() const
+		{
+			return shared_emit || m_emitting == 0;
+		}
+        
+		// Makes room for count more connections, still at least doubling
+		// the array so that many small batches stay amortised.
+		void reserve(size_t count)
+		{
+			if(m_size + count > m_capacity)
+			{
+				grow(std::max(m_size + count, m_capacity * 2));
+			}
+		}
+        
+		void begin_changes()
+		{
+			;
+		}
+        
+		void end_changes()
+		{
+			;
+		}
+        
+		// Erases every connection that pred picks, and closes the gaps in
+		// one pass rather than once per connection; during an emit the
+		// cells are left empty for the emit to compact.
+		template<class pred_type>
+		void erase_if(pred_type pred)
+		{
+			for(size_t i = 0; i < m_size; ++i)
+			{
+				if(m_cells[i].m_pconn != NULL && pred(m_cells[i].m_pconn))
+				{
+					m_cells[i].m_pconn->~conn_type();
+					m_cells[i].m_pconn = NULL;
+					++m_empty_cells;
+				}
+			}
+            
+			if(m_emitting == 0 && m_empty_cells != 0)
+			{
+				compact();
+			}
+		}
+        
+		// A stable insertion sort, since all but the connections appended
+		// during an emit are in order already. Not during an emit.
+		template<class order_type>
+		void sort(order_type before)
+		{
+			if(m_empty_cells != 0)
+			{
+				compact();
+			}
+            
+			cell held;
+            
+			for(size_t i = 1; i < m_size; ++i)
+			{
+				size_t j = i;
+                
+				while(j > 0 && before(m_cells[i].m_pconn, m_cells[j - 1].m_pconn))
+				{
+					--j;
+				}
+                
+				if(j != i)
+				{
+					move_cell(m_cells[i], held);
+                    
+					for(size_t k = i; k > j; --k)
+					{
+						move_cell(m_cells[k - 1], m_cells[k]);
+					}
+                    
+					move_cell(held, m_cells[j]);
+                    
+					for(size_t k = j; k <= i; ++k)
+					{
+						placed(k);
+					}
+				}
+			}
+		}
+        
+		iterator erase(iterator it)
+		{
+			size_t index = it.index();
+            
+			m_cells[index].m_pconn->~conn_type();
+			m_cells[index].m_pconn = NULL;
+			++m_empty_cells;
+			iterator next(this, index + 1);
+            
+			if(m_emitting == 0 && m_empty_cells > m_size / 2)
+			{
+				if(next == end())
+				{
+					compact();
+					return end();
+				}
+                
+				size_t slot = (*next)->m_slot;
+				compact();
+				return iterator(this, m_index[slot]);
+			}
+            
+			return next;
+		}
+        
+		void clear()
+		{
+			for(size_t i = 0; i < m_size; ++i)
+			{
+				if(m_cells[i].m_pconn != NULL)
+				{
+					m_cells[i].m_pconn->~conn_type();
+					m_cells[i].m_pconn = NULL;
+				}
+			}
+            
+			if(m_emitting != 0)
+			{
+				m_empty_cells = m_size;
+			}
+			else
+			{
+				m_size = 0;
+				m_empty_cells = 0;
+			}
+		}
+        
+	private:
+		_connection_vector(const _connection_vector&);
+		_connection_vector& operator=(const _connection_vector&);
+        
+		// Records that the connection in the cell at index is there, and
+		// returns its position.
+		position placed(size_t index)
+		{
+			size_t slot = m_cells[index].m_pconn->m_slot;
+            
+			if(slot >= m_index.size())
+			{
+				m_index.resize(slot + 1);
+			}
+            
+			m_index[slot] = index;
+			return slot;
+		}
+        
+		static void move_cell(cell& from, cell& to)
+		{
+			if(from.m_pconn != NULL)
+			{
+				to.m_pconn = from.m_pconn->clone_at(to.m_storage);
+				from.m_pconn->~conn_type();
+				from.m_pconn = NULL;
+			}
+			else
+			{
+				to.m_pconn = NULL;
+			}
+		}
+        
+		cell& append()
+		{
+			if(m_size == m_capacity)
+			{
+				grow(m_capacity ? m_capacity * 2 : 4);
+			}
+            
+			return m_cells[m_size++];
+		}
+        
+		void grow(size_t capacity)
+		{
+			cell* cells = static_cast<cell*>(::operator new(capacity * sizeof(cell)));
+            
+			for(size_t i = 0; i < m_size; ++i)
+			{
+				move_cell(m_cells[i], cells[i]);
+			}
+            
+			::operator delete(m_cells);
+			m_cells = cells;
+			m_capacity = capacity;
+		}
+        
+		// Opens an empty cell at index by moving the cells from there on up
+		// by one, or at the end during an emit, and returns its index.
+		size_t insert_cell(size_t index)
+		{
+			if(!can_insert_inside())
+			{
+				append();
+				return m_size - 1;
+			}
+            
+			append().m_pconn = NULL;
+            
+			for(size_t i = m_size - 1; i > index; --i)
+			{
+				move_cell(m_cells[i - 1], m_cells[i]);
+                
+				if(m_cells[i].m_pconn != NULL)
+				{
+					placed(i);
+				}
+			}
+            
+			return index;
+		}
+        
+		void compact()
+		{
+			size_t used = 0;
+            
+			for(size_t i = 0; i < m_size; ++i)
+			{
+				if(m_cells[i].m_pconn != NULL)
+				{
+					if(i != used)
+					{
+						move_cell(m_cells[i], m_cells[used]);
+						placed(used);
+					}
+                    
+					++used;
+				}
+			}
+            
+			m_size = used;
+			m_empty_cells = 0;
+		}
+        
+		cell* m_cells;
+		size_t m_size;
+		size_t m_capacity;
+		size_t m_empty_cells;
+		int m_emitting;
+		std::vector<size_t> m_index;
+	};
+    
+	class list_storage
+	{
+	public:
+		template<class conn_type>
+		struct container
+		{
+			typedef _connection_list<conn_type> type;
+		};
+	};
+    
+	class vector_storage
+	{
+	public:
+		template<class conn_type>
+		struct container
+		{
+			typedef _connection_vector<conn_type> type;
+		};
+	};
+    
+	// Maps a signal's policies to the container its connections live in.
+	template<class conn_type, class mt_policy, class storage_policy>
+	struct _connections_for
+	{
+		typedef typename storage_policy::template container<conn_type>::type type;
+	};
+    
+#ifndef _SIGSLOT_SINGLE_THREADED
+	// Connection storage for multi_threaded_cow.
+	//
+	// Writers, which always hold the signal's mutex, edit a private array of
+	// connections and then publish a copy of it as an immutable snapshot
+	// through an atomic pointer. emit() registers itself as a reader, loads
+	// the current snapshot and walks it without locking.
+	//
+	// Readers register in one of two counters, selected by the parity of
+	// m_epoch. A snapshot or connection that is no longer published is
+	// retired, and freed once no reader can still be looking at it: either
+	// both counters are seen at zero, or the writer waits for a grace period
+	// by flipping the epoch and draining the old counter, twice. Readers that
+	// start meanwhile register against the new epoch, so the wait is bounded
+	// by the emits already in progress.
+	//
+	// Adding a connection never waits. Removing one waits for a grace period
+	// before returning, so that once disconnect() or the destruction of a
+	// has_slots object returns, no emit can still call into that slot. A
+	// slot must therefore not disconnect from the signal that is calling
+	// it, which the policies with an exclusive emit lock do allow.
+	//
+	// The storage_policy of the signal is not used: connections are
+	// allocated individually, since a snapshot may outlive any contiguous
+	// array they could be moved around in.
+	template<class conn_type>
+	class _cow_connections
+	{
+	public:
+		typedef std::vector<conn_type *> list_type;
+		typedef typename list_type::const_iterator const_iterator;
+		typedef typename list_type::iterator iterator;
+		typedef size_t position;
+        
+		class emit_iterator
+		{
+		public:
+			emit_iterator(_cow_connections& conns)
+            : m_conns(conns), m_index(0), m_current(NULL)
+			{
+				m_reader = conns.enter_reader();
+				m_psnapshot = _atomic_load(&conns.m_psnapshot);
+			}
+            
+			~emit_iterator()
+			{
+				m_conns.leave_reader(m_reader);
+			}
+            
+			bool next()
+			{
+				if(m_psnapshot == NULL || m_index == m_psnapshot->size())
+				{
+					return false;
+				}
+                
+				m_current = (*m_psnapshot)[m_index++];
+				return true;
+			}
+            
+			conn_type* operator*() const
+			{
+				return m_current;
+			}
+            
+		private:
+			_cow_connections& m_conns;
+			const list_type* m_psnapshot;
+			size_t m_index;
+			conn_type* m_current;
+			long m_reader;
+		};
+        
+		_cow_connections()
+        : m_psnapshot(NULL), m_epoch(0), m_changing(0)
+		{
+			m_readers[0] = 0;
+			m_readers[1] = 0;
+		}
+        
+		~_cow_connections()
+		{
+			clear();
+			delete m_psnapshot;
+		}
+        
+		iterator begin()
+		{
+			return m_conns.begin();
+		}
+        
+		iterator end()
+		{
+			return m_conns.end();
+		}
+        
+		const_iterator begin() const
+		{
+			return m_conns.begin();
+		}
+        
+		const_iterator end() const
+		{
+			return m_conns.end();
+		}
+        
+		// Takes ownership of a heap allocated connection.
+		position insert(iterator before, conn_type* pconn)
+		{
+			iterator it = m_conns.insert(before, pconn);
+			reindex(it - m_conns.begin());
+            
+			if(m_changing == 0)
+			{
+				publish();
+				reclaim_if_idle();
+			}
+            
+			return pconn->m_slot;
+		}
+        
+		template<class conn_impl>
+		position insert_copy(iterator before, const conn_impl& conn)
+		{
+			return insert(before, new conn_impl(conn));
+		}
+        
+		conn_type* at(position pos) const
+		{
+			return m_conns[m_index[pos]];
+		}
+        
+		void erase_at(position pos)
+		{
+			erase(m_conns.begin() + m_index[pos]);
+		}
+        
+		// A published connection cannot change under the emits reading it,
+		// so a copy aimed at the new receiver takes its place.
+		template<class dest_type>
+		void retarget(position pos, dest_type* pnewdest)
+		{
+			iterator it = m_conns.begin() + m_index[pos];
+			conn_type* pconn = static_cast<conn_type*>((*it)->duplicate(pnewdest));
+			pconn->m_slot = pos;
+			m_retired_conns.push_back(*it);
+			*it = pconn;
+			publish();
+			reclaim();
+		}
+        
+		// Emits walk a snapshot, so the array can take an insert anywhere.
+		bool can_insert_inside() const
+		{
+			return true;
+		}
+        
+		template<class order_type>
+		void sort(order_type before)
+		{
+			std::stable_sort(m_conns.begin(), m_conns.end(), before);
+			reindex(0);
+			publish();
+		}
+        
+		void reserve(size_t count)
+		{
+			if(m_conns.size() + count > m_conns.capacity())
+			{
+				m_conns.reserve(std::max(m_conns.size() + count, m_conns.capacity() * 2));
+			}
+		}
+        
+		// Inserts between these are published together at the end, so a
+		// batch of connects copies the array once rather than once each.
+		void begin_changes()
+		{
+			++m_changing;
+		}
+        
+		void end_changes()
+		{
+			if(--m_changing == 0)
+			{
+				publish();
+				reclaim_if_idle();
+			}
+		}
+        
+		// Erases every connection that pred picks and publishes once; like
+		// erase(), it returns when no emit can still call them.
+		template<class pred_type>
+		void erase_if(pred_type pred)
+		{
+			iterator kept = m_conns.begin();
+            
+			for(iterator it = m_conns.begin(); it != m_conns.end(); ++it)
+			{
+				if(pred(*it))
+				{
+					m_retired_conns.push_back(*it);
+				}
+				else
+				{
+					*kept++ = *it;
+				}
+			}
+            
+			if(kept == m_conns.end())
+			{
+				return;
+			}
+            
+			m_conns.erase(kept, m_conns.end());
+			reindex(0);
+			publish();
+			reclaim();
+		}
+        
+		iterator erase(iterator it)
+		{
+			m_retired_conns.push_back(*it);
+			it = m_conns.erase(it);
+			reindex(it - m_conns.begin());
+			publish();
+			reclaim();
+			return it;
+		}
+        
+		void clear()
+		{
+			if(m_conns.empty())
+			{
+				return;
+			}
+            
+			m_retired_conns.insert(m_retired_conns.end(), m_conns.begin(), m_conns.end());
+			m_conns.clear();
+			publish();
+			reclaim();
+		}
+        
+	private:
+		_cow_connections(const _cow_connections&);
+		_cow_connections& operator=(const _cow_connections&);
+        
+		// Brings m_index up to date for the connections from index on, whose
+		// places in the array, and in the next snapshot, have moved. Every
+		// change that moves them already copies the array from there on.
+		void reindex(size_t index)
+		{
+			for(; index < m_conns.size(); ++index)
+			{
+				size_t slot = m_conns[index]->m_slot;
+                
+				if(slot >= m_index.size())
+				{
+					m_index.resize(slot + 1);
+				}
+                
+				m_index[slot] = index;
+			}
+		}
+        
+		// Past this many retired snapshots, a writer that finds readers
+		// active waits for them rather than let garbage pile up.
+		enum { max_retired = 16 };
+        
+		long enter_reader()
+		{
+			long reader = _atomic_load(&m_epoch) & 1;
+			_atomic_add(&m_readers[reader], 1);
+			return reader;
+		}
+        
+		void leave_reader(long reader)
+		{
+			_atomic_add(&m_readers[reader], -1);
+		}
+        
+		bool idle()
+		{
+			return _atomic_load(&m_readers[0]) == 0 && _atomic_load(&m_readers[1]) == 0;
+		}
+        
+		void wait_for_readers()
+		{
+			for(int pass = 0; pass < 2; ++pass)
+			{
+				long old_reader = _atomic_load(&m_epoch) & 1;
+				_atomic_store(&m_epoch, old_reader ^ 1);
+                
+				while(_atomic_load(&m_readers[old_reader]) != 0)
+				{
+					_thread_yield();
+				}
+			}
+		}
+        
+		void publish()
+		{
+			list_type* psnapshot = m_conns.empty() ? NULL : new list_type(m_conns);
+			list_type* pold = m_psnapshot;
+			_atomic_store(&m_psnapshot, psnapshot);
+            
+			if(pold != NULL)
+			{
+				m_retired_snapshots.push_back(pold);
+			}
+		}
+        
+		void reclaim_if_idle()
+		{
+			if(m_retired_snapshots.empty() && m_retired_conns.empty())
+			{
+				return;
+			}
+            
+			if(idle())
+			{
+				free_retired();
+			}
+			else if(m_retired_snapshots.size() >= max_retired)
+			{
+				reclaim();
+			}
+		}
+        
+		void reclaim()
+		{
+			if(!idle())
+			{
+				wait_for_readers();
+			}
+            
+			free_retired();
+		}
+        
+		void free_retired()
+		{
+			for(size_t i = 0; i < m_retired_snapshots.size(); ++i)
+			{
+				delete m_retired_snapshots[i];
+			}
+            
+			for(size_t i = 0; i < m_retired_conns.size(); ++i)
+			{
+				delete m_retired_conns[i];
+			}
+            
+			m_retired_snapshots.clear();
+			m_retired_conns.clear();
+		}
+        
+		list_type m_conns;
+		list_type* volatile m_psnapshot;
+		volatile long m_epoch;
+		volatile long m_readers[2];
+		std::vector<list_type *> m_retired_snapshots;
+		list_type m_retired_conns;
+		std::vector<size_t> m_index;
+		int m_changing;
+	};
+    
+	template<class conn_type, class storage_policy>
+	struct _connections_for<conn_type, multi_threaded_cow, storage_policy>
+	{
+		typedef _cow_connections<conn_type> type;
+	};
+    
+	template<class conn_type>
+	struct _connections_for<conn_type, multi_threaded_rw, list_storage>
+	{
+		typedef _connection_list<conn_type, true> type;
+	};
+    
+	template<class conn_type>
+	struct _connections_for<conn_type, multi_threaded_rw, vector_storage>
+	{
+		typedef _connection_vector<conn_type, true> type;
+	};
+#endif // _SIGSLOT_SINGLE_THREADED
+    
+    
+	template<size_t... indices>
+	struct _index_list
+	{
+	};
+    
+	template<size_t count, size_t... indices>
+	struct _make_index_list : _make_index_list<count - 1, count - 1, indices...>
+	{
+	};
+    
+	template<size_t... indices>
+	struct _make_index_list<0, indices...>
+	{
+		typedef _index_list<indices...> type;
+	};
+    
+	// How emit() and the connection thunks take each signal argument.
+	// Scalars go by value; anything else goes by const reference, so a
+	// large argument is only copied where a slot itself takes it by value.
+	// Reference arguments are passed through unchanged.
+	template<class arg_type>
+	struct _param
+	{
+		typedef typename std::conditional<std::is_scalar<arg_type>::value, arg_type, const arg_type&>::type type;
+	};
+    
+	template<class arg_type>
+	struct _param<arg_type&>
+	{
+		typedef arg_type& type;
+	};
+    
+	template<class... arg_types>
+	class _routing;
+    
+	// A connection carries a pointer to the thunk that calls its slot, so
+	// emit() makes one indirect call per slot and no virtual call.
+	template<class mt_policy, class... arg_types>
+	class _connection_base : public _connection_node
+	{
+	public:
+		typedef void (*emit_thunk)(_connection_base*, typename _param<arg_types>::type...);
+		typedef std::tuple<typename std::decay<arg_types>::type...> event_type;
+        
+		_connection_base(emit_thunk pemit)
+        : m_pemit(pemit)
+		{
+			;
+		}
+        
+        virtual ~_connection_base() { }
+		virtual has_slots<mt_policy>* getdest() const = 0;
+		virtual _connection_base* clone() = 0;
+		virtual _connection_base* clone_at(void* pmem) = 0;
+		virtual _connection_base* duplicate(has_slots<mt_policy>* pnewdest) = 0;
+		virtual void retarget(has_slots<mt_policy>* pnewdest) = 0;
+        
+		// Whether the connection's receiver has gone without disconnecting
+		// it, as a has_weak_slots receiver does.
+		virtual bool expired() const
+		{
+			return false;
+		}
+        
+		void emit(typename _param<arg_types>::type... args)
+		{
+			m_pemit(this, args...);
+		}
+        
+		void emit_event(const event_type& event)
+		{
+			emit_unpacked(event, typename _make_index_list<sizeof...(arg_types)>::type());
+		}
+        
+		// Connections to a slot that takes a whole batch at once run it
+		// with all of the events and return true.
+		virtual bool emit_span(const event_type*, size_t)
+		{
+			return false;
+		}
+        
+		// Runs the slot for emit_until_handled(), and returns whether it
+		// handled the call. Only a slot that returns bool can say it did.
+		virtual bool emit_handled(typename _param<arg_types>::type... args)
+		{
+			emit(args...);
+			return false;
+		}
+        
+		// Queued connections hand their call to routing for emit_routed()
+		// and return true. Others return false, and are emitted directly.
+		virtual bool route(_routing<arg_types...>&)
+		{
+			return false;
+		}
+        
+		// A connection whose slot does nothing, which storage may leave in
+		// the place of one erased during an emit.
+		static _connection_base* tombstone();
+        
+	private:
+		template<size_t... indices>
+		void emit_unpacked(const event_type& event, _index_list<indices...>)
+		{
+			m_pemit(this, std::get<indices>(event)...);
+		}
+        
+		emit_thunk m_pemit;
+	};
+    
+	template<class mt_policy, class... arg_types>
+	class _tombstone_connection : public _connection_base<mt_policy, arg_types...>
+	{
+	public:
+		typedef _connection_base<mt_policy, arg_types...> base_type;
+        
+		_tombstone_connection()
+        : base_type(&emit_nothing)
+		{
+			;
+		}
+        
+		// There is only the one, which is never copied or moved.
+		virtual base_type* clone()
+		{
+			return this;
+		}
+        
+		virtual base_type* clone_at(void*)
+		{
+			return this;
+		}
+        
+		virtual base_type* duplicate(has_slots<mt_policy>*)
+		{
+			return this;
+		}
+        
+		virtual void retarget(has_slots<mt_policy>*)
+		{
+			;
+		}
+        
+		virtual has_slots<mt_policy>* getdest() const
+		{
+			return NULL;
+		}
+        
+	private:
+		static void emit_nothing(base_type*, typename _param<arg_types>::type...)
+		{
+			;
+		}
+	};
+    
+	template<class mt_policy, class... arg_types>
+	inline _connection_base<mt_policy, arg_types...>* _connection_base<mt_policy, arg_types...>::tombstone()
+	{
+		static _tombstone_connection<mt_policy, arg_types...> s_tombstone;
+		return &s_tombstone;
+	}
+    
+	// Returned by a signal's connect(). Handing it back to that signal's
+	// disconnect() removes exactly the one connection, without searching;
+	// once the connection is gone the handle is stale and is ignored. A
+	// default constructed handle refers to no connection.
+	class connection
+	{
+	public:
+		connection()
+        : m_slot(0), m_generation(0)
+		{
+			;
+		}
+        
+		connection(size_t slot, unsigned long generation)
+        : m_slot(slot), m_generation(generation)
+		{
+			;
+		}
+        
+		size_t m_slot;
+		unsigned long m_generation;
+	};
+    
+	template<class mt_policy>
+	class _signal_base;
+    
+	// has_slots keeps one of these for every connection made to it.
+	template<class mt_policy>
+	struct _sender_link
+	{
+		_sender_link()
+        : m_psender(NULL)
+		{
+			;
+		}
+        
+		_sender_link(_signal_base<mt_policy>* psender, const connection& conn)
+        : m_psender(psender), m_connection(conn)
+		{
+			;
+		}
+        
+		_signal_base<mt_policy>* m_psender;
+		connection m_connection;
+	};
+    
+	// The links of one has_slots. The first SIGSLOT_INLINE_SENDERS live in
+	// the object itself, so a receiver with that few connections never
+	// allocates for them; past that they all move to one heap array, which
+	// doubles as it fills. A link keeps its position until it is erased,
+	// and its signal keeps that position, so either side can remove it
+	// without a search. Erased positions are reused. A free one has no
+	// sender, and its connection's slot holds the next free position.
+	//
+	// The counts are 32 bits and the array's capacity is not stored, so
+	// that a receiver with no connections is no larger than one that kept
+	// its senders in a std::set. Links are only added at the end until
+	// clear(), so the array is full exactly when m_used is
+	// SIGSLOT_INLINE_SENDERS times a power of two.
+	template<class mt_policy>
+	class _sender_links
+	{
+	public:
+		typedef size_t position;
+		typedef _sender_link<mt_policy> link_type;
+        
+		_sender_links()
+        : m_plinks(m_inline), m_used(0), m_free(no_link)
+		{
+			;
+		}
+        
+		~_sender_links()
+		{
+			release();
+		}
+        
+		position insert(_signal_base<mt_policy>* psender, const connection& conn)
+		{
+			position pos = m_free;
+            
+			if(m_free != no_link)
+			{
+				m_free = count_type(m_plinks[pos].m_connection.m_slot);
+			}
+			else
+			{
+				if(full())
+				{
+					grow();
+				}
+                
+				pos = m_used++;
+			}
+            
+			m_plinks[pos] = link_type(psender, conn);
+			return pos;
+		}
+        
+		void erase(position pos)
+		{
+			m_plinks[pos] = link_type(NULL, connection(m_free, 0));
+			m_free = count_type(pos);
+		}
+        
+		void clear()
+		{
+			release();
+			m_plinks = m_inline;
+			m_used = 0;
+			m_free = no_link;
+		}
+        
+		// Takes over the links of another list, at the same positions, and
+		// leaves that one empty. Links past the inline ones are not copied.
+		void take(_sender_links& links)
+		{
+			clear();
+            
+			if(links.m_plinks == links.m_inline)
+			{
+				for(size_t i = 0; i < links.m_used; ++i)
+				{
+					m_inline[i] = links.m_inline[i];
+				}
+			}
+			else
+			{
+				m_plinks = links.m_plinks;
+				links.m_plinks = links.m_inline;
+			}
+            
+			m_used = links.m_used;
+			m_free = links.m_free;
+			links.m_used = 0;
+			links.m_free = no_link;
+		}
+        
+		// Positions run from 0 up to end(); free ones have no sender.
+		position end() const
+		{
+			return m_used;
+		}
+        
+		link_type& operator[](position pos)
+		{
+			return m_plinks[pos];
+		}
+        
+		const link_type& operator[](position pos) const
+		{
+			return m_plinks[pos];
+		}
+        
+	private:
+		_sender_links(const _sender_links&);
+		_sender_links& operator=(const _sender_links&);
+        
+		typedef SIGSLOT_ALLOCATOR<link_type> allocator_type;
+        
+		typedef unsigned int count_type;
+        
+		enum { inline_links = SIGSLOT_INLINE_SENDERS };
+        
+		static const count_type no_link = count_type(-1);
+        
+		bool full() const
+		{
+			count_type blocks = m_used / inline_links;
+			return m_used % inline_links == 0 && blocks != 0 && (blocks & (blocks - 1)) == 0;
+		}
+        
+		// The least SIGSLOT_INLINE_SENDERS times a power of two that holds
+		// every position used.
+		size_t capacity() const
+		{
+			size_t capacity = inline_links;
+            
+			while(capacity < m_used)
+			{
+				capacity *= 2;
+			}
+            
+			return capacity;
+		}
+        
+		// Called when full, so the array holds m_used links.
+		void grow()
+		{
+			allocator_type alloc;
+			size_t capacity = size_t(m_used) * 2;
+			link_type* plinks = alloc.allocate(capacity);
+            
+			for(size_t i = 0; i < capacity; ++i)
+			{
+				new(&plinks[i]) link_type(i < m_used ? m_plinks[i] : link_type());
+			}
+            
+			release();
+			m_plinks = plinks;
+		}
+        
+		void release()
+		{
+			if(m_plinks != m_inline)
+			{
+				allocator_type().deallocate(m_plinks, capacity());
+			}
+		}
+        
+		link_type* m_plinks;
+		count_type m_used;
+		count_type m_free;
+		link_type m_inline[inline_links];
+	};
+    
+	template<class mt_policy>
+	class _signal_base : public mt_policy
+	{
+	public:
+		typedef typename _sender_links<mt_policy>::position link_position;
+        
+		// Removes one connection while its receiver is being torn down. The
+		// receiver drops its own record.
+		virtual void slot_disconnect(const connection& conn) = 0;
+        
+		// Copies one connection of a receiver over to pnewslot, whose record
+		// for it is at plink, and returns the copy's handle in duplicate.
+		virtual bool slot_duplicate(const connection& conn, has_slots<mt_policy>* pnewslot,
+			link_position plink, connection& duplicate) = 0;
+        
+		// Points one connection at the object its receiver was moved to.
+		virtual void slot_relink(const connection& conn, has_slots<mt_policy>* pnewslot) = 0;
+	};
+    
+	class dispatcher;
+    
+	template<class  mt_policy = SIGSLOT_DEFAULT_MT_POLICY>
+	class has_slots : public mt_policy 
+	{
+	private:
+		typedef _sender_links<mt_policy> link_list;
+        
+	public:
+		typedef typename link_list::position link_position;
+        
+		has_slots()
+        : m_pdispatcher(NULL)
+		{
+			;
+		}
+        
+		has_slots(const has_slots& hs)
+        : mt_policy(hs), m_pdispatcher(hs.m_pdispatcher)
+		{
+			copy_links(hs);
+		} 
+        
+		has_slots(has_slots&& hs) noexcept
+        : mt_policy(hs), m_pdispatcher(hs.m_pdispatcher)
+		{
+			take_links(hs);
+		}
+        
+		// Drops this object's connections and duplicates those of hs, as
+		// the copy constructor does.
+		has_slots& operator=(const has_slots& hs)
+		{
+			if(&hs != this)
+			{
+				disconnect_all();
+				m_pdispatcher = hs.m_pdispatcher;
+				copy_links(hs);
+			}
+            
+			return *this;
+		}
+        
+		has_slots& operator=(has_slots&& hs) noexcept
+		{
+			if(&hs != this)
+			{
+				disconnect_all();
+				m_pdispatcher = hs.m_pdispatcher;
+				take_links(hs);
+			}
+            
+			return *this;
+		}
+        
+		link_position signal_connect(_signal_base<mt_policy>* sender, const connection& conn)
+		{
+			lock_block<mt_policy> lock(this);
+			return m_links.insert(sender, conn);
+		}
+        
+		void signal_disconnect(link_position plink)
+		{
+			lock_block<mt_policy> lock(this);
+			m_links.erase(plink);
+		}
+        
+		virtual ~has_slots()
+		{
+			disconnect_all();
+		}
+        
+		void disconnect_all()
+		{
+			lock_block<mt_policy> lock(this);
+            
+			for(link_position pos = 0; pos < m_links.end(); ++pos)
+			{
+				const _sender_link<mt_policy>& link = m_links[pos];
+                
+				if(link.m_psender != NULL)
+				{
+					link.m_psender->slot_disconnect(link.m_connection);
+				}
+			}
+            
+			m_links.clear();
+		}
+        
+		// The dispatcher that connections made with a plain queued_on()
+		// deliver to. Set it before making such connections.
+		void set_dispatcher(dispatcher* pdispatcher)
+		{
+			m_pdispatcher = pdispatcher;
+		}
+        
+		dispatcher* get_dispatcher() const
+		{
+			return m_pdispatcher;
+		}
+        
+	private:
+		// Has the signal of each link of hs duplicate its connection for
+		// this object.
+		void copy_links(const has_slots& hs)
+		{
+			for(link_position pos = 0; pos < hs.m_links.end(); ++pos)
+			{
+				const _sender_link<mt_policy>& link = hs.m_links[pos];
+                
+				if(link.m_psender == NULL)
+				{
+					continue;
+				}
+                
+				lock_block<mt_policy> lock(this);
+				link_position plink = m_links.insert(link.m_psender, connection());
+				connection duplicate;
+                
+				if(link.m_psender->slot_duplicate(link.m_connection, this, plink, duplicate))
+				{
+					m_links[plink].m_connection = duplicate;
+				}
+				else
+				{
+					m_links.erase(plink);
+				}
+			}
+		}
+        
+		// Moves the links of hs here and has each of their signals aim its
+		// connection at this object instead.
+		void take_links(has_slots& hs)
+		{
+			{
+				lock_block<mt_policy> lock(&hs);
+				m_links.take(hs.m_links);
+			}
+            
+			for(link_position pos = 0; pos < m_links.end(); ++pos)
+			{
+				_signal_base<mt_policy>* psender = m_links[pos].m_psender;
+                
+				if(psender != NULL)
+				{
+					lock_block<mt_policy> lock(this);
+					psender->slot_relink(m_links[pos].m_connection, this);
+				}
+			}
+		}
+        
+		link_list m_links;
+		dispatcher* m_pdispatcher;
+	};
+    
+	// The lifetime of a has_weak_slots receiver, shared with every
+	// connection made to it. The receiver holds one reference and each
+	// connection another, and the last to let go deletes it. m_calls counts
+	// the slot calls running on the receiver, so that once it is marked
+	// dead it can wait for those to finish.
+	class _receiver_life
+	{
+	public:
+		_receiver_life()
+        : m_refs(1), m_calls(0), m_alive(1)
+		{
+			;
+		}
+        
+		void add_ref()
+		{
+			_atomic_add(&m_refs, 1);
+		}
+        
+		void release()
+		{
+			if(_atomic_add(&m_refs, -1) == 0)
+			{
+				delete this;
+			}
+		}
+        
+		bool alive()
+		{
+			return _atomic_load(&m_alive) != 0;
+		}
+        
+		// Marks the receiver dead, so that no slot call starts on it, and
+		// waits for the calls already running on other threads. Calls
+		// further out on this thread's own stack are left to finish after.
+		void retire(long own_calls)
+		{
+			_atomic_store(&m_alive, 0);
+            
+			while(_atomic_load(&m_calls) != own_calls)
+			{
+				_thread_yield();
+			}
+		}
+        
+	private:
+		_receiver_life(const _receiver_life&);
+		_receiver_life& operator=(const _receiver_life&);
+        
+		friend class _receiver_call;
+        
+		volatile long m_refs;
+		volatile long m_calls;
+		volatile long m_alive;
+	};
+    
+	// One slot call on a has_weak_slots receiver, counted for as long as
+	// it runs. The count goes up before the receiver is checked, and the
+	// receiver's destructor marks it dead before reading the count, so a
+	// call either sees it dead or is waited for. The calls on each thread
+	// are chained, innermost first, so that a receiver destroyed from one
+	// of its own slots knows which calls are its own thread's.
+	class _receiver_call
+	{
+	public:
+		explicit _receiver_call(_receiver_life* plife)
+        : m_plife(plife), m_pouter(innermost())
+		{
+			_atomic_add(&m_plife->m_calls, 1);
+			m_entered = m_plife->alive();
+			innermost() = this;
+		}
+        
+		~_receiver_call()
+		{
+			innermost() = m_pouter;
+			_atomic_add(&m_plife->m_calls, -1);
+		}
+        
+		bool entered() const
+		{
+			return m_entered;
+		}
+        
+		static long calls_on_this_thread(const _receiver_life* plife)
+		{
+			long calls = 0;
+            
+			for(const _receiver_call* pcall = innermost(); pcall != NULL; pcall = pcall->m_pouter)
+			{
+				calls += pcall->m_plife == plife;
+			}
+            
+			return calls;
+		}
+        
+	private:
+		_receiver_call(const _receiver_call&);
+		_receiver_call& operator=(const _receiver_call&);
+        
+		static _receiver_call*& innermost()
+		{
+			static _SIGSLOT_THREAD_LOCAL _receiver_call* s_pinnermost = NULL;
+			return s_pinnermost;
+		}
+        
+		_receiver_life* m_plife;
+		_receiver_call* m_pouter;
+		bool m_entered;
+	};
+    
+	// A receiver that signals hold only a weak reference to. Unlike
+	// has_slots it keeps no record of its senders and has no lock: a
+	// connection to it holds its _receiver_life, and the destructor just
+	// marks that dead and waits for any slot call running on it, without
+	// touching a signal. So tearing one down takes no signal's lock, and
+	// cannot deadlock against a connect() that holds one, which lets
+	// per-object policies such as multi_threaded_local connect and destroy
+	// receivers on any thread. Each signal skips a dead receiver's slot
+	// when it emits, and removes the connection the next time it is
+	// connected to once enough have died.
+	//
+	// The cost is moved to emit(), which counts every call into a slot of
+	// one of these in and out. A copy or a move starts with no connections.
+	class has_weak_slots
+	{
+	public:
+		has_weak_slots()
+        : m_plife(new _receiver_life())
+		{
+			;
+		}
+        
+		has_weak_slots(const has_weak_slots&)
+        : m_plife(new _receiver_life())
+		{
+			;
+		}
+        
+		has_weak_slots& operator=(const has_weak_slots&)
+		{
+			return *this;
+		}
+        
+		virtual ~has_weak_slots()
+		{
+			m_plife->retire(_receiver_call::calls_on_this_thread(m_plife));
+			m_plife->release();
+		}
+        
+		// Ends every connection made to this object so far; later ones
+		// work as usual. A derived class whose slots use its own members
+		// should call this first in its destructor, so that no slot runs
+		// on another thread while those members are destroyed.
+		void disconnect_all()
+		{
+			_receiver_life* pfresh = new _receiver_life();
+			m_plife->retire(_receiver_call::calls_on_this_thread(m_plife));
+			m_plife->release();
+			m_plife = pfresh;
+		}
+        
+		_receiver_life* life() const
+		{
+			return m_plife;
+		}
+        
+	private:
+		_receiver_life* m_plife;
+	};
+    
+	// The connection bookkeeping of basic_signal, which only depends on the
+	// signal's arguments through the connection base type.
+	//
+	// Every connection owns a slot in m_slots, which records where the
+	// container keeps it and where its receiver keeps the matching
+	// _sender_link, so that either side can remove it without a search.
+	// Freed slots are reused, and bumping a slot's generation when it is
+	// freed is what makes old handles to it stale. A connection to a
+	// function or other callable has no receiver, and its m_pdest is NULL.
+	template<class conn_type, class mt_policy, class storage_policy>
+	class _signal_connections : public _signal_base<mt_policy>, public _instrumentation::signal_stats,
+		public _connection_allocation
+	{
+	public:
+		typedef typename _connections_for<conn_type, mt_policy, storage_policy>::type connections_list;
+		typedef typename connections_list::const_iterator const_iterator;
+		typedef typename connections_list::iterator iterator;
+		typedef typename _signal_base<mt_policy>::link_position link_position;
+        
+		_signal_connections()
+        : m_free_slot(no_slot), m_changes(0), m_lowest_priority(INT_MAX), m_unordered(false), m_pemitter(NULL), m_emit_depth(0),
+		m_pjob(NULL), m_weak_connections(0), m_weak_sweep_at(min_weak_sweep)
+		{
+			this->stats_register();
+		}
+        
+		_signal_connections(const _signal_connections& s)
+        : _signal_base<mt_policy>(s), _instrumentation::signal_stats(s), m_free_slot(no_slot), m_changes(0),
+		m_lowest_priority(INT_MAX), m_unordered(false), m_pemitter(NULL), m_emit_depth(0), m_pjob(NULL),
+		m_weak_connections(0), m_weak_sweep_at(min_weak_sweep)
+		{
+			this->stats_register();
+			copy_connections(s);
+		}
+        
+		// Adds a clone of each connection of s, with the same priority, as
+		// the copy constructor does.
+		void copy_connections(const _signal_connections& s)
+		{
+			const_iterator it = s.m_connected_slots.begin();
+			const_iterator itEnd = s.m_connected_slots.end();
+			std::vector<conn_type *> clones;
+			std::vector<int> priorities;
+            
+			while(it != itEnd)
+			{
+				clones.push_back((*it)->clone());
+				this->stats_clone(*clones.back());
+				priorities.push_back(s.m_slots[(*it)->m_slot].m_priority);
+				++it;
+			}
+            
+			for(size_t i = 0; i < clones.size(); ++i)
+			{
+				has_slots<mt_policy>* pdest = clones[i]->getdest();
+				lock_block<mt_policy> lock(this);
+				connection conn = add(clones[i], pdest, priorities[i]);
+                
+				if(pdest != NULL)
+				{
+					m_slots[conn.m_slot].m_link = pdest->signal_connect(this, conn);
+				}
+			}
+		}
+        
+		~_signal_connections()
+		{
+			this->stats_unregister();
+			disconnect_all();
+		}
+        
+		void collect_connections(std::vector<_instrumentation::histogram>& stats)
+		{
+			signal_lock lock(this);
+			const_iterator it = m_connected_slots.begin();
+			const_iterator itEnd = m_connected_slots.end();
+            
+			while(it != itEnd)
+			{
+				stats.push_back((*it)->latency());
+				++it;
+			}
+		}
+        
+		void disconnect_all()
+		{
+			signal_lock lock(this);
+			const_iterator it = m_connected_slots.begin();
 			const_iterator itEnd = m_connected_slots.end();
             
-			while(it != itEnd)
+			while(it != itEnd)
+			{
+				slot_entry& entry = m_slots[(*it)->m_slot];
+                
+				if(entry.m_pdest != NULL)
+				{
+					entry.m_pdest->signal_disconnect(entry.m_link);
+				}
+                
+				release_slot((*it)->m_slot);
+				++it;
+			}
+            
+			m_connected_slots.clear();
+		}
+        
+		void disconnect(has_slots<mt_policy>* pclass)
+		{
+			signal_lock lock(this);
+			iterator it = m_connected_slots.begin();
+			iterator itEnd = m_connected_slots.end();
+            
+			while(it != itEnd)
+			{
+				if((*it)->getdest() == pclass)
+				{
+					size_t slot = (*it)->m_slot;
+					m_connected_slots.erase(it);
+					pclass->signal_disconnect(m_slots[slot].m_link);
+					release_slot(slot);
+					return;
+				}
+                
+				++it;
+			}
+		}
+        
+		void disconnect(const connection& conn)
+		{
+			signal_lock lock(this);
+            
+			if(!is_live(conn))
+			{
+				return;
+			}
+            
+			slot_entry& entry = m_slots[conn.m_slot];
+			m_connected_slots.erase_at(entry.m_pos);
+            
+			if(entry.m_pdest != NULL)
+			{
+				entry.m_pdest->signal_disconnect(entry.m_link);
+			}
+            
+			release_slot(conn.m_slot);
+		}
+        
+		// Disconnects count connections at once. The signal is locked once
+		// and its storage closes the gaps in a single pass, so this costs
+		// one receiver lock per connection rather than a lock pair and a
+		// search each. Handles that are stale are skipped.
+		void disconnect_many(const connection* phandles, size_t count)
+		{
+			signal_lock lock(this);
+			std::vector<bool> doomed(m_slots.size(), false);
+			std::vector<size_t> slots;
+			slots.reserve(count);
+            
+			for(size_t i = 0; i < count; ++i)
+			{
+				const connection& conn = phandles[i];
+                
+				if(is_live(conn) && !doomed[conn.m_slot])
+				{
+					doomed[conn.m_slot] = true;
+					slots.push_back(conn.m_slot);
+				}
+			}
+            
+			if(slots.empty())
+			{
+				return;
+			}
+            
+			m_connected_slots.erase_if(slot_in(doomed));
+            
+			for(size_t i = 0; i < slots.size(); ++i)
+			{
+				slot_entry& entry = m_slots[slots[i]];
+                
+				if(entry.m_pdest != NULL)
+				{
+					entry.m_pdest->signal_disconnect(entry.m_link);
+				}
+                
+				release_slot(slots[i]);
+			}
+		}
+        
+		// A connection to a has_weak_slots receiver that has been destroyed
+		// is no longer connected, even before the signal has removed it.
+		bool connected(const connection& conn)
+		{
+			signal_lock lock(this);
+			return is_live(conn) && !m_connected_slots.at(m_slots[conn.m_slot].m_pos)->expired();
+		}
+        
+		void slot_disconnect(const connection& conn)
+		{
+			signal_lock lock(this);
+            
+			if(is_live(conn))
+			{
+				m_connected_slots.erase_at(m_slots[conn.m_slot].m_pos);
+				release_slot(conn.m_slot);
+			}
+		}
+        
+		bool slot_duplicate(const connection& conn, has_slots<mt_policy>* pnewslot,
+			link_position plink, connection& duplicate)
+		{
+			signal_lock lock(this);
+            
+			if(!is_live(conn))
+			{
+				return false;
+			}
+            
+			conn_type* pconn = m_connected_slots.at(m_slots[conn.m_slot].m_pos)->duplicate(pnewslot);
+			duplicate = add(pconn, pnewslot, m_slots[conn.m_slot].m_priority);
+			m_slots[duplicate.m_slot].m_link = plink;
+			return true;
+		}
+        
+		void slot_relink(const connection& conn, has_slots<mt_policy>* pnewslot)
+		{
+			signal_lock lock(this);
+            
+			if(is_live(conn))
+			{
+				m_slots[conn.m_slot].m_pdest = pnewslot;
+				m_connected_slots.retarget(m_slots[conn.m_slot].m_pos, pnewslot);
+			}
+		}
+        
+	protected:
+		// Locks this signal, unless the calling thread is inside one of its
+		// emits and so holds its lock already. In a slot of its
+		// emit_parallel() job, it locks the job instead.
+		class signal_lock : public _reentrant_lock_block<mt_policy>
+		{
+		public:
+			signal_lock(_signal_connections* psignal)
+            : _reentrant_lock_block<mt_policy>(psignal, psignal->emitting_here(), psignal->job_here())
+			{
+				;
+			}
+		};
+        
+		// Marks the calling thread as inside an emit of this signal, for the
+		// policies with _reentrant_emit. Made with the emit lock held.
+		class emit_scope
+		{
+		public:
+			emit_scope(_signal_connections* psignal)
+            : m_psignal(psignal)
+			{
+				if(_reentrant_emit<mt_policy>::value && m_psignal->m_emit_depth++ == 0)
+				{
+					_atomic_store_relaxed(&m_psignal->m_pemitter, _current_thread());
+				}
+			}
+            
+			~emit_scope()
+			{
+				if(_reentrant_emit<mt_policy>::value && --m_psignal->m_emit_depth == 0)
+				{
+					_atomic_store_relaxed(&m_psignal->m_pemitter, static_cast<void*>(NULL));
+                    
+					if(m_psignal->m_unordered)
+					{
+						m_psignal->restore_order();
+					}
+				}
+			}
+            
+		private:
+			_signal_connections* m_psignal;
+		};
+        
+		// Makes pjob the lock that the threads running an emit_parallel()
+		// job take in place of this signal's, while the job runs. Made with
+		// the emit lock held.
+		class job_scope
+		{
+		public:
+			job_scope(_signal_connections* psignal, _parallel_lock<mt_policy>* pjob)
+            : m_psignal(psignal), m_pouter(psignal->m_pjob)
+			{
+				_atomic_store_relaxed(&m_psignal->m_pjob, pjob);
+			}
+            
+			~job_scope()
+			{
+				_atomic_store_relaxed(&m_psignal->m_pjob, m_pouter);
+			}
+            
+		private:
+			_signal_connections* m_psignal;
+			_parallel_lock<mt_policy>* m_pouter;
+		};
+        
+		// Only the thread that set m_pemitter can find its own tag there,
+		// and it sees its own stores in order, so no barrier is needed.
+		bool emitting_here()
+		{
+			return _reentrant_emit<mt_policy>::value && _atomic_load_relaxed(&m_pemitter) == _current_thread();
+		}
+        
+		// The lock of this signal's emit_parallel() job, when the calling
+		// thread is running one of its slots, or NULL. The policies without
+		// _reentrant_emit do not let those slots use the signal.
+		_parallel_lock<mt_policy>* job_here()
+		{
+			if(!_reentrant_emit<mt_policy>::value)
+			{
+				return NULL;
+			}
+            
+			_parallel_lock<mt_policy>* pjob = _atomic_load_relaxed(&m_pjob);
+			return pjob != NULL && pjob == _current_job() ? pjob : NULL;
+		}
+        
+		// For timing slot calls in emit(). A slot may disconnect itself, or
+		// move its connection by connecting another, so a call is only
+		// recorded if the connections are as they were before it.
+		unsigned long call_mark() const
+		{
+			return _lock_free_emit<mt_policy>::value ? 0 : m_changes;
+		}
+        
+		void note_call(conn_type* pconn, unsigned long mark, const _instrumentation::timer& call)
+		{
+			if(call_mark() == mark)
+			{
+				this->note_slot_call(*pconn, call);
+			}
+		}
+        
+		// Runs one connection's slot with every event in turn, for
+		// emit_batch(). Where the emitting thread's slots may change the
+		// connections, each call is checked for that: the batch stops for a
+		// connection that is gone, and one that a storage change may have
+		// moved is looked up again.
+		void emit_events(conn_type* pconn, const typename conn_type::event_type* pevents, size_t count)
+		{
+			if(pconn == conn_type::tombstone() || pconn->emit_span(pevents, count))
+			{
+				return;
+			}
+            
+			if(_lock_free_emit<mt_policy>::value)
+			{
+				for(size_t i = 0; i < count; ++i)
+				{
+					pconn->emit_event(pevents[i]);
+				}
+                
+				return;
+			}
+            
+			size_t slot = pconn->m_slot;
+			unsigned long generation = m_slots[slot].m_generation;
+			unsigned long changes = m_changes;
+            
+			for(size_t i = 0; i < count; ++i)
+			{
+				if(m_changes != changes)
+				{
+					if(m_slots[slot].m_generation != generation)
+					{
+						return;
+					}
+                    
+					pconn = m_connected_slots.at(m_slots[slot].m_pos);
+					changes = m_changes;
+				}
+                
+				pconn->emit_event(pevents[i]);
+			}
+		}
+        
+		// Holds a batch of connects together, for connect_many(): the
+		// storage makes room for them all first and, for copy on write,
+		// publishes them together at the end.
+		class change_batch
+		{
+		public:
+			change_batch(_signal_connections* psignal, size_t count)
+            : m_psignal(psignal)
+			{
+				std::vector<slot_entry>& slots = m_psignal->m_slots;
+                
+				if(slots.size() + count > slots.capacity())
+				{
+					slots.reserve(std::max(slots.size() + count, slots.capacity() * 2));
+				}
+                
+				m_psignal->m_connected_slots.reserve(count);
+				m_psignal->m_connected_slots.begin_changes();
+			}
+            
+			~change_batch()
+			{
+				m_psignal->m_connected_slots.end_changes();
+			}
+            
+		private:
+			_signal_connections* m_psignal;
+		};
+        
+		// Adds a connection and registers it with its receiver. Called with
+		// the signal locked.
+		template<class conn_impl>
+		connection add_copy(conn_impl conn, int priority)
+		{
+			has_slots<mt_policy>* pdest = conn.getdest();
+			iterator before = insert_point(priority);
+			size_t slot = acquire_slot();
+			conn.m_slot = slot;
+			m_slots[slot].m_pos = m_connected_slots.insert_copy(before, conn);
+			m_slots[slot].m_pdest = pdest;
+			m_slots[slot].m_priority = priority;
+            
+			connection handle(slot, m_slots[slot].m_generation);
+            
+			if(pdest != NULL)
+			{
+				m_slots[slot].m_link = pdest->signal_connect(this, handle);
+			}
+            
+			return handle;
+		}
+        
+		// Counts a connection to a has_weak_slots receiver, made with the
+		// signal locked. Those whose receivers have gone are removed once
+		// the count has doubled since the last time, so each connect pays
+		// for the sweep a constant share.
+		void count_weak_connect()
+		{
+			if(++m_weak_connections >= m_weak_sweep_at)
+			{
+				sweep_expired();
+			}
+		}
+        
+		connections_list m_connected_slots;   
+        
+	private:
+		typedef typename connections_list::position position;
+        
+		enum { no_slot = -1, min_weak_sweep = 16 };
+        
+		struct slot_entry
+		{
+			position m_pos;
+			has_slots<mt_policy>* m_pdest;
+			link_position m_link;
+			unsigned long m_generation;
+			size_t m_next_free;
+			int m_priority;
+		};
+        
+		// Adopts a heap allocated connection; the caller fills in m_link.
+		connection add(conn_type* pconn, has_slots<mt_policy>* pdest, int priority)
+		{
+			iterator before = insert_point(priority);
+			size_t slot = acquire_slot();
+			pconn->m_slot = slot;
+			m_slots[slot].m_pos = m_connected_slots.insert(before, pconn);
+			m_slots[slot].m_pdest = pdest;
+			m_slots[slot].m_priority = priority;
+			return connection(slot, m_slots[slot].m_generation);
+		}
+        
+		// Connections are kept with the highest priority first, and those
+		// of equal priority in the order they were made, so a new one goes
+		// in after every connection of its own priority or higher. No
+		// connection has a priority below m_lowest_priority, so in the usual
+		// case of equal priorities there is nothing to search. Storage that
+		// cannot insert inside itself during an emit appends instead, and
+		// the outermost emit sorts it on the way out.
+		iterator insert_point(int priority)
+		{
+			if(priority <= m_lowest_priority)
+			{
+				m_lowest_priority = priority;
+				return m_connected_slots.end();
+			}
+            
+			if(!m_connected_slots.can_insert_inside())
+			{
+				m_unordered = true;
+				return m_connected_slots.end();
+			}
+            
+			iterator it = m_connected_slots.begin();
+			iterator itEnd = m_connected_slots.end();
+            
+			while(it != itEnd && m_slots[(*it)->m_slot].m_priority >= priority)
+			{
+				++it;
+			}
+            
+			return it;
+		}
+        
+		class priority_order
+		{
+		public:
+			priority_order(const std::vector<slot_entry>& slots)
+            : m_pslots(&slots)
+			{
+				;
+			}
+            
+			bool operator()(const conn_type* pa, const conn_type* pb) const
+			{
+				return (*m_pslots)[pa->m_slot].m_priority > (*m_pslots)[pb->m_slot].m_priority;
+			}
+            
+		private:
+			const std::vector<slot_entry>* m_pslots;
+		};
+        
+		// Picks the connections whose slots are marked, for erase_if().
+		class slot_in
+		{
+		public:
+			slot_in(const std::vector<bool>& marked)
+            : m_pmarked(&marked)
+			{
+				;
+			}
+            
+			bool operator()(const conn_type* pconn) const
+			{
+				return (*m_pmarked)[pconn->m_slot];
+			}
+            
+		private:
+			const std::vector<bool>* m_pmarked;
+		};
+        
+		// Picks the connections whose receivers have gone, for erase_if(),
+		// and records their slots.
+		class expired_in
+		{
+		public:
+			expired_in(std::vector<size_t>& slots)
+            : m_pslots(&slots)
+			{
+				;
+			}
+            
+			bool operator()(const conn_type* pconn) const
+			{
+				if(!pconn->expired())
+				{
+					return false;
+				}
+                
+				m_pslots->push_back(pconn->m_slot);
+				return true;
+			}
+            
+		private:
+			std::vector<size_t>* m_pslots;
+		};
+        
+		// Removes the connections whose has_weak_slots receivers have been
+		// destroyed. Weak connections ended through their handles stay in
+		// the count, which only brings the next sweep forward.
+		_SIGSLOT_NOINLINE void sweep_expired()
+		{
+			std::vector<size_t> slots;
+			m_connected_slots.erase_if(expired_in(slots));
+            
+			for(size_t i = 0; i < slots.size(); ++i)
+			{
+				release_slot(slots[i]);
+			}
+            
+			m_weak_connections -= std::min(m_weak_connections, slots.size());
+			m_weak_sweep_at = std::max<size_t>(2 * m_weak_connections, min_weak_sweep);
+		}
+        
+		// Kept out of emit(), which the sort's loops would otherwise crowd.
+		_SIGSLOT_NOINLINE void restore_order()
+		{
+			m_connected_slots.sort(priority_order(m_slots));
+			m_unordered = false;
+		}
+        
+		bool is_live(const connection& conn) const
+		{
+			return conn.m_slot < m_slots.size() && conn.m_generation != 0 &&
+				m_slots[conn.m_slot].m_generation == conn.m_generation;
+		}
+        
+		size_t acquire_slot()
+		{
+			++m_changes;
+            
+			if(m_free_slot != size_t(no_slot))
+			{
+				size_t slot = m_free_slot;
+				m_free_slot = m_slots[slot].m_next_free;
+				return slot;
+			}
+            
+			slot_entry entry = slot_entry();
+			entry.m_generation = 1;
+			m_slots.push_back(entry);
+			return m_slots.size() - 1;
+		}
+        
+		void release_slot(size_t slot)
+		{
+			++m_changes;
+			slot_entry& entry = m_slots[slot];
+            
+			if(++entry.m_generation == 0)
+			{
+				entry.m_generation = 1;
+			}
+            
+			entry.m_next_free = m_free_slot;
+			m_free_slot = slot;
+		}
+        
+		std::vector<slot_entry> m_slots;
+		size_t m_free_slot;
+		unsigned long m_changes;
+		int m_lowest_priority;
+		bool m_unordered;
+		void* volatile m_pemitter;
+		int m_emit_depth;
+		_parallel_lock<mt_policy>* volatile m_pjob;
+		size_t m_weak_connections;
+		size_t m_weak_sweep_at;
+	};
+    
+	template<class dest_type, class mt_policy, class... arg_types>
+	class _connection : public _connection_base<mt_policy, arg_types...>
+	{
+	public:
+		typedef _connection_base<mt_policy, arg_types...> base_type;
+        
+		_connection(dest_type* pobject, void (dest_type::*pmemfun)(arg_types...))
+        : base_type(&emit_member), m_pobject(pobject), m_pmemfun(pmemfun)
+		{
+			;
+		}
+        
+		virtual base_type* clone()
+		{
+			return new _connection(*this);
+		}
+        
+		virtual base_type* clone_at(void* pmem)
+		{
+			return new(pmem) _connection(*this);
+		}
+        
+		virtual base_type* duplicate(has_slots<mt_policy>* pnewdest)
+		{
+			return new _connection((dest_type *)pnewdest, m_pmemfun);
+		}
+        
+		virtual void retarget(has_slots<mt_policy>* pnewdest)
+		{
+			m_pobject = (dest_type *)pnewdest;
+		}
+        
+		virtual has_slots<mt_policy>* getdest() const
+		{
+			return m_pobject;
+		}
+        
+	private:
+		static void emit_member(base_type* pconn, typename _param<arg_types>::type... args)
+		{
+			_connection* pself = static_cast<_connection*>(pconn);
+			(pself->m_pobject->*pself->m_pmemfun)(args...);
+		}
+        
+		dest_type* m_pobject;
+		void (dest_type::* m_pmemfun)(arg_types...);
+	};
+    
+	// A connection to a has_weak_slots receiver. As far as the signal is
+	// concerned it has no receiver, like a connection to a function: only
+	// the receiver's lifetime says whether its slot may still be called.
+	template<class dest_type, class mt_policy, class... arg_types>
+	class _weak_connection : public _connection_base<mt_policy, arg_types...>
+	{
+	public:
+		typedef _connection_base<mt_policy, arg_types...> base_type;
+        
+		_weak_connection(dest_type* pobject, void (dest_type::*pmemfun)(arg_types...))
+        : base_type(&emit_member), m_pobject(pobject), m_pmemfun(pmemfun), m_plife(pobject->life())
+		{
+			m_plife->add_ref();
+		}
+        
+		_weak_connection(const _weak_connection& conn)
+        : base_type(conn), m_pobject(conn.m_pobject), m_pmemfun(conn.m_pmemfun), m_plife(conn.m_plife)
+		{
+			m_plife->add_ref();
+		}
+        
+		~_weak_connection()
+		{
+			m_plife->release();
+		}
+        
+		virtual base_type* clone()
+		{
+			return new _weak_connection(*this);
+		}
+        
+		virtual base_type* clone_at(void* pmem)
+		{
+			return new(pmem) _weak_connection(*this);
+		}
+        
+		virtual base_type* duplicate(has_slots<mt_policy>*)
+		{
+			return clone();
+		}
+        
+		virtual void retarget(has_slots<mt_policy>*)
+		{
+			;
+		}
+        
+		virtual has_slots<mt_policy>* getdest() const
+		{
+			return NULL;
+		}
+        
+		virtual bool expired() const
+		{
+			return !m_plife->alive();
+		}
+        
+	private:
+		_weak_connection& operator=(const _weak_connection&);
+        
+		static void emit_member(base_type* pconn, typename _param<arg_types>::type... args)
+		{
+			_weak_connection* pself = static_cast<_weak_connection*>(pconn);
+			_receiver_call call(pself->m_plife);
+            
+			if(call.entered())
+			{
+				(pself->m_pobject->*pself->m_pmemfun)(args...);
+			}
+		}
+        
+		dest_type* m_pobject;
+		void (dest_type::* m_pmemfun)(arg_types...);
+		_receiver_life* m_plife;
+	};
+    
+	// A connection to a slot that returns bool. emit() ignores the result;
+	// emit_until_handled() stops at the first slot to return true.
+	template<class dest_type, class mt_policy, class... arg_types>
+	class _handler_connection : public _connection_base<mt_policy, arg_types...>
+	{
+	public:
+		typedef _connection_base<mt_policy, arg_types...> base_type;
+        
+		_handler_connection(dest_type* pobject, bool (dest_type::*pmemfun)(arg_types...))
+        : base_type(&emit_member), m_pobject(pobject), m_pmemfun(pmemfun)
+		{
+			;
+		}
+        
+		virtual base_type* clone()
+		{
+			return new _handler_connection(*this);
+		}
+        
+		virtual base_type* clone_at(void* pmem)
+		{
+			return new(pmem) _handler_connection(*this);
+		}
+        
+		virtual base_type* duplicate(has_slots<mt_policy>* pnewdest)
+		{
+			return new _handler_connection((dest_type *)pnewdest, m_pmemfun);
+		}
+        
+		virtual void retarget(has_slots<mt_policy>* pnewdest)
+		{
+			m_pobject = (dest_type *)pnewdest;
+		}
+        
+		virtual has_slots<mt_policy>* getdest() const
+		{
+			return m_pobject;
+		}
+        
+		virtual bool emit_handled(typename _param<arg_types>::type... args)
+		{
+			return (m_pobject->*m_pmemfun)(args...);
+		}
+        
+	private:
+		static void emit_member(base_type* pconn, typename _param<arg_types>::type... args)
+		{
+			_handler_connection* pself = static_cast<_handler_connection*>(pconn);
+			(pself->m_pobject->*pself->m_pmemfun)(args...);
+		}
+        
+		dest_type* m_pobject;
+		bool (dest_type::* m_pmemfun)(arg_types...);
+	};
+    
+	// Connections made by connect<desttype, &desttype::method>(). The member
+	// function is a template argument, so the thunk calls it directly and
+	// the compiler can inline the slot into it.
+	template<class dest_type, class mt_policy, class memfun_type, memfun_type pmemfun>
+	class _bound_connection;
+    
+	template<class dest_type, class mt_policy, class... arg_types, void (dest_type::*pmemfun)(arg_types...)>
+	class _bound_connection<dest_type, mt_policy, void (dest_type::*)(arg_types...), pmemfun>
+    : public _connection_base<mt_policy, arg_types...>
+	{
+	public:
+		typedef _connection_base<mt_policy, arg_types...> base_type;
+        
+		_bound_connection(dest_type* pobject)
+        : base_type(&emit_member), m_pobject(pobject)
+		{
+			;
+		}
+        
+		virtual base_type* clone()
+		{
+			return new _bound_connection(*this);
+		}
+        
+		virtual base_type* clone_at(void* pmem)
+		{
+			return new(pmem) _bound_connection(*this);
+		}
+        
+		virtual base_type* duplicate(has_slots<mt_policy>* pnewdest)
+		{
+			return new _bound_connection((dest_type *)pnewdest);
+		}
+        
+		virtual void retarget(has_slots<mt_policy>* pnewdest)
+		{
+			m_pobject = (dest_type *)pnewdest;
+		}
+        
+		virtual has_slots<mt_policy>* getdest() const
+		{
+			return m_pobject;
+		}
+        
+	private:
+		static void emit_member(base_type* pconn, typename _param<arg_types>::type... args)
+		{
+			(static_cast<_bound_connection*>(pconn)->m_pobject->*pmemfun)(args...);
+		}
+        
+		dest_type* m_pobject;
+	};
+    
+	// A connection to a slot that takes a batch of events as one span. A
+	// single emit() reaches it as a batch of one.
+	template<class dest_type, class mt_policy, class... arg_types>
+	class _bulk_connection : public _connection_base<mt_policy, arg_types...>
+	{
+	public:
+		typedef _connection_base<mt_policy, arg_types...> base_type;
+		typedef typename base_type::event_type event_type;
+        
+		_bulk_connection(dest_type* pobject, void (dest_type::*pmemfun)(const event_type*, size_t))
+        : base_type(&emit_one), m_pobject(pobject), m_pmemfun(pmemfun)
+		{
+			;
+		}
+        
+		virtual base_type* clone()
+		{
+			return new _bulk_connection(*this);
+		}
+        
+		virtual base_type* clone_at(void* pmem)
+		{
+			return new(pmem) _bulk_connection(*this);
+		}
+        
+		virtual base_type* duplicate(has_slots<mt_policy>* pnewdest)
+		{
+			return new _bulk_connection((dest_type *)pnewdest, m_pmemfun);
+		}
+        
+		virtual void retarget(has_slots<mt_policy>* pnewdest)
+		{
+			m_pobject = (dest_type *)pnewdest;
+		}
+        
+		virtual has_slots<mt_policy>* getdest() const
+		{
+			return m_pobject;
+		}
+        
+		virtual bool emit_span(const event_type* pevents, size_t count)
+		{
+			(m_pobject->*m_pmemfun)(pevents, count);
+			return true;
+		}
+        
+	private:
+		static void emit_one(base_type* pconn, typename _param<arg_types>::type... args)
+		{
+			_bulk_connection* pself = static_cast<_bulk_connection*>(pconn);
+			event_type event(args...);
+			(pself->m_pobject->*pself->m_pmemfun)(&event, 1);
+		}
+        
+		dest_type* m_pobject;
+		void (dest_type::* m_pmemfun)(const event_type*, size_t);
+	};
+    
+	// Holds the callable of a connection made by connect(functor). It is
+	// kept in the connection itself if the two fit in a vector_storage
+	// cell, and on the heap if not.
+	template<class functor_type, bool fits>
+	class _functor_holder
+	{
+	public:
+		_functor_holder(const functor_type& functor)
+        : m_functor(functor)
+		{
+			;
+		}
+        
+		functor_type& get()
+		{
+			return m_functor;
+		}
+        
+	private:
+		functor_type m_functor;
+	};
+    
+	template<class functor_type>
+	class _functor_holder<functor_type, false>
+	{
+	public:
+		_functor_holder(const functor_type& functor)
+        : m_pfunctor(new functor_type(functor))
+		{
+			;
+		}
+        
+		_functor_holder(const _functor_holder& holder)
+        : m_pfunctor(new functor_type(*holder.m_pfunctor))
+		{
+			;
+		}
+        
+		~_functor_holder()
+		{
+			delete m_pfunctor;
+		}
+        
+		functor_type& get()
+		{
+			return *m_pfunctor;
+		}
+        
+	private:
+		_functor_holder& operator=(const _functor_holder&);
+        
+		functor_type* m_pfunctor;
+	};
+    
+	// A connection to a free function, lambda or other callable, which has
+	// no receiver. It lasts until it is disconnected through its handle, or
+	// the signal is destroyed. A callable that returns bool can stop
+	// emit_until_handled().
+	template<class functor_type, class mt_policy, class... arg_types>
+	class _functor_connection : public _connection_base<mt_policy, arg_types...>
+	{
+	public:
+		typedef _connection_base<mt_policy, arg_types...> base_type;
+        
+		_functor_connection(const functor_type& functor)
+        : base_type(&emit_functor), m_functor(functor)
+		{
+			;
+		}
+        
+		virtual base_type* clone()
+		{
+			return new _functor_connection(*this);
+		}
+        
+		virtual base_type* clone_at(void* pmem)
+		{
+			return new(pmem) _functor_connection(*this);
+		}
+        
+		// Only connections with a receiver are duplicated or retargeted.
+		virtual base_type* duplicate(has_slots<mt_policy>*)
+		{
+			return clone();
+		}
+        
+		virtual void retarget(has_slots<mt_policy>*)
+		{
+			;
+		}
+        
+		virtual has_slots<mt_policy>* getdest() const
+		{
+			return NULL;
+		}
+        
+		virtual bool emit_handled(typename _param<arg_types>::type... args)
+		{
+			return call(std::is_same<result_type, bool>(), args...);
+		}
+        
+	private:
+		typedef decltype(std::declval<functor_type&>()(std::declval<typename _param<arg_types>::type>()...)) result_type;
+        
+		enum { fits = sizeof(base_type) + sizeof(functor_type) <= SIGSLOT_INLINE_CONNECTION_SIZE &&
+			std::alignment_of<functor_type>::value <= std::alignment_of<void*>::value };
+        
+		static void emit_functor(base_type* pconn, typename _param<arg_types>::type... args)
+		{
+			static_cast<_functor_connection*>(pconn)->m_functor.get()(args...);
+		}
+        
+		bool call(std::true_type, typename _param<arg_types>::type... args)
+		{
+			return m_functor.get()(args...);
+		}
+        
+		bool call(std::false_type, typename _param<arg_types>::type... args)
+		{
+			m_functor.get()(args...);
+			return false;
+		}
+        
+		_functor_holder<functor_type, fits> m_functor;
+	};
+    
+	// Whether any of the argument types is a non-const lvalue reference,
+	// which an event stored for emit_batch() cannot bind.
+	template<class... arg_types>
+	struct _has_mutable_ref
+	{
+		enum { value = false };
+	};
+    
+	template<class arg_type, class... arg_types>
+	struct _has_mutable_ref<arg_type, arg_types...>
+	{
+		enum { value = (std::is_lvalue_reference<arg_type>::value
+			&& !std::is_const<typename std::remove_reference<arg_type>::type>::value)
+			|| _has_mutable_ref<arg_types...>::value };
+	};
+    
+	// The order emit_batch() runs slots and events in. event_major runs
+	// every slot for the first event, then every slot for the next, just
+	// as a loop of emit() calls would. slot_major runs the first slot for
+	// every event, then the next slot, which keeps each slot's code and
+	// data hot but changes the interleaving slots see.
+	enum batch_order
+	{
+		event_major,
+		slot_major
+	};
+    
+#ifdef __cpp_nontype_template_parameter_auto
+	template<class memfun_type>
+	struct _member_class;
+    
+	template<class dest_type, class... arg_types>
+	struct _member_class<void (dest_type::*)(arg_types...)>
+	{
+		typedef dest_type type;
+	};
+#endif
+    
+	// An emit waiting in a dispatcher's queue. The dispatcher deletes it
+	// once it has run, unless m_owned is cleared because the event is part
+	// of something else, such as a coroutine's frame. An event the
+	// dispatcher is destroyed with is passed to dropped() instead.
+	class _queued_event : public _connection_allocation
+	{
+	public:
+		_queued_event()
+        : m_pnext(NULL), m_owned(true)
+		{
+			;
+		}
+        
+		virtual ~_queued_event()
+		{
+			;
+		}
+        
+		virtual void run() = 0;
+        
+		virtual void dropped()
+		{
+			if(m_owned)
+			{
+				delete this;
+			}
+		}
+        
+		_queued_event* volatile m_pnext;
+		bool m_owned;
+	};
+    
+	// Runs queued emits on the thread that calls dispatch(). Any number of
+	// threads may emit into it; the queue is an intrusive multiple producer,
+	// single consumer list, so posting takes no lock and never waits.
+	// Override notify() to wake the owning thread's event loop; it is called
+	// on the emitting thread after every post. Events held back with defer()
+	// do not notify; a loop that waits should wake by next_deadline().
+	class dispatcher
+	{
+	public:
+		dispatcher()
+        : m_phead(&m_stub), m_ptail(&m_stub), m_pdeferred(NULL),
+		m_deadline(std::chrono::steady_clock::time_point::max())
+		{
+			;
+		}
+        
+		// Events still queued are dropped without being run.
+		virtual ~dispatcher()
+		{
+			while(_queued_event* pevent = pop())
+			{
+				pevent->dropped();
+			}
+            
+			while(_queued_event* pevent = m_pdeferred)
+			{
+				m_pdeferred = pevent->m_pnext;
+				pevent->dropped();
+			}
+		}
+        
+		void post(_queued_event* pevent)
+		{
+			pevent->m_pnext = NULL;
+			_queued_event* pprev = _atomic_exchange(&m_phead, pevent);
+			_atomic_store(&pprev->m_pnext, pevent);
+			notify();
+		}
+        
+		// Runs up to max_events queued emits, oldest first, and returns how
+		// many ran. Deferred events run first, once their deadline has
+		// passed. Only the owning thread may call this.
+		size_t dispatch(size_t max_events = size_t(-1))
+		{
+			size_t count = 0;
+            
+			if(m_pdeferred != NULL && std::chrono::steady_clock::now() >= m_deadline)
+			{
+				count = run_deferred(max_events);
+			}
+            
+			while(count < max_events)
+			{
+				_queued_event* pevent = pop();
+                
+				if(pevent == NULL)
+				{
+					break;
+				}
+                
+				run_event(pevent);
+				++count;
+			}
+            
+			return count;
+		}
+        
+		// Holds an event back until due, for an event that finds it has run
+		// too soon; the first dispatch() from then on runs it again. No
+		// notify() is made. Only an event running on the owning thread may
+		// call this.
+		void defer(_queued_event* pevent, std::chrono::steady_clock::time_point due)
+		{
+			pevent->m_pnext = m_pdeferred;
+			m_pdeferred = pevent;
+            
+			if(due < m_deadline)
+			{
+				m_deadline = due;
+			}
+		}
+        
+		// When the earliest deferred event is due, or time_point::max() when
+		// none is. Only the owning thread may call this.
+		std::chrono::steady_clock::time_point next_deadline() const
+		{
+			return m_deadline;
+		}
+        
+	protected:
+		virtual void notify()
+		{
+			;
+		}
+        
+	private:
+		dispatcher(const dispatcher&);
+		dispatcher& operator=(const dispatcher&);
+        
+		class stub_event : public _queued_event
+		{
+		public:
+			virtual void run()
+			{
+				;
+			}
+		};
+        
+		// Returns NULL when the queue is empty, and also when a producer is
+		// midway through a post; that event is picked up by a later call.
+		_queued_event* pop()
+		{
+			_queued_event* ptail = m_ptail;
+			_queued_event* pnext = _atomic_load(&ptail->m_pnext);
+            
+			if(ptail == &m_stub)
+			{
+				if(pnext == NULL)
+				{
+					return NULL;
+				}
+                
+				m_ptail = pnext;
+				ptail = pnext;
+				pnext = _atomic_load(&ptail->m_pnext);
+			}
+            
+			if(pnext != NULL)
+			{
+				m_ptail = pnext;
+				return ptail;
+			}
+            
+			if(ptail != _atomic_load(&m_phead))
+			{
+				return NULL;
+			}
+            
+			post_stub();
+			pnext = _atomic_load(&ptail->m_pnext);
+            
+			if(pnext != NULL)
+			{
+				m_ptail = pnext;
+				return ptail;
+			}
+            
+			return NULL;
+		}
+        
+		void post_stub()
+		{
+			m_stub.m_pnext = NULL;
+			_queued_event* pprev = _atomic_exchange(&m_phead, static_cast<_queued_event*>(&m_stub));
+			_atomic_store(&pprev->m_pnext, static_cast<_queued_event*>(&m_stub));
+		}
+        
+		void run_event(_queued_event* pevent)
+		{
+			// Running an event that is not owned may end its lifetime.
+			bool owned = pevent->m_owned;
+			pevent->run();
+            
+			if(owned)
+			{
+				delete pevent;
+			}
+		}
+        
+		// Runs the deferred events, all of which may be early but one; an
+		// early one defers itself again. Those beyond max_events stay
+		// deferred, due at once.
+		_SIGSLOT_NOINLINE size_t run_deferred(size_t max_events)
+		{
+			_queued_event* pevent = m_pdeferred;
+			m_pdeferred = NULL;
+			m_deadline = std::chrono::steady_clock::time_point::max();
+			size_t count = 0;
+            
+			for(; pevent != NULL && count < max_events; ++count)
+			{
+				_queued_event* pnext = pevent->m_pnext;
+				run_event(pevent);
+				pevent = pnext;
+			}
+            
+			while(pevent != NULL)
+			{
+				_queued_event* pnext = pevent->m_pnext;
+				defer(pevent, std::chrono::steady_clock::time_point::min());
+				pevent = pnext;
+			}
+            
+			return count;
+		}
+        
+		_queued_event* volatile m_phead;
+		_queued_event* m_ptail;
+		stub_event m_stub;
+		_queued_event* m_pdeferred;
+		std::chrono::steady_clock::time_point m_deadline;
+	};
+    
+	// Passed as the last argument of connect() to make a queued connection.
+	// Each emit then copies its arguments into an event on the dispatcher,
+	// and the slot runs when the dispatcher's thread next calls dispatch().
+	// A default constructed queued_on uses the receiver's home dispatcher
+	// (has_slots::set_dispatcher()); with none set, the connection is a
+	// direct one.
+	//
+	// Arguments are stored by value, so reference parameters refer to the
+	// stored copy by the time the slot runs. Events still queued when the
+	// connection goes away, including through has_slots::disconnect_all()
+	// or the receiver's destruction, are dropped rather than run. Receivers
+	// should be disconnected and destroyed on their dispatcher's thread;
+	// disconnecting elsewhere does not wait for a slot that is already
+	// running.
+	class queued_on
+	{
+	public:
+		queued_on()
+        : m_pdispatcher(NULL)
+		{
+			;
+		}
+        
+		explicit queued_on(dispatcher& d)
+        : m_pdispatcher(&d)
+		{
+			;
+		}
+        
+		dispatcher* m_pdispatcher;
+	};
+    
+	// Passed as the last argument of connect() to make a coalesced
+	// connection, for a slot that only needs the latest of a signal's
+	// values. Each emit overwrites the connection's copy of the arguments,
+	// and at most one call is queued on the dispatcher at a time, so the
+	// slot runs with the latest value as often as the dispatcher's thread
+	// calls dispatch(), however often the signal is emitted. With an
+	// interval, the slot also runs at most once per interval; a value that
+	// arrives sooner waits for the first dispatch() after the interval,
+	// which the dispatcher's next_deadline() reports.
+	// Otherwise coalesced_on behaves as queued_on does.
+	class coalesced_on
+	{
+	public:
+		coalesced_on()
+        : m_pdispatcher(NULL), m_interval(0)
+		{
+			;
+		}
+        
+		explicit coalesced_on(dispatcher& d)
+        : m_pdispatcher(&d), m_interval(0)
+		{
+			;
+		}
+        
+		template<class rep, class period>
+		coalesced_on(dispatcher& d, std::chrono::duration<rep, period> interval)
+        : m_pdispatcher(&d), m_interval(std::chrono::duration_cast<std::chrono::steady_clock::duration>(interval))
+		{
+			;
+		}
+        
+		dispatcher* m_pdispatcher;
+		std::chrono::steady_clock::duration m_interval;
+	};
+    
+	// Shared by a queued connection and the events it has posted. It counts
+	// references from both, and separately the connection objects alive;
+	// when the last of those goes, the events still queued are dropped.
+	class _queued_state
+	{
+	public:
+		_queued_state()
+        : m_refs(1), m_connections(1)
+		{
+			;
+		}
+        
+		virtual ~_queued_state()
+		{
+			;
+		}
+        
+		void add_ref()
+		{
+			_atomic_add(&m_refs, 1);
+		}
+        
+		void release()
+		{
+			if(_atomic_add(&m_refs, -1) == 0)
 			{
-				(*it)->getdest()->signal_disconnect(this);
-				delete *it;
-                
-				++it;
+				delete this;
+			}
+		}
+        
+		void add_connection()
+		{
+			_atomic_add(&m_connections, 1);
+			add_ref();
+		}
+        
+		void release_connection()
+		{
+			_atomic_add(&m_connections, -1);
+			release();
+		}
+        
+		bool connected()
+		{
+			return _atomic_load(&m_connections) != 0;
+		}
+        
+	private:
+		volatile long m_refs;
+		volatile long m_connections;
+	};
+    
+	// The receiver and slot of a queued connection, kept with its state so
+	// that the events it posts need only this and their arguments.
+	template<class... arg_types>
+	class _queued_target : public _queued_state
+	{
+	public:
+		typedef std::tuple<typename std::decay<arg_types>::type...> args_type;
+        
+		// Each stored argument is used once, so it is moved into the slot
+		// unless the slot takes it by reference.
+		virtual void call_once(args_type& args) = 0;
+        
+		// Passes the arguments as they are stored, for a batch that hands
+		// the same copy to several slots. A slot that takes one by
+		// reference sees what the slots before it did to it.
+		virtual void call_shared(args_type& args) = 0;
+	};
+    
+	template<class dest_type, class... arg_types>
+	class _queued_member : public _queued_target<arg_types...>
+	{
+	public:
+		typedef typename _queued_target<arg_types...>::args_type args_type;
+        
+		_queued_member(dest_type* pobject, void (dest_type::*pmemfun)(arg_types...))
+        : m_pobject(pobject), m_pmemfun(pmemfun)
+		{
+			;
+		}
+        
+		virtual void call_once(args_type& args)
+		{
+			call_moved(args, typename _make_index_list<sizeof...(arg_types)>::type());
+		}
+        
+		virtual void call_shared(args_type& args)
+		{
+			call_lvalues(args, typename _make_index_list<sizeof...(arg_types)>::type());
+		}
+        
+	protected:
+		template<size_t... indices>
+		void call_moved(args_type& args, _index_list<indices...>)
+		{
+			(m_pobject->*m_pmemfun)(static_cast<arg_types&&>(std::get<indices>(args))...);
+		}
+        
+		template<size_t... indices>
+		void call_lvalues(args_type& args, _index_list<indices...>)
+		{
+			(m_pobject->*m_pmemfun)(std::get<indices>(args)...);
+		}
+        
+		dest_type* m_pobject;
+		void (dest_type::* m_pmemfun)(arg_types...);
+	};
+    
+	template<class... arg_types>
+	class _queued_call : public _queued_event
+	{
+	public:
+		template<class... param_types>
+		_queued_call(_queued_target<arg_types...>* ptarget, param_types&... args)
+        : m_ptarget(ptarget), m_args(args...)
+		{
+			m_ptarget->add_ref();
+		}
+        
+		~_queued_call()
+		{
+			m_ptarget->release();
+		}
+        
+		virtual void run()
+		{
+			if(m_ptarget->connected())
+			{
+				m_ptarget->call_once(m_args);
 			}
+		}
+        
+	private:
+		_queued_target<arg_types...>* m_ptarget;
+		typename _queued_target<arg_types...>::args_type m_args;
+	};
+    
+	// The calls of one emit_routed() to the queued connections on one
+	// dispatcher, posted as a single event that holds a single copy of the
+	// arguments. Its slots run in the order the signal keeps them. The
+	// first target is kept inline, as a dispatcher often has just one.
+	template<class... arg_types>
+	class _routed_batch : public _queued_event
+	{
+	public:
+		typedef _queued_target<arg_types...> target_type;
+        
+		template<class args_tuple>
+		_routed_batch(const args_tuple& args, target_type* pfirst)
+        : m_args(args), m_pfirst(pfirst)
+		{
+			m_pfirst->add_ref();
+		}
+        
+		~_routed_batch()
+		{
+			m_pfirst->release();
             
-			m_connected_slots.erase(m_connected_slots.begin(), m_connected_slots.end());
+			for(size_t i = 0; i < m_rest.size(); ++i)
+			{
+				m_rest[i]->release();
+			}
 		}
         
-		void disconnect(has_slots<mt_policy>* pclass)
+		void add(target_type* ptarget)
 		{
-			lock_block<mt_policy> lock(this);
-			iterator it = m_connected_slots.begin();
-			iterator itEnd = m_connected_slots.end();
+			ptarget->add_ref();
+			m_rest.push_back(ptarget);
+		}
+        
+		virtual void run()
+		{
+			call(m_pfirst);
             
-			while(it != itEnd)
+			for(size_t i = 0; i < m_rest.size(); ++i)
 			{
-				if((*it)->getdest() == pclass)
-				{
-					delete *it;
-					m_connected_slots.erase(it);
-					pclass->signal_disconnect(this);
-					return;
-				}
-                
-				++it;
+				call(m_rest[i]);
 			}
 		}
         
-		void slot_disconnect(has_slots<mt_policy>* pslot)
+	private:
+		void call(target_type* ptarget)
 		{
-			lock_block<mt_policy> lock(this);
-			iterator it = m_connected_slots.begin();
-			iterator itEnd = m_connected_slots.end();
+			if(ptarget->connected())
+			{
+				ptarget->call_shared(m_args);
+			}
+		}
+        
+		typename target_type::args_type m_args;
+		target_type* m_pfirst;
+		std::vector<target_type*> m_rest;
+	};
+    
+	// Sorts the queued calls of one emit_routed() into a batch for each
+	// dispatcher, and posts the batches once the signal has been walked.
+	// There are seldom more than a few dispatchers, so they are searched,
+	// and the first few are kept without allocating.
+	template<class... arg_types>
+	class _routing
+	{
+	public:
+		typedef _routed_batch<arg_types...> batch_type;
+		typedef std::pair<dispatcher*, batch_type*> route_type;
+        
+		_routing(typename _param<arg_types>::type... args)
+        : m_args(args...), m_inline_count(0)
+		{
+			;
+		}
+        
+		~_routing()
+		{
+			post();
+		}
+        
+		void add(dispatcher* pdispatcher, _queued_target<arg_types...>* ptarget)
+		{
+			for(size_t i = 0; i < m_inline_count; ++i)
+			{
+				if(m_inline[i].first == pdispatcher)
+				{
+					m_inline[i].second->add(ptarget);
+					return;
+				}
+			}
             
-			while(it != itEnd)
+			for(size_t i = 0; i < m_overflow.size(); ++i)
 			{
-				iterator itNext = it;
-				++itNext;
-                
-				if((*it)->getdest() == pslot)
+				if(m_overflow[i].first == pdispatcher)
 				{
-                    delete *it;
-					m_connected_slots.erase(it);
+					m_overflow[i].second->add(ptarget);
+					return;
 				}
-                
-				it = itNext;
+			}
+            
+			route_type route(pdispatcher, new batch_type(m_args, ptarget));
+            
+			if(m_inline_count < inline_routes)
+			{
+				m_inline[m_inline_count++] = route;
+			}
+			else
+			{
+				m_overflow.push_back(route);
 			}
 		}
         
-		void slot_duplicate(const has_slots<mt_policy>* oldtarget, has_slots<mt_policy>* newtarget)
+		void post()
 		{
-			lock_block<mt_policy> lock(this);
-			iterator it = m_connected_slots.begin();
-			iterator itEnd = m_connected_slots.end();
+			for(size_t i = 0; i < m_inline_count; ++i)
+			{
+				m_inline[i].first->post(m_inline[i].second);
+			}
             
-			while(it != itEnd)
+			for(size_t i = 0; i < m_overflow.size(); ++i)
 			{
-				if((*it)->getdest() == oldtarget)
-				{
-					m_connected_slots.push_back((*it)->duplicate(newtarget));
-				}
-                
-				++it;
+				m_overflow[i].first->post(m_overflow[i].second);
 			}
+            
+			m_inline_count = 0;
+			m_overflow.clear();
 		}
         
-	protected:
-		connections_list m_connected_slots;   
+	private:
+		enum { inline_routes = 4 };
+        
+		_routing(const _routing&);
+		_routing& operator=(const _routing&);
+        
+		std::tuple<typename _param<arg_types>::type...> m_args;
+		route_type m_inline[inline_routes];
+		size_t m_inline_count;
+		std::vector<route_type> m_overflow;
 	};
     
-	template<class arg1_type, class mt_policy>
-	class _signal_base1 : public _signal_base<mt_policy>
+	// Copying or cloning the connection into new storage shares the state
+	// with the original; clone() and duplicate(), which make a separate
+	// connection, start a new one.
+	template<class dest_type, class mt_policy, class... arg_types>
+	class _queued_connection : public _connection_base<mt_policy, arg_types...>
 	{
 	public:
-		typedef typename std::list<_connection_base1<arg1_type, mt_policy> *>  connections_list;
-		typedef typename connections_list::const_iterator const_iterator;
-		typedef typename connections_list::iterator iterator;
+		typedef _connection_base<mt_policy, arg_types...> base_type;
         
-		_signal_base1()
+		_queued_connection(dest_type* pobject, void (dest_type::*pmemfun)(arg_types...), dispatcher* pdispatcher)
+        : base_type(&emit_queued), m_pobject(pobject), m_pmemfun(pmemfun), m_pdispatcher(pdispatcher),
+		m_pstate(new _queued_member<dest_type, arg_types...>(pobject, pmemfun))
 		{
 			;
 		}
         
-		_signal_base1(const _signal_base1<arg1_type, mt_policy>& s)
-        : _signal_base<mt_policy>(s)
+		_queued_connection(const _queued_connection& conn)
+        : base_type(conn), m_pobject(conn.m_pobject), m_pmemfun(conn.m_pmemfun),
+		m_pdispatcher(conn.m_pdispatcher), m_pstate(conn.m_pstate)
 		{
-			lock_block<mt_policy> lock(this);
-			const_iterator it = s.m_connected_slots.begin();
-			const_iterator itEnd = s.m_connected_slots.end();
+			m_pstate->add_connection();
+		}
+        
+		~_queued_connection()
+		{
+			m_pstate->release_connection();
+		}
+        
+		virtual base_type* clone()
+		{
+			return new _queued_connection(m_pobject, m_pmemfun, m_pdispatcher);
+		}
+        
+		virtual base_type* clone_at(void* pmem)
+		{
+			return new(pmem) _queued_connection(*this);
+		}
+        
+		virtual base_type* duplicate(has_slots<mt_policy>* pnewdest)
+		{
+			return new _queued_connection((dest_type *)pnewdest, m_pmemfun, m_pdispatcher);
+		}
+        
+		// Calls already queued were made for the old address, so they are
+		// dropped along with the old state.
+		virtual void retarget(has_slots<mt_policy>* pnewdest)
+		{
+			m_pobject = (dest_type *)pnewdest;
+			m_pstate->release_connection();
+			m_pstate = new _queued_member<dest_type, arg_types...>(m_pobject, m_pmemfun);
+		}
+        
+		virtual has_slots<mt_policy>* getdest() const
+		{
+			return m_pobject;
+		}
+        
+		virtual bool route(_routing<arg_types...>& routing)
+		{
+			routing.add(m_pdispatcher, m_pstate);
+			return true;
+		}
+        
+	private:
+		_queued_connection& operator=(const _queued_connection&);
+        
+		static void emit_queued(base_type* pconn, typename _param<arg_types>::type... args)
+		{
+			_queued_connection* pself = static_cast<_queued_connection*>(pconn);
+			pself->m_pdispatcher->post(new _queued_call<arg_types...>(pself->m_pstate, args...));
+		}
+        
+		dest_type* m_pobject;
+		void (dest_type::* m_pmemfun)(arg_types...);
+		dispatcher* m_pdispatcher;
+		_queued_target<arg_types...>* m_pstate;
+	};
+    
+	// The latest arguments of a coalesced connection, and the one call that
+	// delivers them. Emits on any thread store into m_latest; the call,
+	// on the dispatcher's thread, swaps it with m_delivered under the lock
+	// and runs the slot on m_delivered, so each buffer keeps its capacity
+	// from one value to the next. The queued call holds a reference.
+	// store() runs inside emit(), under the signal's lock, so m_lock is a
+	// _leaf_lock rather than another mt_policy.
+	template<class dest_type, class mt_policy, class... arg_types>
+	class _coalesced_member : public _queued_member<dest_type, arg_types...>
+	{
+	public:
+		typedef typename _queued_member<dest_type, arg_types...>::args_type args_type;
+        
+		_coalesced_member(dest_type* pobject, void (dest_type::*pmemfun)(arg_types...), dispatcher* pdispatcher,
+			std::chrono::steady_clock::duration interval)
+        : _queued_member<dest_type, arg_types...>(pobject, pmemfun), m_pdispatcher(pdispatcher),
+		m_interval(interval), m_last(std::chrono::steady_clock::now() - interval), m_delivery(this), m_posted(false)
+		{
+			;
+		}
+        
+		// A new state with the same slot, dispatcher and interval.
+		_coalesced_member* fresh(dest_type* pobject) const
+		{
+			return new _coalesced_member(pobject, this->m_pmemfun, m_pdispatcher, m_interval);
+		}
+        
+		void store(typename _param<arg_types>::type... args)
+		{
+			bool post;
             
-			while(it != itEnd)
 			{
-				(*it)->getdest()->signal_connect(this);
-				m_connected_slots.push_back((*it)->clone());
-                
-				++it;
+				lock_block<lock_type> lock(&m_lock);
+				m_latest = std::tuple<typename _param<arg_types>::type...>(args...);
+				post = !m_posted;
+				m_posted = true;
+			}
+            
+			if(post)
+			{
+				this->add_ref();
+				m_pdispatcher->post(&m_delivery);
 			}
 		}
         
-		void slot_duplicate(const has_slots<mt_policy>* oldtarget, has_slots<mt_policy>* newtarget)
+	private:
+		typedef typename _leaf_lock<mt_policy>::type lock_type;
+        
+		class delivery : public _queued_event
 		{
-			lock_block<mt_policy> lock(this);
-			iterator it = m_connected_slots.begin();
-			iterator itEnd = m_connected_slots.end();
+		public:
+			explicit delivery(_coalesced_member* powner)
+            : m_powner(powner)
+			{
+				this->m_owned = false;
+			}
             
-			while(it != itEnd)
+			virtual void run()
+			{
+				m_powner->deliver();
+			}
+            
+			virtual void dropped()
+			{
+				m_powner->release();
+			}
+            
+		private:
+			_coalesced_member* m_powner;
+		};
+        
+		void deliver()
+		{
+			if(!this->connected())
+			{
+				this->release();
+				return;
+			}
+            
+			if(m_interval != std::chrono::steady_clock::duration::zero())
 			{
-				if((*it)->getdest() == oldtarget)
+				std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+                
+				if(now - m_last < m_interval)
 				{
-					m_connected_slots.push_back((*it)->duplicate(newtarget));
+					m_pdispatcher->defer(&m_delivery, m_last + m_interval);
+					return;
 				}
                 
-				++it;
+				m_last = now;
+			}
+            
+			{
+				lock_block<lock_type> lock(&m_lock);
+				std::swap(m_latest, m_delivered);
+				m_posted = false;
 			}
+            
+			this->call_shared(m_delivered);
+			this->release();
+		}
+        
+		dispatcher* m_pdispatcher;
+		std::chrono::steady_clock::duration m_interval;
+		std::chrono::steady_clock::time_point m_last;
+		delivery m_delivery;
+		lock_type m_lock;
+		args_type m_latest;
+		args_type m_delivered;
+		bool m_posted;
+	};
+    
+	// Made by connect() with coalesced_on. The slot, dispatcher and
+	// interval are kept in the state, which is shared with copies as
+	// _queued_connection's is, to fit a vector_storage cell. emit_routed()
+	// treats it as a direct connection, since its calls are never batched.
+	template<class dest_type, class mt_policy, class... arg_types>
+	class _coalesced_connection : public _connection_base<mt_policy, arg_types...>
+	{
+	public:
+		typedef _connection_base<mt_policy, arg_types...> base_type;
+		typedef _coalesced_member<dest_type, mt_policy, arg_types...> state_type;
+        
+		_coalesced_connection(dest_type* pobject, void (dest_type::*pmemfun)(arg_types...), dispatcher* pdispatcher,
+			std::chrono::steady_clock::duration interval)
+        : base_type(&emit_coalesced), m_pobject(pobject),
+		m_pstate(new state_type(pobject, pmemfun, pdispatcher, interval))
+		{
+			;
 		}
         
-		~_signal_base1()
+		_coalesced_connection(const _coalesced_connection& conn)
+        : base_type(conn), m_pobject(conn.m_pobject), m_pstate(conn.m_pstate)
 		{
-			disconnect_all();
+			m_pstate->add_connection();
+		}
+        
+		~_coalesced_connection()
+		{
+			m_pstate->release_connection();
+		}
+        
+		virtual base_type* clone()
+		{
+			return new _coalesced_connection(m_pobject, m_pstate->fresh(m_pobject));
+		}
+        
+		virtual base_type* clone_at(void* pmem)
+		{
+			return new(pmem) _coalesced_connection(*this);
+		}
+        
+		virtual base_type* duplicate(has_slots<mt_policy>* pnewdest)
+		{
+			return new _coalesced_connection((dest_type *)pnewdest, m_pstate->fresh((dest_type *)pnewdest));
+		}
+        
+		virtual void retarget(has_slots<mt_policy>* pnewdest)
+		{
+			state_type* pstate = m_pstate->fresh((dest_type *)pnewdest);
+			m_pobject = (dest_type *)pnewdest;
+			m_pstate->release_connection();
+			m_pstate = pstate;
 		}
         
-		void disconnect_all()
+		virtual has_slots<mt_policy>* getdest() const
 		{
-			lock_block<mt_policy> lock(this);
-			const_iterator it = m_connected_slots.begin();
-			const_iterator itEnd = m_connected_slots.end();
-            
-			while(it != itEnd)
-			{
-				(*it)->getdest()->signal_disconnect(this);
-				delete *it;
-                
-				++it;
-			}
-            
-			m_connected_slots.erase(m_connected_slots.begin(), m_connected_slots.end());
+			return m_pobject;
 		}
         
-		void disconnect(has_slots<mt_policy>* pclass)
+	private:
+		_coalesced_connection(dest_type* pobject, state_type* pstate)
+        : base_type(&emit_coalesced), m_pobject(pobject), m_pstate(pstate)
 		{
-			lock_block<mt_policy> lock(this);
-			iterator it = m_connected_slots.begin();
-			iterator itEnd = m_connected_slots.end();
-            
-			while(it != itEnd)
-			{
-				if((*it)->getdest() == pclass)
-				{
-					delete *it;
-					m_connected_slots.erase(it);
-					pclass->signal_disconnect(this);
-					return;
-				}
-                
-				++it;
-			}
+			;
 		}
         
-		void slot_disconnect(has_slots<mt_policy>* pslot)
+		_coalesced_connection& operator=(const _coalesced_connection&);
+        
+		static void emit_coalesced(base_type* pconn, typename _param<arg_types>::type... args)
 		{
-			lock_block<mt_policy> lock(this);
-			iterator it = m_connected_slots.begin();
-			iterator itEnd = m_connected_slots.end();
-            
-			while(it != itEnd)
-			{
-				iterator itNext = it;
-				++itNext;
-                
-				if((*it)->getdest() == pslot)
-				{
-                    delete *it;
-					m_connected_slots.erase(it);
-				}
-                
-				it = itNext;
-			}
+			static_cast<_coalesced_connection*>(pconn)->m_pstate->store(args...);
 		}
         
-        
-	protected:
-		connections_list m_connected_slots;   
+		dest_type* m_pobject;
+		state_type* m_pstate;
 	};
     
-	template<class arg1_type, class arg2_type, class mt_policy>
-	class _signal_base2 : public _signal_base<mt_policy>
+	// Runs the chunks of a parallel job, for basic_signal::emit_parallel().
+	// Derive from it to run them on a scheduler of your own; thread_pool is
+	// the one the library provides.
+	class parallel_executor
 	{
 	public:
-		typedef typename std::list<_connection_base2<arg1_type, arg2_type, mt_policy> *>
-        connections_list;
-        typedef typename connections_list::const_iterator const_iterator;
-        typedef typename connections_list::iterator iterator;
+		typedef void (*task_type)(void* pcontext, size_t chunk);
         
-		_signal_base2()
+		virtual ~parallel_executor()
 		{
 			;
 		}
         
-		_signal_base2(const _signal_base2<arg1_type, arg2_type, mt_policy>& s)
-        : _signal_base<mt_policy>(s)
+		// How many threads run() spreads a job over, counting its caller.
+		virtual size_t concurrency() const = 0;
+        
+		// Calls ptask(pcontext, chunk) once for every chunk below chunks, in
+		// any order and on any threads, and returns when all have finished.
+		virtual void run(task_type ptask, void* pcontext, size_t chunks) = 0;
+	};
+    
+#ifndef _SIGSLOT_SINGLE_THREADED
+	// A fixed set of worker threads. The thread calling run() works on the
+	// job as well, and every thread takes the next unclaimed chunk as it
+	// finishes one, so uneven slots balance out without a queue per
+	// thread. A run() that arrives while another is in progress, including
+	// one from inside a chunk, runs its chunks on the calling thread.
+	class thread_pool : public parallel_executor
+	{
+	public:
+		// threads counts the thread calling run(); 0 means one per processor.
+		explicit thread_pool(size_t threads = 0)
+        : m_ptask(NULL), m_pcontext(NULL), m_chunks(0), m_next_chunk(0),
+		m_busy(0), m_job(0), m_running(false), m_stopping(false)
 		{
-			lock_block<mt_policy> lock(this);
-			const_iterator it = s.m_connected_slots.begin();
-			const_iterator itEnd = s.m_connected_slots.end();
+			if(threads == 0)
+			{
+				threads = _hardware_threads();
+			}
             
-			while(it != itEnd)
+			m_threads.reserve(threads - 1);
+            
+			for(size_t i = 1; i < threads; ++i)
 			{
-				(*it)->getdest()->signal_connect(this);
-				m_connected_slots.push_back((*it)->clone());
+				_pool_thread thread;
                 
-				++it;
+				if(!_pool_thread_start(&thread, this))
+				{
+					break;
+				}
+                
+				m_threads.push_back(thread);
 			}
 		}
         
-		void slot_duplicate(const has_slots<mt_policy>* oldtarget, has_slots<mt_policy>* newtarget)
+		~thread_pool()
 		{
-			lock_block<mt_policy> lock(this);
-			iterator it = m_connected_slots.begin();
-			iterator itEnd = m_connected_slots.end();
+			m_sync.lock();
+			m_stopping = true;
+			m_sync.wake_all();
+			m_sync.unlock();
             
-			while(it != itEnd)
+			for(size_t i = 0; i < m_threads.size(); ++i)
 			{
-				if((*it)->getdest() == oldtarget)
-				{
-					m_connected_slots.push_back((*it)->duplicate(newtarget));
-				}
-                
-				++it;
+				_pool_thread_join(m_threads[i]);
 			}
 		}
         
-		~_signal_base2()
+		virtual size_t concurrency() const
 		{
-			disconnect_all();
+			return m_threads.size() + 1;
 		}
         
-		void disconnect_all()
+		virtual void run(task_type ptask, void* pcontext, size_t chunks)
 		{
-			lock_block<mt_policy> lock(this);
-			const_iterator it = m_connected_slots.begin();
-			const_iterator itEnd = m_connected_slots.end();
+			m_sync.lock();
             
-			while(it != itEnd)
+			if(m_running || m_threads.empty() || chunks < 2)
 			{
-				(*it)->getdest()->signal_disconnect(this);
-				delete *it;
+				m_sync.unlock();
                 
-				++it;
+				for(size_t chunk = 0; chunk < chunks; ++chunk)
+				{
+					ptask(pcontext, chunk);
+				}
+                
+				return;
+			}
+            
+			m_running = true;
+			m_ptask = ptask;
+			m_pcontext = pcontext;
+			m_chunks = long(chunks);
+			m_next_chunk = 0;
+			m_busy = m_threads.size();
+			++m_job;
+			m_sync.wake_all();
+			m_sync.unlock();
+            
+			work();
+            
+			m_sync.lock();
+            
+			while(m_busy != 0)
+			{
+				m_sync.wait();
 			}
             
-			m_connected_slots.erase(m_connected_slots.begin(), m_connected_slots.end());
+			m_running = false;
+			m_sync.unlock();
 		}
         
-		void disconnect(has_slots<mt_policy>* pclass)
+	private:
+		thread_pool(const thread_pool&);
+		thread_pool& operator=(const thread_pool&);
+        
+		friend void _thread_pool_worker(void* ppool);
+        
+		void work()
 		{
-			lock_block<mt_policy> lock(this);
-			iterator it = m_connected_slots.begin();
-			iterator itEnd = m_connected_slots.end();
+			long chunk;
             
-			while(it != itEnd)
+			while((chunk = _atomic_add(&m_next_chunk, 1) - 1) < m_chunks)
 			{
-				if((*it)->getdest() == pclass)
-				{
-					delete *it;
-					m_connected_slots.erase(it);
-					pclass->signal_disconnect(this);
-					return;
-				}
-                
-				++it;
+				m_ptask(m_pcontext, size_t(chunk));
 			}
 		}
         
-		void slot_disconnect(has_slots<mt_policy>* pslot)
+		void worker()
 		{
-			lock_block<mt_policy> lock(this);
-			iterator it = m_connected_slots.begin();
-			iterator itEnd = m_connected_slots.end();
+			unsigned long job = 0;
+			m_sync.lock();
             
-			while(it != itEnd)
+			for(;;)
 			{
-				iterator itNext = it;
-				++itNext;
+				while(!m_stopping && m_job == job)
+				{
+					m_sync.wait();
+				}
                 
-				if((*it)->getdest() == pslot)
+				if(m_stopping)
 				{
-                    delete *it;
-					m_connected_slots.erase(it);
+					break;
 				}
                 
-				it = itNext;
+				job = m_job;
+				m_sync.unlock();
+				work();
+				m_sync.lock();
+                
+				if(--m_busy == 0)
+				{
+					m_sync.wake_all();
+				}
 			}
-		}
-        
-	protected:
-		connections_list m_connected_slots;   
+            
+			m_sync.unlock();
+		}
+        
+		std::vector<_pool_thread> m_threads;
+		_pool_sync m_sync;
+		task_type m_ptask;
+		void* m_pcontext;
+		long m_chunks;
+		volatile long m_next_chunk;
+		size_t m_busy;
+		unsigned long m_job;
+		bool m_running;
+		bool m_stopping;
 	};
     
-	template<class arg1_type, class arg2_type, class arg3_type, class mt_policy>
-	class _signal_base3 : public _signal_base<mt_policy>
+	inline void _thread_pool_worker(void* ppool)
+	{
+		static_cast<thread_pool*>(ppool)->worker();
+	}
+#endif // _SIGSLOT_SINGLE_THREADED
+    
+	// One emit_parallel() call: the connections it found and the arguments,
+	// handed out to the executor in contiguous chunks.
+	template<class conn_type, class... arg_types>
+	class _parallel_emit
 	{
 	public:
-		typedef std::list<_connection_base3<arg1_type, arg2_type, arg3_type, mt_policy> *>
-        connections_list;
+		typedef std::vector<conn_type*, SIGSLOT_ALLOCATOR<conn_type*> > conn_list;
         
-        typedef typename connections_list::const_iterator const_iterator;
-        typedef typename connections_list::iterator iterator;
-		_signal_base3()
+		_parallel_emit(typename _param<arg_types>::type... args)
+        : m_args(args...), m_chunk_size(1), m_pjob(NULL)
 		{
 			;
 		}
         
-		_signal_base3(const _signal_base3<arg1_type, arg2_type, arg3_type, mt_policy>& s)
-        : _signal_base<mt_policy>(s)
+		void add(conn_type* pconn)
 		{
-			lock_block<mt_policy> lock(this);
-			const_iterator it = s.m_connected_slots.begin();
-			const_iterator itEnd = s.m_connected_slots.end();
-            
-			while(it != itEnd)
-			{
-				(*it)->getdest()->signal_connect(this);
-				m_connected_slots.push_back((*it)->clone());
-                
-				++it;
-			}
+			m_conns.push_back(pconn);
 		}
         
-		void slot_duplicate(const has_slots<mt_policy>* oldtarget, has_slots<mt_policy>* newtarget)
+		// pjob is what the threads running the chunks find in
+		// _current_job() meanwhile.
+		void run(parallel_executor& executor, void* pjob)
 		{
-			lock_block<mt_policy> lock(this);
-			iterator it = m_connected_slots.begin();
-			iterator itEnd = m_connected_slots.end();
+			size_t count = m_conns.size();
+			m_pjob = pjob;
+			size_t chunks = executor.concurrency() * chunks_per_thread;
             
-			while(it != itEnd)
+			if(count == 0)
 			{
-				if((*it)->getdest() == oldtarget)
-				{
-					m_connected_slots.push_back((*it)->duplicate(newtarget));
-				}
-                
-				++it;
+				return;
+			}
+            
+			if(chunks > count)
+			{
+				chunks = count;
 			}
+            
+			m_chunk_size = (count + chunks - 1) / chunks;
+			executor.run(&run_chunk, this, (count + m_chunk_size - 1) / m_chunk_size);
 		}
         
-		~_signal_base3()
-		{
-			disconnect_all();
-		}
+	private:
+		// More chunks than threads, so that a thread held up by slow slots
+		// leaves work for the others rather than the caller waiting on it.
+		enum { chunks_per_thread = 4 };
         
-		void disconnect_all()
+		static void run_chunk(void* pcontext, size_t chunk)
 		{
-			lock_block<mt_policy> lock(this);
-			const_iterator it = m_connected_slots.begin();
-			const_iterator itEnd = m_connected_slots.end();
+			_parallel_emit* pself = static_cast<_parallel_emit*>(pcontext);
+			size_t begin = chunk * pself->m_chunk_size;
+			size_t end = begin + pself->m_chunk_size;
             
-			while(it != itEnd)
+			if(end > pself->m_conns.size())
 			{
-				(*it)->getdest()->signal_disconnect(this);
-				delete *it;
-                
-				++it;
+				end = pself->m_conns.size();
 			}
             
-			m_connected_slots.erase(m_connected_slots.begin(), m_connected_slots.end());
-		}
-        
-		void disconnect(has_slots<mt_policy>* pclass)
-		{
-			lock_block<mt_policy> lock(this);
-			iterator it = m_connected_slots.begin();
-			iterator itEnd = m_connected_slots.end();
+			void* pouter = _current_job();
+			_current_job() = pself->m_pjob;
             
-			while(it != itEnd)
+			for(size_t i = begin; i < end; ++i)
 			{
-				if((*it)->getdest() == pclass)
-				{
-					delete *it;
-					m_connected_slots.erase(it);
-					pclass->signal_disconnect(this);
-					return;
-				}
-                
-				++it;
+				pself->emit(pself->m_conns[i], typename _make_index_list<sizeof...(arg_types)>::type());
 			}
+            
+			_current_job() = pouter;
 		}
         
-		void slot_disconnect(has_slots<mt_policy>* pslot)
+		template<size_t... indices>
+		void emit(conn_type* pconn, _index_list<indices...>)
 		{
-			lock_block<mt_policy> lock(this);
-			iterator it = m_connected_slots.begin();
-			iterator itEnd = m_connected_slots.end();
-            
-			while(it != itEnd)
-			{
-				iterator itNext = it;
-				++itNext;
-                
-				if((*it)->getdest() == pslot)
-				{
-                    delete *it;
-					m_connected_slots.erase(it);
-				}
-                
-				it = itNext;
-			}
+			pconn->emit(std::get<indices>(m_args)...);
 		}
         
-	protected:
-		connections_list m_connected_slots;   
+		std::tuple<typename _param<arg_types>::type...> m_args;
+		conn_list m_conns;
+		size_t m_chunk_size;
+		void* m_pjob;
+	};
+    
+	// A coroutine waiting for a signal's next emit; see next(). It lives
+	// in the coroutine's frame, and is linked into the signal's list of
+	// waiters while it waits. An emit unlinks all of them under the lock,
+	// and wakes each once the slots have run and the lock is released,
+	// with wake() or, when the signal is destroyed or disconnect_all() is
+	// called, with cancel().
+	template<class... arg_types>
+	class _signal_waiter : public _queued_event
+	{
+	public:
+		_signal_waiter()
+        : m_pprev_waiter(NULL), m_pnext_waiter(NULL), m_linked(false)
+		{
+			this->m_owned = false;
+		}
+        
+		virtual void wake(typename _param<arg_types>::type... args) = 0;
+		virtual void cancel() = 0;
+        
+		_signal_waiter* m_pprev_waiter;
+		_signal_waiter* m_pnext_waiter;
+		bool m_linked;
 	};
     
-	template<class arg1_type, class arg2_type, class arg3_type, class arg4_type, class mt_policy>
-	class _signal_base4 : public _signal_base<mt_policy>
+#ifdef __cpp_impl_coroutine
+	// What co_await signal.next() waits on. Nothing is allocated: the
+	// awaiter is the waiter, and with a dispatcher it is also the event
+	// that resumes the coroutine on the dispatcher's thread.
+	template<class body_type, class... arg_types>
+	class _signal_awaiter : public _signal_waiter<arg_types...>
 	{
 	public:
-		typedef std::list<_connection_base4<arg1_type, arg2_type, arg3_type,
-        arg4_type, mt_policy> *>  connections_list;
-        typedef typename connections_list::const_iterator const_iterator;
-        typedef typename connections_list::iterator iterator;
+		typedef std::tuple<typename std::decay<arg_types>::type...> event_type;
         
-		_signal_base4()
+		_signal_awaiter(body_type* pbody, dispatcher* pdispatcher)
+        : m_pbody(pbody), m_pdispatcher(pdispatcher)
 		{
 			;
 		}
         
-		_signal_base4(const _signal_base4<arg1_type, arg2_type, arg3_type, arg4_type, mt_policy>& s)
-        : _signal_base<mt_policy>(s)
+		// A coroutine destroyed while it waits leaves the signal's list.
+		~_signal_awaiter()
 		{
-			lock_block<mt_policy> lock(this);
-			const_iterator it = s.m_connected_slots.begin();
-			const_iterator itEnd = s.m_connected_slots.end();
-            
-			while(it != itEnd)
+			if(this->m_linked)
 			{
-				(*it)->getdest()->signal_connect(this);
-				m_connected_slots.push_back((*it)->clone());
-                
-				++it;
+				m_pbody->remove_waiter(this);
 			}
 		}
         
-		void slot_duplicate(const has_slots<mt_policy>* oldtarget, has_slots<mt_policy>* newtarget)
+		bool await_ready() const noexcept
 		{
-			lock_block<mt_policy> lock(this);
-			iterator it = m_connected_slots.begin();
-			iterator itEnd = m_connected_slots.end();
-            
-			while(it != itEnd)
-			{
-				if((*it)->getdest() == oldtarget)
-				{
-					m_connected_slots.push_back((*it)->duplicate(newtarget));
-				}
-                
-				++it;
-			}
+			return false;
 		}
         
-		~_signal_base4()
+		void await_suspend(std::coroutine_handle<> handle)
 		{
-			disconnect_all();
+			m_handle = handle;
+			m_pbody->add_waiter(this);
 		}
         
-		void disconnect_all()
+		std::optional<event_type> await_resume()
 		{
-			lock_block<mt_policy> lock(this);
-			const_iterator it = m_connected_slots.begin();
-			const_iterator itEnd = m_connected_slots.end();
-            
-			while(it != itEnd)
-			{
-				(*it)->getdest()->signal_disconnect(this);
-				delete *it;
-                
-				++it;
-			}
-            
-			m_connected_slots.erase(m_connected_slots.begin(), m_connected_slots.end());
+			return std::move(m_value);
 		}
         
-		void disconnect(has_slots<mt_policy>* pclass)
+		virtual void wake(typename _param<arg_types>::type... args)
 		{
-			lock_block<mt_policy> lock(this);
-			iterator it = m_connected_slots.begin();
-			iterator itEnd = m_connected_slots.end();
-            
-			while(it != itEnd)
-			{
-				if((*it)->getdest() == pclass)
-				{
-					delete *it;
-					this->m_connected_slots.erase(it);
-					pclass->signal_disconnect(this);
-					return;
-				}
-                
-				++it;
-			}
+			m_value.emplace(args...);
+			resume();
 		}
         
-		void slot_disconnect(has_slots<mt_policy>* pslot)
+		virtual void cancel()
 		{
-			lock_block<mt_policy> lock(this);
-			iterator it = m_connected_slots.begin();
-			iterator itEnd = m_connected_slots.end();
-            
-			while(it != itEnd)
-			{
-				iterator itNext = it;
-				++itNext;
-                
-				if((*it)->getdest() == pslot)
-				{
-                    delete *it;
-					m_connected_slots.erase(it);
-				}
-                
-				it = itNext;
+			resume();
+		}
+        
+		virtual void run()
+		{
+			m_handle.resume();
+		}
+        
+	private:
+		_signal_awaiter(const _signal_awaiter&);
+		_signal_awaiter& operator=(const _signal_awaiter&);
+        
+		void resume()
+		{
+			if(m_pdispatcher != NULL)
+			{
+				m_pdispatcher->post(this);
+			}
+			else
+			{
+				m_handle.resume();
 			}
 		}
         
-	protected:
-		connections_list m_connected_slots;   
+		body_type* m_pbody;
+		dispatcher* m_pdispatcher;
+		std::coroutine_handle<> m_handle;
+		std::optional<event_type> m_value;
 	};
+#endif
     
-	template<class arg1_type, class arg2_type, class arg3_type, class arg4_type,
-	class arg5_type, class mt_policy>
-	class _signal_base5 : public _signal_base<mt_policy>
+	// What a basic_signal allocates when it is first connected to: its
+	// lock, its connections and their bookkeeping, and the code that emits
+	// them. Receivers link to this rather than to the basic_signal.
+	template<class mt_policy, class storage_policy, class... arg_types>
+	class _signal_body : public _signal_connections<_connection_base<mt_policy, arg_types...>, mt_policy, storage_policy>
 	{
 	public:
-		typedef std::list<_connection_base5<arg1_type, arg2_type, arg3_type,
-        arg4_type, arg5_type, mt_policy> *>  connections_list;
-        typedef typename connections_list::const_iterator const_iterator;
-        typedef typename connections_list::iterator iterator;
+		typedef _signal_connections<_connection_base<mt_policy, arg_types...>, mt_policy, storage_policy> base_type;
+		typedef typename base_type::connections_list connections_list;
+		typedef typename connections_list::const_iterator const_iterator;
+		typedef typename connections_list::emit_iterator emit_iterator;
+		typedef typename _connection_base<mt_policy, arg_types...>::event_type event_type;
+        
+		typedef _signal_waiter<arg_types...> waiter_type;
         
-		_signal_base5()
+	private:
+		typedef typename base_type::signal_lock signal_lock;
+		typedef typename base_type::emit_scope emit_scope;
+		typedef typename base_type::job_scope job_scope;
+        
+		// Adds a connection to a member function of a has_slots receiver,
+		// or of a has_weak_slots one, which only the signal's lock covers.
+		template<class desttype>
+		connection add_member(desttype* pclass, void (desttype::*pmemfun)(arg_types...), int priority, std::false_type)
 		{
-			;
+			return this->add_copy(_connection<desttype, mt_policy, arg_types...>(pclass, pmemfun), priority);
 		}
         
-		_signal_base5(const _signal_base5<arg1_type, arg2_type, arg3_type, arg4_type,
-                      arg5_type, mt_policy>& s)
-        : _signal_base<mt_policy>(s)
+		template<class desttype>
+		connection add_member(desttype* pclass, void (desttype::*pmemfun)(arg_types...), int priority, std::true_type)
 		{
-			lock_block<mt_policy> lock(this);
-			const_iterator it = s.m_connected_slots.begin();
-			const_iterator itEnd = s.m_connected_slots.end();
-            
-			while(it != itEnd)
-			{
-				(*it)->getdest()->signal_connect(this);
-				m_connected_slots.push_back((*it)->clone());
-                
-				++it;
-			}
+			this->count_weak_connect();
+			return this->add_copy(_weak_connection<desttype, mt_policy, arg_types...>(pclass, pmemfun), priority);
 		}
         
-		void slot_duplicate(const has_slots<mt_policy>* oldtarget, has_slots<mt_policy>* newtarget)
+	public:
+		_signal_body()
+        : m_pfirst_waiter(NULL), m_plast_waiter(NULL)
 		{
-			lock_block<mt_policy> lock(this);
-			iterator it = m_connected_slots.begin();
-			iterator itEnd = m_connected_slots.end();
-            
-			while(it != itEnd)
-			{
-				if((*it)->getdest() == oldtarget)
-				{
-					m_connected_slots.push_back((*it)->duplicate(newtarget));
-				}
-                
-				++it;
-			}
+			;
 		}
         
-		~_signal_base5()
+		// Waiting coroutines are not copied.
+		_signal_body(const _signal_body& s)
+        : base_type(s), m_pfirst_waiter(NULL), m_plast_waiter(NULL)
 		{
-			disconnect_all();
+			;
 		}
         
-		void disconnect_all()
+		virtual ~_signal_body()
 		{
-			lock_block<mt_policy> lock(this);
-			const_iterator it = m_connected_slots.begin();
-			const_iterator itEnd = m_connected_slots.end();
-            
-			while(it != itEnd)
-			{
-				(*it)->getdest()->signal_disconnect(this);
-				delete *it;
-                
-				++it;
-			}
-            
-			m_connected_slots.erase(m_connected_slots.begin(), m_connected_slots.end());
+			cancel_waiters();
 		}
         
-		void disconnect(has_slots<mt_policy>* pclass)
+		// Slots run in order of priority, highest first, and those of equal
+		// priority in the order they were connected.
+		template<class desttype>
+		connection connect(desttype* pclass, void (desttype::*pmemfun)(arg_types...), int priority = 0)
 		{
-			lock_block<mt_policy> lock(this);
-			iterator it = m_connected_slots.begin();
-			iterator itEnd = m_connected_slots.end();
-            
-			while(it != itEnd)
-			{
-				if((*it)->getdest() == pclass)
-				{
-					delete *it;
-					m_connected_slots.erase(it);
-					pclass->signal_disconnect(this);
-					return;
-				}
-                
-				++it;
-			}
+			signal_lock lock(this);
+			return add_member(pclass, pmemfun, priority, typename std::is_base_of<has_weak_slots, desttype>::type());
 		}
         
-		void slot_disconnect(has_slots<mt_policy>* pslot)
+		// Connects count receivers to the same member function, taking the
+		// signal's lock once and making room for them all first. The
+		// handles go to phandles, if given, in the order of pclasses.
+		template<class desttype>
+		void connect_many(desttype* const* pclasses, size_t count, void (desttype::*pmemfun)(arg_types...),
+			connection* phandles = NULL, int priority = 0)
 		{
-			lock_block<mt_policy> lock(this);
-			iterator it = m_connected_slots.begin();
-			iterator itEnd = m_connected_slots.end();
+			signal_lock lock(this);
+			typename base_type::change_batch batch(this, count);
             
-			while(it != itEnd)
+			for(size_t i = 0; i < count; ++i)
 			{
-				iterator itNext = it;
-				++itNext;
+				connection conn = add_member(pclasses[i], pmemfun, priority,
+					typename std::is_base_of<has_weak_slots, desttype>::type());
                 
-				if((*it)->getdest() == pslot)
+				if(phandles != NULL)
 				{
-                    delete *it;
-					m_connected_slots.erase(it);
+					phandles[i] = conn;
 				}
-                
-				it = itNext;
 			}
 		}
         
-	protected:
-		connections_list m_connected_slots;   
-	};
-    
-	template<class arg1_type, class arg2_type, class arg3_type, class arg4_type,
-	class arg5_type, class arg6_type, class mt_policy>
-	class _signal_base6 : public _signal_base<mt_policy>
-	{
-	public:
-		typedef std::list<_connection_base6<arg1_type, arg2_type, arg3_type, 
-        arg4_type, arg5_type, arg6_type, mt_policy> *>  connections_list;
-        typedef typename connections_list::const_iterator const_iterator;
-        typedef typename connections_list::iterator iterator;
+		// Connects a slot that can stop emit_until_handled() by returning true.
+		template<class desttype>
+		connection connect(desttype* pclass, bool (desttype::*pmemfun)(arg_types...), int priority = 0)
+		{
+			signal_lock lock(this);
+			return this->add_copy(_handler_connection<desttype, mt_policy, arg_types...>(pclass, pmemfun), priority);
+		}
         
-		_signal_base6()
+		// Connects a slot that receives emit_batch() events as one span.
+		template<class desttype>
+		connection connect(desttype* pclass, void (desttype::*pmemfun)(const event_type*, size_t), int priority = 0)
 		{
-			;
+			signal_lock lock(this);
+			return this->add_copy(_bulk_connection<desttype, mt_policy, arg_types...>(pclass, pmemfun), priority);
 		}
         
-		_signal_base6(const _signal_base6<arg1_type, arg2_type, arg3_type, arg4_type,
-                      arg5_type, arg6_type, mt_policy>& s)
-        : _signal_base<mt_policy>(s)
+		// Makes a queued connection; see queued_on.
+		template<class desttype>
+		connection connect(desttype* pclass, void (desttype::*pmemfun)(arg_types...), const queued_on& queue,
+			int priority = 0)
 		{
-			lock_block<mt_policy> lock(this);
-			const_iterator it = s.m_connected_slots.begin();
-			const_iterator itEnd = s.m_connected_slots.end();
+			dispatcher* pdispatcher = queue.m_pdispatcher ? queue.m_pdispatcher : pclass->get_dispatcher();
             
-			while(it != itEnd)
+			if(pdispatcher == NULL)
 			{
-				(*it)->getdest()->signal_connect(this);
-				m_connected_slots.push_back((*it)->clone());
-                
-				++it;
+				return connect(pclass, pmemfun, priority);
 			}
+            
+			signal_lock lock(this);
+			return this->add_copy(_queued_connection<desttype, mt_policy, arg_types...>(pclass, pmemfun, pdispatcher),
+				priority);
 		}
         
-		void slot_duplicate(const has_slots<mt_policy>* oldtarget, has_slots<mt_policy>* newtarget)
+		// Makes a coalesced connection; see coalesced_on.
+		template<class desttype>
+		connection connect(desttype* pclass, void (desttype::*pmemfun)(arg_types...), const coalesced_on& coalesce,
+			int priority = 0)
 		{
-			lock_block<mt_policy> lock(this);
-			iterator it = m_connected_slots.begin();
-			iterator itEnd = m_connected_slots.end();
+			dispatcher* pdispatcher = coalesce.m_pdispatcher ? coalesce.m_pdispatcher : pclass->get_dispatcher();
             
-			while(it != itEnd)
+			if(pdispatcher == NULL)
 			{
-				if((*it)->getdest() == oldtarget)
-				{
-					m_connected_slots.push_back((*it)->duplicate(newtarget));
-				}
-                
-				++it;
+				return connect(pclass, pmemfun, priority);
 			}
+            
+			signal_lock lock(this);
+			return this->add_copy(_coalesced_connection<desttype, mt_policy, arg_types...>(pclass, pmemfun,
+				pdispatcher, coalesce.m_interval), priority);
 		}
         
-		~_signal_base6()
+		// Binds the member function at compile time; see _bound_connection.
+		template<class desttype, void (desttype::*pmemfun)(arg_types...)>
+		connection connect(desttype* pclass, int priority = 0)
 		{
-			disconnect_all();
+			signal_lock lock(this);
+			return this->add_copy(
+				_bound_connection<desttype, mt_policy, void (desttype::*)(arg_types...), pmemfun>(pclass), priority);
 		}
         
-		void disconnect_all()
+#ifdef __cpp_nontype_template_parameter_auto
+		template<auto pmemfun>
+		connection connect(typename _member_class<decltype(pmemfun)>::type* pclass, int priority = 0)
 		{
-			lock_block<mt_policy> lock(this);
-			const_iterator it = m_connected_slots.begin();
-			const_iterator itEnd = m_connected_slots.end();
-            
-			while(it != itEnd)
-			{
-				(*it)->getdest()->signal_disconnect(this);
-				delete *it;
-                
-				++it;
-			}
-            
-			m_connected_slots.erase(m_connected_slots.begin(), m_connected_slots.end());
+			return connect<typename _member_class<decltype(pmemfun)>::type, pmemfun>(pclass, priority);
 		}
+#endif
         
-		void disconnect(has_slots<mt_policy>* pclass)
+		// Connects a copy of any callable, such as a lambda, that takes the
+		// signal's arguments; see _functor_connection. Only disconnecting
+		// its handle, or disconnect_all(), removes it.
+		template<class functor_type>
+		connection connect(functor_type functor, int priority = 0)
 		{
-			lock_block<mt_policy> lock(this);
-			iterator it = m_connected_slots.begin();
-			iterator itEnd = m_connected_slots.end();
-            
-			while(it != itEnd)
-			{
-				if((*it)->getdest() == pclass)
-				{
-					delete *it;
-					m_connected_slots.erase(it);
-					pclass->signal_disconnect(this);
-					return;
-				}
-                
-				++it;
-			}
+			signal_lock lock(this);
+			return this->add_copy(_functor_connection<functor_type, mt_policy, arg_types...>(functor), priority);
 		}
         
-		void slot_disconnect(has_slots<mt_policy>* pslot)
+		// Lets the name of an overloaded function pick the overload for the
+		// signal's arguments.
+		connection connect(void (*pfunction)(arg_types...), int priority = 0)
 		{
-			lock_block<mt_policy> lock(this);
-			iterator it = m_connected_slots.begin();
-			iterator itEnd = m_connected_slots.end();
+			return connect<void (*)(arg_types...)>(pfunction, priority);
+		}
+        
+		void emit(typename _param<arg_types>::type... args)
+		{
+			_instrumentation::timer wait;
+			_emit_guard<mt_policy> lock(this, this->emitting_here(), this->job_here());
+			this->note_lock_wait(wait);
+			this->note_emit(1);
+			emit_scope scope(this);
+			emit_iterator it(this->m_connected_slots);
             
-			while(it != itEnd)
+			while(it.next())
 			{
-				iterator itNext = it;
-				++itNext;
-                
-				if((*it)->getdest() == pslot)
-				{
-                    delete *it;
-					m_connected_slots.erase(it);
-				}
-                
-				it = itNext;
+				_instrumentation::timer call;
+				unsigned long mark = this->call_mark();
+				(*it)->emit(args...);
+				this->note_call(*it, mark, call);
 			}
 		}
         
-	protected:
-		connections_list m_connected_slots;   
-	};
-    
-	template<class arg1_type, class arg2_type, class arg3_type, class arg4_type,
-	class arg5_type, class arg6_type, class arg7_type, class mt_policy>
-	class _signal_base7 : public _signal_base<mt_policy>
-	{
-	public:
-		typedef std::list<_connection_base7<arg1_type, arg2_type, arg3_type, 
-        arg4_type, arg5_type, arg6_type, arg7_type, mt_policy> *>  connections_list;
-        typedef typename connections_list::const_iterator const_iterator;
-        typedef typename connections_list::iterator iterator;
-        
-		_signal_base7()
+		void operator()(typename _param<arg_types>::type... args)
 		{
-			;
+			emit(args...);
 		}
         
-		_signal_base7(const _signal_base7<arg1_type, arg2_type, arg3_type, arg4_type,
-                      arg5_type, arg6_type, arg7_type, mt_policy>& s)
-        : _signal_base<mt_policy>(s)
+		// Like emit(), but stops after the first slot that returns true, so
+		// the slots after it do not run. Returns whether a slot did. Slots
+		// that return void never stop it.
+		bool emit_until_handled(typename _param<arg_types>::type... args)
 		{
-			lock_block<mt_policy> lock(this);
-			const_iterator it = s.m_connected_slots.begin();
-			const_iterator itEnd = s.m_connected_slots.end();
+			_instrumentation::timer wait;
+			_emit_guard<mt_policy> lock(this, this->emitting_here(), this->job_here());
+			this->note_lock_wait(wait);
+			this->note_emit(1);
+			emit_scope scope(this);
+			emit_iterator it(this->m_connected_slots);
             
-			while(it != itEnd)
+			while(it.next())
 			{
-				(*it)->getdest()->signal_connect(this);
-				m_connected_slots.push_back((*it)->clone());
+				_instrumentation::timer call;
+				unsigned long mark = this->call_mark();
+				bool handled = (*it)->emit_handled(args...);
+				this->note_call(*it, mark, call);
                 
-				++it;
+				if(handled)
+				{
+					return true;
+				}
 			}
-		}
-        
-		void slot_duplicate(const has_slots<mt_policy>* oldtarget, has_slots<mt_policy>* newtarget)
-		{
-			lock_block<mt_policy> lock(this);
-			iterator it = m_connected_slots.begin();
-			iterator itEnd = m_connected_slots.end();
             
-			while(it != itEnd)
+			return false;
+		}
+        
+		// Like emit(), but the calls to queued connections are grouped by
+		// dispatcher, and each dispatcher is posted one event that holds one
+		// copy of the arguments and runs its slots in order. The events are
+		// posted when the other slots, which run here, have returned.
+		void emit_routed(typename _param<arg_types>::type... args)
+		{
+			_instrumentation::timer wait;
+			_emit_guard<mt_policy> lock(this, this->emitting_here(), this->job_here());
+			this->note_lock_wait(wait);
+			this->note_emit(1);
+			emit_scope scope(this);
+			_routing<arg_types...> routing(args...);
+			emit_iterator it(this->m_connected_slots);
+            
+			while(it.next())
 			{
-				if((*it)->getdest() == oldtarget)
+				_instrumentation::timer call;
+				unsigned long mark = this->call_mark();
+                
+				if(!(*it)->route(routing))
 				{
-					m_connected_slots.push_back((*it)->duplicate(newtarget));
+					(*it)->emit(args...);
 				}
                 
-				++it;
+				this->note_call(*it, mark, call);
 			}
-		}
-        
-		~_signal_base7()
-		{
-			disconnect_all();
-		}
-        
-		void disconnect_all()
-		{
-			lock_block<mt_policy> lock(this);
-			const_iterator it = m_connected_slots.begin();
-			const_iterator itEnd = m_connected_slots.end();
             
-			while(it != itEnd)
+			routing.post();
+		}
+        
+		// Runs the slots spread over executor's threads and returns once
+		// they have all finished. The slots must be independent of each
+		// other and must not throw. Under a policy with _reentrant_emit, a
+		// slot may disconnect its own connection, emit this signal again,
+		// or destroy its receiver if that has no other slot here: while
+		// the job runs, its threads take a lock of the job's in place of
+		// this signal's, which the calling thread holds. A slot must not
+		// connect to this signal, or disconnect slots that other threads
+		// may be calling. Other threads may connect and disconnect it
+		// meanwhile on the same terms as during emit().
+		void emit_parallel(parallel_executor& executor, typename _param<arg_types>::type... args)
+		{
+			_instrumentation::timer wait;
+			_emit_guard<mt_policy> lock(this, this->emitting_here(), this->job_here());
+			this->note_lock_wait(wait);
+			this->note_emit(1);
+			emit_scope scope(this);
+			_parallel_emit<_connection_base<mt_policy, arg_types...>, arg_types...> job(args...);
+			emit_iterator it(this->m_connected_slots);
+            
+			while(it.next())
 			{
-				(*it)->getdest()->signal_disconnect(this);
-				delete *it;
-                
-				++it;
+				job.add(*it);
 			}
             
-			m_connected_slots.erase(m_connected_slots.begin(), m_connected_slots.end());
-		}
-        
-		void disconnect(has_slots<mt_policy>* pclass)
-		{
-			lock_block<mt_policy> lock(this);
-			iterator it = m_connected_slots.begin();
-			iterator itEnd = m_connected_slots.end();
+			_parallel_lock<mt_policy> parallel;
+			job_scope running(this, &parallel);
+			job.run(executor, &parallel);
+		}
+        
+		// Emits count events under a single lock. Slots connected with the
+		// span overload of connect() get the events in one call. The events
+		// are passed as const, so arguments here cannot be non-const
+		// references.
+		void emit_batch(const event_type* pevents, size_t count, batch_order order = event_major)
+		{
+			static_assert(!_has_mutable_ref<arg_types...>::value,
+				"emit_batch() cannot pass non-const reference arguments");
+			_instrumentation::timer wait;
+			_emit_guard<mt_policy> lock(this, this->emitting_here(), this->job_here());
+			this->note_lock_wait(wait);
+			this->note_emit(count);
+			emit_scope scope(this);
             
-			while(it != itEnd)
+			if(order == slot_major)
 			{
-				if((*it)->getdest() == pclass)
+				emit_iterator it(this->m_connected_slots);
+                
+				while(it.next())
 				{
-					delete *it;
-					m_connected_slots.erase(it);
-					pclass->signal_disconnect(this);
-					return;
+					this->emit_events(*it, pevents, count);
 				}
                 
-				++it;
+				return;
 			}
-		}
-        
-		void slot_disconnect(has_slots<mt_policy>* pslot)
-		{
-			lock_block<mt_policy> lock(this);
-			iterator it = m_connected_slots.begin();
-			iterator itEnd = m_connected_slots.end();
             
-			while(it != itEnd)
+			for(size_t i = 0; i < count; ++i)
 			{
-				iterator itNext = it;
-				++itNext;
+				emit_iterator it(this->m_connected_slots);
                 
-				if((*it)->getdest() == pslot)
+				while(it.next())
 				{
-                    delete *it;
-					m_connected_slots.erase(it);
+					(*it)->emit_event(pevents[i]);
 				}
-                
-				it = itNext;
 			}
 		}
         
-	protected:
-		connections_list m_connected_slots;   
-	};
-    
-	template<class arg1_type, class arg2_type, class arg3_type, class arg4_type,
-	class arg5_type, class arg6_type, class arg7_type, class arg8_type, class mt_policy>
-	class _signal_base8 : public _signal_base<mt_policy>
-	{
-	public:
-		typedef std::list<_connection_base8<arg1_type, arg2_type, arg3_type, 
-        arg4_type, arg5_type, arg6_type, arg7_type, arg8_type, mt_policy> *>
-        connections_list;
-        typedef typename connections_list::const_iterator const_iterator;
-        typedef typename connections_list::iterator iterator;
-        
-		_signal_base8()
+		void add_waiter(waiter_type* pwaiter)
 		{
-			;
+			signal_lock lock(this);
+			pwaiter->m_pprev_waiter = m_plast_waiter;
+			pwaiter->m_pnext_waiter = NULL;
+			pwaiter->m_linked = true;
+            
+			if(m_plast_waiter != NULL)
+			{
+				m_plast_waiter->m_pnext_waiter = pwaiter;
+			}
+			else
+			{
+				_atomic_store_relaxed(&m_pfirst_waiter, pwaiter);
+			}
+            
+			m_plast_waiter = pwaiter;
 		}
         
-		_signal_base8(const _signal_base8<arg1_type, arg2_type, arg3_type, arg4_type,
-                      arg5_type, arg6_type, arg7_type, arg8_type, mt_policy>& s)
-        : _signal_base<mt_policy>(s)
+		void remove_waiter(waiter_type* pwaiter)
 		{
-			lock_block<mt_policy> lock(this);
-			const_iterator it = s.m_connected_slots.begin();
-			const_iterator itEnd = s.m_connected_slots.end();
+			signal_lock lock(this);
             
-			while(it != itEnd)
+			if(!pwaiter->m_linked)
 			{
-				(*it)->getdest()->signal_connect(this);
-				m_connected_slots.push_back((*it)->clone());
-                
-				++it;
+				return;
+			}
+            
+			if(pwaiter->m_pprev_waiter != NULL)
+			{
+				pwaiter->m_pprev_waiter->m_pnext_waiter = pwaiter->m_pnext_waiter;
+			}
+			else
+			{
+				_atomic_store_relaxed(&m_pfirst_waiter, pwaiter->m_pnext_waiter);
+			}
+            
+			if(pwaiter->m_pnext_waiter != NULL)
+			{
+				pwaiter->m_pnext_waiter->m_pprev_waiter = pwaiter->m_pprev_waiter;
+			}
+			else
+			{
+				m_plast_waiter = pwaiter->m_pprev_waiter;
 			}
+            
+			pwaiter->m_linked = false;
 		}
         
-		void slot_duplicate(const has_slots<mt_policy>* oldtarget, has_slots<mt_policy>* newtarget)
+		// Called after an emit, without the signal's lock. A waiter that
+		// is just being added may miss this emit and see the next one.
+		void wake(typename _param<arg_types>::type... args)
 		{
-			lock_block<mt_policy> lock(this);
-			iterator it = m_connected_slots.begin();
-			iterator itEnd = m_connected_slots.end();
-            
-			while(it != itEnd)
+			if(_atomic_load_relaxed(&m_pfirst_waiter) != NULL)
 			{
-				if((*it)->getdest() == oldtarget)
-				{
-					m_connected_slots.push_back((*it)->duplicate(newtarget));
-				}
-                
-				++it;
+				wake_waiters(args...);
 			}
 		}
         
-		~_signal_base8()
+		void wake(const event_type& event)
 		{
-			disconnect_all();
+			if(_atomic_load_relaxed(&m_pfirst_waiter) != NULL)
+			{
+				wake_unpacked(event, typename _make_index_list<sizeof...(arg_types)>::type());
+			}
 		}
         
-		void disconnect_all()
+		void cancel_waiters()
 		{
-			lock_block<mt_policy> lock(this);
-			const_iterator it = m_connected_slots.begin();
-			const_iterator itEnd = m_connected_slots.end();
-            
-			while(it != itEnd)
+			if(_atomic_load_relaxed(&m_pfirst_waiter) == NULL)
 			{
-				(*it)->getdest()->signal_disconnect(this);
-				delete *it;
-                
-				++it;
+				return;
 			}
             
-			m_connected_slots.erase(m_connected_slots.begin(), m_connected_slots.end());
+			waiter_type* pwaiter = take_waiters();
+            
+			while(pwaiter != NULL)
+			{
+				waiter_type* pnext = pwaiter->m_pnext_waiter;
+				pwaiter->cancel();
+				pwaiter = pnext;
+			}
 		}
         
-		void disconnect(has_slots<mt_policy>* pclass)
+	private:
+		// Kept out of emit(), which only tests for waiters. Each waiter is
+		// read before it is woken, since waking it may end its lifetime.
+		_SIGSLOT_NOINLINE void wake_waiters(typename _param<arg_types>::type... args)
 		{
-			lock_block<mt_policy> lock(this);
-			iterator it = m_connected_slots.begin();
-			iterator itEnd = m_connected_slots.end();
+			waiter_type* pwaiter = take_waiters();
             
-			while(it != itEnd)
+			while(pwaiter != NULL)
 			{
-				if((*it)->getdest() == pclass)
-				{
-					delete *it;
-					m_connected_slots.erase(it);
-					pclass->signal_disconnect(this);
-					return;
-				}
-                
-				++it;
+				waiter_type* pnext = pwaiter->m_pnext_waiter;
+				pwaiter->wake(args...);
+				pwaiter = pnext;
 			}
 		}
         
-		void slot_disconnect(has_slots<mt_policy>* pslot)
+		template<size_t... indices>
+		void wake_unpacked(const event_type& event, _index_list<indices...>)
 		{
-			lock_block<mt_policy> lock(this);
-			iterator it = m_connected_slots.begin();
-			iterator itEnd = m_connected_slots.end();
+			wake_waiters(std::get<indices>(event)...);
+		}
+        
+		// Unlinks every waiter, leaving them chained from the first.
+		waiter_type* take_waiters()
+		{
+			signal_lock lock(this);
+			waiter_type* pfirst = _atomic_load_relaxed(&m_pfirst_waiter);
             
-			while(it != itEnd)
+			for(waiter_type* pwaiter = pfirst; pwaiter != NULL; pwaiter = pwaiter->m_pnext_waiter)
 			{
-				iterator itNext = it;
-				++itNext;
-                
-				if((*it)->getdest() == pslot)
-				{
-                    delete *it;
-					m_connected_slots.erase(it);
-				}
-                
-				it = itNext;
+				pwaiter->m_linked = false;
 			}
+            
+			_atomic_store_relaxed(&m_pfirst_waiter, static_cast<waiter_type*>(NULL));
+			m_plast_waiter = NULL;
+			return pfirst;
 		}
         
-	protected:
-		connections_list m_connected_slots;   
+		waiter_type* volatile m_pfirst_waiter;
+		waiter_type* m_plast_waiter;
 	};
     
-    
-	template<class dest_type, class mt_policy>
-	class _connection0 : public _connection_base0<mt_policy>
+	// The signal class for any number of arguments. signal<> and
+	// signal0..signal8 below are aliases of it that supply the policies.
+	//
+	// The signal itself is one pointer to a _signal_body, which the first
+	// connect() allocates and which then lives as long as the signal. Until
+	// then emitting finds the pointer null and returns. Two threads making
+	// the first connections at once may both allocate a body; one installs
+	// its own, and the other frees its body and uses that one.
+	template<class mt_policy, class storage_policy, class... arg_types>
+	class basic_signal
 	{
 	public:
-		_connection0()
-		{
-			this->pobject = NULL;
-			this->pmemfun = NULL;
-		}
-        
-		_connection0(dest_type* pobject, void (dest_type::*pmemfun)())
-		{
-			m_pobject = pobject;
-			m_pmemfun = pmemfun;
-		}
+		typedef _signal_body<mt_policy, storage_policy, arg_types...> body_type;
+		typedef typename body_type::event_type event_type;
         
-		virtual _connection_base0<mt_policy>* clone()
+		// Names a slot for static_signal: a member function bound at
+		// compile time, to be called on a receiver given at run time.
+		template<class desttype, void (desttype::*pmemfun)(arg_types...)>
+		struct static_slot
 		{
-			return new _connection0<dest_type, mt_policy>(*this);
-		}
+			typedef desttype dest_type;
+            
+			static void call(desttype* pobject, typename _param<arg_types>::type... args)
+			{
+				(pobject->*pmemfun)(args...);
+			}
+		};
         
-		virtual _connection_base0<mt_policy>* duplicate(has_slots<mt_policy>* pnewdest)
+		basic_signal()
+        : m_pbody(NULL)
 		{
-			return new _connection0<dest_type, mt_policy>((dest_type *)pnewdest, m_pmemfun);
+			;
 		}
         
-		virtual void emit()
+		basic_signal(const basic_signal& s)
+        : m_pbody(s.m_pbody != NULL ? new body_type(*s.m_pbody) : NULL)
 		{
-			(m_pobject->*m_pmemfun)();
+			;
 		}
         
-		virtual has_slots<mt_policy>* getdest() const
+		// The body changes hands, so receivers and handles need no update.
+		basic_signal(basic_signal&& s) noexcept
+        : m_pbody(s.m_pbody)
 		{
-			return m_pobject;
+			s.m_pbody = NULL;
 		}
         
-	private:
-		dest_type* m_pobject;
-		void (dest_type::* m_pmemfun)();
-	};
-    
-	template<class dest_type, class arg1_type, class mt_policy>
-	class _connection1 : public _connection_base1<arg1_type, mt_policy>
-	{
-	public:
-		_connection1()
+		// Drops this signal's connections and clones those of s, as the copy
+		// constructor does. Handles made before stay stale.
+		basic_signal& operator=(const basic_signal& s)
 		{
-			this->pobject = NULL;
-			this->pmemfun = NULL;
+			if(&s != this)
+			{
+				disconnect_all();
+                
+				if(s.m_pbody != NULL)
+				{
+					body()->copy_connections(*s.m_pbody);
+				}
+			}
+            
+			return *this;
 		}
         
-		_connection1(dest_type* pobject, void (dest_type::*pmemfun)(arg1_type))
+		// Handles made by this signal before the assignment must not be
+		// used afterwards; they may match a connection taken from s.
+		basic_signal& operator=(basic_signal&& s) noexcept
 		{
-			m_pobject = pobject;
-			m_pmemfun = pmemfun;
+			if(&s != this)
+			{
+				delete m_pbody;
+				m_pbody = s.m_pbody;
+				s.m_pbody = NULL;
+			}
+            
+			return *this;
 		}
         
-		virtual _connection_base1<arg1_type, mt_policy>* clone()
+		~basic_signal()
 		{
-			return new _connection1<dest_type, arg1_type, mt_policy>(*this);
+			delete m_pbody;
 		}
         
-		virtual _connection_base1<arg1_type, mt_policy>* duplicate(has_slots<mt_policy>* pnewdest)
+		template<class desttype>
+		connection connect(desttype* pclass, void (desttype::*pmemfun)(arg_types...), int priority = 0)
 		{
-			return new _connection1<dest_type, arg1_type, mt_policy>((dest_type *)pnewdest, m_pmemfun);
+			return body()->connect(pclass, pmemfun, priority);
 		}
         
-		virtual void emit(arg1_type a1)
+		template<class desttype>
+		connection connect(desttype* pclass, bool (desttype::*pmemfun)(arg_types...), int priority = 0)
 		{
-			(m_pobject->*m_pmemfun)(a1);
+			return body()->connect(pclass, pmemfun, priority);
 		}
         
-		virtual has_slots<mt_policy>* getdest() const
+		template<class desttype>
+		connection connect(desttype* pclass, void (desttype::*pmemfun)(const event_type*, size_t), int priority = 0)
 		{
-			return m_pobject;
+			return body()->connect(pclass, pmemfun, priority);
 		}
         
-	private:
-		dest_type* m_pobject;
-		void (dest_type::* m_pmemfun)(arg1_type);
-	};
-    
-	template<class dest_type, class arg1_type, class arg2_type, class mt_policy>
-	class _connection2 : public _connection_base2<arg1_type, arg2_type, mt_policy>
-	{
-	public:
-		_connection2()
+		template<class desttype>
+		connection connect(desttype* pclass, void (desttype::*pmemfun)(arg_types...), const queued_on& queue,
+			int priority = 0)
 		{
-			this->pobject = NULL;
-			this->pmemfun = NULL;
+			return body()->connect(pclass, pmemfun, queue, priority);
 		}
         
-		_connection2(dest_type* pobject, void (dest_type::*pmemfun)(arg1_type,
-                                                                    arg2_type))
+		template<class desttype>
+		void connect_many(desttype* const* pclasses, size_t count, void (desttype::*pmemfun)(arg_types...),
+			connection* phandles = NULL, int priority = 0)
 		{
-			m_pobject = pobject;
-			m_pmemfun = pmemfun;
+			if(count != 0)
+			{
+				body()->connect_many(pclasses, count, pmemfun, phandles, priority);
+			}
 		}
         
-		virtual _connection_base2<arg1_type, arg2_type, mt_policy>* clone()
+		template<class desttype>
+		connection connect(desttype* pclass, void (desttype::*pmemfun)(arg_types...), const coalesced_on& coalesce,
+			int priority = 0)
 		{
-			return new _connection2<dest_type, arg1_type, arg2_type, mt_policy>(*this);
+			return body()->connect(pclass, pmemfun, coalesce, priority);
 		}
         
-		virtual _connection_base2<arg1_type, arg2_type, mt_policy>* duplicate(has_slots<mt_policy>* pnewdest)
+		template<class desttype, void (desttype::*pmemfun)(arg_types...)>
+		connection connect(desttype* pclass, int priority = 0)
 		{
-			return new _connection2<dest_type, arg1_type, arg2_type, mt_policy>((dest_type *)pnewdest, m_pmemfun);
+			return body()->template connect<desttype, pmemfun>(pclass, priority);
 		}
         
-		virtual void emit(arg1_type a1, arg2_type a2)
+#ifdef __cpp_nontype_template_parameter_auto
+		template<auto pmemfun>
+		connection connect(typename _member_class<decltype(pmemfun)>::type* pclass, int priority = 0)
 		{
-			(m_pobject->*m_pmemfun)(a1, a2);
+			return body()->template connect<pmemfun>(pclass, priority);
 		}
+#endif
         
-		virtual has_slots<mt_policy>* getdest() const
+		template<class functor_type>
+		connection connect(functor_type functor, int priority = 0)
 		{
-			return m_pobject;
+			return body()->connect(functor, priority);
 		}
         
-	private:
-		dest_type* m_pobject;
-		void (dest_type::* m_pmemfun)(arg1_type, arg2_type);
-	};
-    
-	template<class dest_type, class arg1_type, class arg2_type, class arg3_type, class mt_policy>
-	class _connection3 : public _connection_base3<arg1_type, arg2_type, arg3_type, mt_policy>
-	{
-	public:
-		_connection3()
+		connection connect(void (*pfunction)(arg_types...), int priority = 0)
 		{
-			this->pobject = NULL;
-			this->pmemfun = NULL;
+			return body()->connect(pfunction, priority);
 		}
         
-		_connection3(dest_type* pobject, void (dest_type::*pmemfun)(arg1_type,
-                                                                    arg2_type, arg3_type))
+		// Also resumes any coroutines waiting in next(), with no value.
+		void disconnect_all()
 		{
-			m_pobject = pobject;
-			m_pmemfun = pmemfun;
+			if(body_type* pbody = existing_body())
+			{
+				pbody->disconnect_all();
+				pbody->cancel_waiters();
+			}
 		}
         
-		virtual _connection_base3<arg1_type, arg2_type, arg3_type, mt_policy>* clone()
+		void disconnect(has_slots<mt_policy>* pclass)
 		{
-			return new _connection3<dest_type, arg1_type, arg2_type, arg3_type, mt_policy>(*this);
+			if(body_type* pbody = existing_body())
+			{
+				pbody->disconnect(pclass);
+			}
 		}
         
-		virtual _connection_base3<arg1_type, arg2_type, arg3_type, mt_policy>* duplicate(has_slots<mt_policy>* pnewdest)
+		void disconnect(const connection& conn)
 		{
-			return new _connection3<dest_type, arg1_type, arg2_type, arg3_type, mt_policy>((dest_type *)pnewdest, m_pmemfun);
+			if(body_type* pbody = existing_body())
+			{
+				pbody->disconnect(conn);
+			}
 		}
         
-		virtual void emit(arg1_type a1, arg2_type a2, arg3_type a3)
+		void disconnect_many(const connection* phandles, size_t count)
 		{
-			(m_pobject->*m_pmemfun)(a1, a2, a3);
+			if(body_type* pbody = existing_body())
+			{
+				pbody->disconnect_many(phandles, count);
+			}
 		}
         
-		virtual has_slots<mt_policy>* getdest() const
+		bool connected(const connection& conn)
 		{
-			return m_pobject;
+			body_type* pbody = existing_body();
+			return pbody != NULL && pbody->connected(conn);
 		}
         
-	private:
-		dest_type* m_pobject;
-		void (dest_type::* m_pmemfun)(arg1_type, arg2_type, arg3_type);
-	};
-    
-	template<class dest_type, class arg1_type, class arg2_type, class arg3_type,
-	class arg4_type, class mt_policy>
-	class _connection4 : public _connection_base4<arg1_type, arg2_type,
-    arg3_type, arg4_type, mt_policy>
-	{
-	public:
-		_connection4()
+		// Every form of emit wakes the coroutines waiting in next() once
+		// its slots have run, except emit_until_handled() when a slot
+		// handled the call. emit_batch() wakes them with its first event.
+		void emit(typename _param<arg_types>::type... args)
 		{
-			this->pobject = NULL;
-			this->pmemfun = NULL;
+			if(body_type* pbody = existing_body())
+			{
+				pbody->emit(args...);
+				pbody->wake(args...);
+			}
 		}
         
-		_connection4(dest_type* pobject, void (dest_type::*pmemfun)(arg1_type,
-                                                                    arg2_type, arg3_type, arg4_type))
+		void operator()(typename _param<arg_types>::type... args)
 		{
-			m_pobject = pobject;
-			m_pmemfun = pmemfun;
+			emit(args...);
 		}
         
-		virtual _connection_base4<arg1_type, arg2_type, arg3_type, arg4_type, mt_policy>* clone()
+		bool emit_until_handled(typename _param<arg_types>::type... args)
 		{
-			return new _connection4<dest_type, arg1_type, arg2_type, arg3_type, arg4_type, mt_policy>(*this);
+			body_type* pbody = existing_body();
+            
+			if(pbody == NULL || pbody->emit_until_handled(args...))
+			{
+				return pbody != NULL;
+			}
+            
+			pbody->wake(args...);
+			return false;
 		}
         
-		virtual _connection_base4<arg1_type, arg2_type, arg3_type, arg4_type, mt_policy>* duplicate(has_slots<mt_policy>* pnewdest)
+		void emit_routed(typename _param<arg_types>::type... args)
 		{
-			return new _connection4<dest_type, arg1_type, arg2_type, arg3_type, arg4_type, mt_policy>((dest_type *)pnewdest, m_pmemfun);
+			if(body_type* pbody = existing_body())
+			{
+				pbody->emit_routed(args...);
+				pbody->wake(args...);
+			}
 		}
         
-		virtual void emit(arg1_type a1, arg2_type a2, arg3_type a3, 
-                          arg4_type a4)
+		void emit_parallel(parallel_executor& executor, typename _param<arg_types>::type... args)
 		{
-			(m_pobject->*m_pmemfun)(a1, a2, a3, a4);
+			if(body_type* pbody = existing_body())
+			{
+				pbody->emit_parallel(executor, args...);
+				pbody->wake(args...);
+			}
 		}
         
-		virtual has_slots<mt_policy>* getdest() const
+		void emit_batch(const event_type* pevents, size_t count, batch_order order = event_major)
 		{
-			return m_pobject;
+			if(body_type* pbody = existing_body())
+			{
+				pbody->emit_batch(pevents, count, order);
+                
+				if(count != 0)
+				{
+					pbody->wake(pevents[0]);
+				}
+			}
 		}
         
-	private:
-		dest_type* m_pobject;
-		void (dest_type::* m_pmemfun)(arg1_type, arg2_type, arg3_type,
-                                      arg4_type);
-	};
-    
-	template<class dest_type, class arg1_type, class arg2_type, class arg3_type,
-	class arg4_type, class arg5_type, class mt_policy>
-	class _connection5 : public _connection_base5<arg1_type, arg2_type,
-    arg3_type, arg4_type, arg5_type, mt_policy>
-	{
-	public:
-		_connection5()
+#ifdef __cpp_impl_coroutine
+		// co_await next() suspends a coroutine until the signal is next
+		// emitted, and gives a std::optional of the arguments as an
+		// event_type, empty if the signal is destroyed or disconnect_all()
+		// is called first. The coroutine resumes on the emitting thread
+		// once the slots have run, or with next(d) on d's thread.
+		_signal_awaiter<body_type, arg_types...> next()
 		{
-			this->pobject = NULL;
-			this->pmemfun = NULL;
+			return _signal_awaiter<body_type, arg_types...>(body(), NULL);
 		}
         
-		_connection5(dest_type* pobject, void (dest_type::*pmemfun)(arg1_type,
-                                                                    arg2_type, arg3_type, arg4_type, arg5_type))
+		_signal_awaiter<body_type, arg_types...> next(dispatcher& d)
 		{
-			m_pobject = pobject;
-			m_pmemfun = pmemfun;
+			return _signal_awaiter<body_type, arg_types...>(body(), &d);
 		}
+#endif
         
-		virtual _connection_base5<arg1_type, arg2_type, arg3_type, arg4_type, 
-        arg5_type, mt_policy>* clone()
+		// For emit_statistics; the name is kept in the body, so this
+		// allocates one.
+		void set_name(const char* name)
 		{
-			return new _connection5<dest_type, arg1_type, arg2_type, arg3_type, arg4_type, 
-            arg5_type, mt_policy>(*this);
+			body()->set_name(name);
 		}
         
-		virtual _connection_base5<arg1_type, arg2_type, arg3_type, arg4_type, 
-        arg5_type, mt_policy>* duplicate(has_slots<mt_policy>* pnewdest)
+	private:
+		body_type* existing_body()
 		{
-			return new _connection5<dest_type, arg1_type, arg2_type, arg3_type, arg4_type, 
-            arg5_type, mt_policy>((dest_type *)pnewdest, m_pmemfun);
+			return _atomic_load(&m_pbody);
 		}
         
-		virtual void emit(arg1_type a1, arg2_type a2, arg3_type a3, arg4_type a4,
-                          arg5_type a5)
+		body_type* body()
 		{
-			(m_pobject->*m_pmemfun)(a1, a2, a3, a4, a5);
+			body_type* pbody = existing_body();
+			return pbody != NULL ? pbody : make_body();
 		}
         
-		virtual has_slots<mt_policy>* getdest() const
+		_SIGSLOT_NOINLINE body_type* make_body()
 		{
-			return m_pobject;
+			body_type* pbody = new body_type;
+            
+			if(!_atomic_compare_exchange(&m_pbody, static_cast<body_type*>(NULL), pbody))
+			{
+				delete pbody;
+				pbody = existing_body();
+			}
+            
+			return pbody;
 		}
         
-	private:
-		dest_type* m_pobject;
-		void (dest_type::* m_pmemfun)(arg1_type, arg2_type, arg3_type, arg4_type,
-                                      arg5_type);
+		body_type* volatile m_pbody;
 	};
     
-	template<class dest_type, class arg1_type, class arg2_type, class arg3_type,
-	class arg4_type, class arg5_type, class arg6_type, class mt_policy>
-	class _connection6 : public _connection_base6<arg1_type, arg2_type,
-    arg3_type, arg4_type, arg5_type, arg6_type, mt_policy>
+	template<class... arg_types>
+	using signal = basic_signal<SIGSLOT_DEFAULT_MT_POLICY, SIGSLOT_DEFAULT_STORAGE_POLICY, arg_types...>;
+    
+	template<class mt_policy = SIGSLOT_DEFAULT_MT_POLICY,
+	class storage_policy = SIGSLOT_DEFAULT_STORAGE_POLICY>
+	using signal0 = basic_signal<mt_policy, storage_policy>;
+    
+	template<class arg1_type, class mt_policy = SIGSLOT_DEFAULT_MT_POLICY,
+	class storage_policy = SIGSLOT_DEFAULT_STORAGE_POLICY>
+	using signal1 = basic_signal<mt_policy, storage_policy, arg1_type>;
+    
+	template<class arg1_type, class arg2_type, class mt_policy = SIGSLOT_DEFAULT_MT_POLICY,
+	class storage_policy = SIGSLOT_DEFAULT_STORAGE_POLICY>
+	using signal2 = basic_signal<mt_policy, storage_policy, arg1_type, arg2_type>;
+    
+	template<class arg1_type, class arg2_type, class arg3_type, class mt_policy = SIGSLOT_DEFAULT_MT_POLICY,
+	class storage_policy = SIGSLOT_DEFAULT_STORAGE_POLICY>
+	using signal3 = basic_signal<mt_policy, storage_policy, arg1_type, arg2_type, arg3_type>;
+    
+	template<class arg1_type, class arg2_type, class arg3_type, class arg4_type, class mt_policy = SIGSLOT_DEFAULT_MT_POLICY,
+	class storage_policy = SIGSLOT_DEFAULT_STORAGE_POLICY>
+	using signal4 = basic_signal<mt_policy, storage_policy, arg1_type, arg2_type, arg3_type, arg4_type>;
+    
+	template<class arg1_type, class arg2_type, class arg3_type, class arg4_type, class arg5_type, class mt_policy = SIGSLOT_DEFAULT_MT_POLICY,
+	class storage_policy = SIGSLOT_DEFAULT_STORAGE_POLICY>
+	using signal5 = basic_signal<mt_policy, storage_policy, arg1_type, arg2_type, arg3_type, arg4_type, arg5_type>;
+    
+	template<class arg1_type, class arg2_type, class arg3_type, class arg4_type, class arg5_type, class arg6_type, class mt_policy = SIGSLOT_DEFAULT_MT_POLICY,
+	class storage_policy = SIGSLOT_DEFAULT_STORAGE_POLICY>
+	using signal6 = basic_signal<mt_policy, storage_policy, arg1_type, arg2_type, arg3_type, arg4_type, arg5_type, arg6_type>;
+    
+	template<class arg1_type, class arg2_type, class arg3_type, class arg4_type, class arg5_type, class arg6_type, class arg7_type, class mt_policy = SIGSLOT_DEFAULT_MT_POLICY,
+	class storage_policy = SIGSLOT_DEFAULT_STORAGE_POLICY>
+	using signal7 = basic_signal<mt_policy, storage_policy, arg1_type, arg2_type, arg3_type, arg4_type, arg5_type, arg6_type, arg7_type>;
+    
+	template<class arg1_type, class arg2_type, class arg3_type, class arg4_type, class arg5_type, class arg6_type, class arg7_type, class arg8_type, class mt_policy = SIGSLOT_DEFAULT_MT_POLICY,
+	class storage_policy = SIGSLOT_DEFAULT_STORAGE_POLICY>
+	using signal8 = basic_signal<mt_policy, storage_policy, arg1_type, arg2_type, arg3_type, arg4_type, arg5_type, arg6_type, arg7_type, arg8_type>;
+    
+	// A signal with connections fixed at compile time, for wiring that
+	// never changes. Each of slot_types is a signal_type::static_slot, and
+	// the constructor takes their receivers in the same order; they must
+	// outlive the signal, and need not derive from has_slots. emit() calls
+	// those slots first, in order, with no allocation, no lock and no call
+	// through a pointer, so the compiler is free to inline them. It then
+	// emits signal_type itself, which connects and disconnects at run
+	// time as usual and costs a load and a test while nothing is connected.
+	//
+	// Emitting through a reference to signal_type reaches only the run
+	// time connections, and the other forms of emit are hidden here for
+	// that reason.
+	template<class signal_type, class... slot_types>
+	class static_signal;
+    
+	template<class mt_policy, class storage_policy, class... arg_types, class... slot_types>
+	class static_signal<basic_signal<mt_policy, storage_policy, arg_types...>, slot_types...>
+		: public basic_signal<mt_policy, storage_policy, arg_types...>
 	{
 	public:
-		_connection6()
-		{
-			this->pobject = NULL;
-			this->pmemfun = NULL;
-		}
+		typedef basic_signal<mt_policy, storage_policy, arg_types...> signal_type;
         
-		_connection6(dest_type* pobject, void (dest_type::*pmemfun)(arg1_type,
-                                                                    arg2_type, arg3_type, arg4_type, arg5_type, arg6_type))
+		explicit static_signal(typename slot_types::dest_type*... pobjects)
+        : m_objects(pobjects...)
 		{
-			m_pobject = pobject;
-			m_pmemfun = pmemfun;
+			;
 		}
         
-		virtual _connection_base6<arg1_type, arg2_type, arg3_type, arg4_type, 
-        arg5_type, arg6_type, mt_policy>* clone()
+		void emit(typename _param<arg_types>::type... args)
 		{
-			return new _connection6<dest_type, arg1_type, arg2_type, arg3_type, arg4_type, 
-            arg5_type, arg6_type, mt_policy>(*this);
+			call_static(typename _make_index_list<sizeof...(slot_types)>::type(), args...);
+			signal_type::emit(args...);
 		}
         
-		virtual _connection_base6<arg1_type, arg2_type, arg3_type, arg4_type, 
-        arg5_type, arg6_type, mt_policy>* duplicate(has_slots<mt_policy>* pnewdest)
+		void operator()(typename _param<arg_types>::type... args)
 		{
-			return new _connection6<dest_type, arg1_type, arg2_type, arg3_type, arg4_type, 
-            arg5_type, arg6_type, mt_policy>((dest_type *)pnewdest, m_pmemfun);
+			emit(args...);
 		}
         
-		virtual void emit(arg1_type a1, arg2_type a2, arg3_type a3, arg4_type a4,
-                          arg5_type a5, arg6_type a6)
-		{
-			(m_pobject->*m_pmemfun)(a1, a2, a3, a4, a5, a6);
-		}
+	private:
+		using signal_type::emit_until_handled;
+		using signal_type::emit_routed;
+		using signal_type::emit_parallel;
+		using signal_type::emit_batch;
         
-		virtual has_slots<mt_policy>* getdest() const
+		template<size_t... indices>
+		void call_static(_index_list<indices...>, typename _param<arg_types>::type... args)
 		{
-			return m_pobject;
+			int order[] = { 0, (slot_types::call(std::get<indices>(m_objects), args...), 0)... };
+			(void)order;
 		}
         
-	private:
-		dest_type* m_pobject;
-		void (dest_type::* m_pmemfun)(arg1_type, arg2_type, arg3_type, arg4_type,
-                                      arg5_type, arg6_type);
+		std::tuple<typename slot_types::dest_type*...> m_objects;
+	};
+    
+#ifndef _SIGSLOT_SINGLE_THREADED
+	// The layout of a shared_signal's region: this header, then the cells
+	// of a bounded queue that any number of processes can push to and pop
+	// from. Each cell has a sequence number that says whose turn it is: a
+	// cell at position pos is free to write while its sequence is pos, and
+	// holds an event to read while it is pos + 1. Positions wrap with long,
+	// so the number of cells is a power of two. The creator fills in the
+	// header and sets m_ready last; others wait for it before using the
+	// rest.
+	struct _shared_ring_header
+	{
+		enum { ready = 0x53534c31 };
+        
+		volatile long m_ready;
+		long m_event_size;
+		long m_cell_size;
+		long m_cells;
+		alignas(64) volatile long m_tail;
+		alignas(64) volatile long m_head;
+		alignas(64) volatile long m_dropped;
 	};
     
-	template<class dest_type, class arg1_type, class arg2_type, class arg3_type,
-	class arg4_type, class arg5_type, class arg6_type, class arg7_type, class mt_policy>
-	class _connection7 : public _connection_base7<arg1_type, arg2_type,
-    arg3_type, arg4_type, arg5_type, arg6_type, arg7_type, mt_policy>
+	// Claims and frees the cells of a shared_signal's region. Nothing here
+	// makes a system call once the region is mapped, and an event is
+	// written straight into its cell and read straight out of it.
+	class _shared_ring
 	{
 	public:
-		_connection7()
+		_shared_ring()
+        : m_pheader(NULL), m_pcells(NULL), m_mask(0), m_cell_size(0)
 		{
-			this->pobject = NULL;
-			this->pmemfun = NULL;
+			;
 		}
         
-		_connection7(dest_type* pobject, void (dest_type::*pmemfun)(arg1_type,
-                                                                    arg2_type, arg3_type, arg4_type, arg5_type, arg6_type, arg7_type))
+		bool create(const char* name, size_t event_size, size_t capacity)
 		{
-			m_pobject = pobject;
-			m_pmemfun = pmemfun;
+			size_t cells = 1;
+            
+			while(cells < capacity)
+			{
+				cells *= 2;
+			}
+            
+			size_t cell_size = (payload_offset + event_size + 63) / 64 * 64;
+            
+			if(is_open() || !m_mapping.create(name, sizeof(_shared_ring_header) + cells * cell_size))
+			{
+				return false;
+			}
+            
+			_shared_ring_header* pheader = static_cast<_shared_ring_header*>(m_mapping.address());
+			pheader->m_event_size = long(event_size);
+			pheader->m_cell_size = long(cell_size);
+			pheader->m_cells = long(cells);
+			pheader->m_tail = 0;
+			pheader->m_head = 0;
+			pheader->m_dropped = 0;
+			attach(pheader);
+            
+			for(size_t i = 0; i < cells; ++i)
+			{
+				*sequence(i) = long(i);
+			}
+            
+			_atomic_store(&pheader->m_ready, long(_shared_ring_header::ready));
+			return true;
 		}
         
-		virtual _connection_base7<arg1_type, arg2_type, arg3_type, arg4_type, 
-        arg5_type, arg6_type, arg7_type, mt_policy>* clone()
+		// Fails while the creator is still setting the region up, or if it
+		// was made for events of another size.
+		bool open(const char* name, size_t event_size)
 		{
-			return new _connection7<dest_type, arg1_type, arg2_type, arg3_type, arg4_type, 
-            arg5_type, arg6_type, arg7_type, mt_policy>(*this);
+			if(is_open() || !m_mapping.open(name))
+			{
+				return false;
+			}
+            
+			_shared_ring_header* pheader = static_cast<_shared_ring_header*>(m_mapping.address());
+            
+			if(m_mapping.size() < sizeof(_shared_ring_header)
+				|| _atomic_load(&pheader->m_ready) != long(_shared_ring_header::ready)
+				|| pheader->m_event_size != long(event_size)
+				|| m_mapping.size() < sizeof(_shared_ring_header) + size_t(pheader->m_cells) * size_t(pheader->m_cell_size))
+			{
+				m_mapping.close();
+				return false;
+			}
+            
+			attach(pheader);
+			return true;
 		}
         
-		virtual _connection_base7<arg1_type, arg2_type, arg3_type, arg4_type, 
-        arg5_type, arg6_type, arg7_type, mt_policy>* duplicate(has_slots<mt_policy>* pnewdest)
+		void close()
 		{
-			return new _connection7<dest_type, arg1_type, arg2_type, arg3_type, arg4_type, 
-            arg5_type, arg6_type, arg7_type, mt_policy>((dest_type *)pnewdest, m_pmemfun);
+			m_mapping.close();
+			m_pheader = NULL;
+			m_pcells = NULL;
 		}
         
-		virtual void emit(arg1_type a1, arg2_type a2, arg3_type a3, arg4_type a4,
-                          arg5_type a5, arg6_type a6, arg7_type a7)
+		bool is_open() const
 		{
-			(m_pobject->*m_pmemfun)(a1, a2, a3, a4, a5, a6, a7);
+			return m_pheader != NULL;
 		}
         
-		virtual has_slots<mt_policy>* getdest() const
+		// Claims the next free cell, and returns where its event goes and
+		// its position, which publish() then hands to the readers. Returns
+		// NULL, and counts the event as dropped, if every cell is full.
+		void* claim_write(unsigned long& pos)
 		{
-			return m_pobject;
+			if(m_pheader == NULL)
+			{
+				return NULL;
+			}
+            
+			pos = (unsigned long)_atomic_load(&m_pheader->m_tail);
+            
+			for(;;)
+			{
+				long turn = long((unsigned long)_atomic_load_acquire(sequence(pos)) - pos);
+                
+				if(turn == 0 && _atomic_compare_exchange(&m_pheader->m_tail, long(pos), long(pos + 1)))
+				{
+					return payload(pos);
+				}
+                
+				if(turn < 0)
+				{
+					_atomic_add(&m_pheader->m_dropped, 1);
+					return NULL;
+				}
+                
+				pos = (unsigned long)_atomic_load(&m_pheader->m_tail);
+			}
 		}
         
-	private:
-		dest_type* m_pobject;
-		void (dest_type::* m_pmemfun)(arg1_type, arg2_type, arg3_type, arg4_type,
-                                      arg5_type, arg6_type, arg7_type);
-	};
-    
-	template<class dest_type, class arg1_type, class arg2_type, class arg3_type,
-	class arg4_type, class arg5_type, class arg6_type, class arg7_type, 
-	class arg8_type, class mt_policy>
-	class _connection8 : public _connection_base8<arg1_type, arg2_type,
-    arg3_type, arg4_type, arg5_type, arg6_type, arg7_type, arg8_type, mt_policy>
-	{
-	public:
-		_connection8()
+		void publish(unsigned long pos)
 		{
-			this->pobject = NULL;
-			this->pmemfun = NULL;
+			_atomic_store_release(sequence(pos), long(pos + 1));
 		}
         
-		_connection8(dest_type* pobject, void (dest_type::*pmemfun)(arg1_type,
-                                                                    arg2_type, arg3_type, arg4_type, arg5_type, arg6_type, 
-                                                                    arg7_type, arg8_type))
+		// Claims the oldest event, and returns where it is and its position,
+		// which release() then frees for writers. Returns NULL if there is
+		// none.
+		const void* claim_read(unsigned long& pos)
 		{
-			m_pobject = pobject;
-			m_pmemfun = pmemfun;
+			if(m_pheader == NULL)
+			{
+				return NULL;
+			}
+            
+			pos = (unsigned long)_atomic_load(&m_pheader->m_head);
+            
+			for(;;)
+			{
+				long turn = long((unsigned long)_atomic_load_acquire(sequence(pos)) - (pos + 1));
+                
+				if(turn == 0 && _atomic_compare_exchange(&m_pheader->m_head, long(pos), long(pos + 1)))
+				{
+					return payload(pos);
+				}
+                
+				if(turn < 0)
+				{
+					return NULL;
+				}
+                
+				pos = (unsigned long)_atomic_load(&m_pheader->m_head);
+			}
 		}
         
-		virtual _connection_base8<arg1_type, arg2_type, arg3_type, arg4_type, 
-        arg5_type, arg6_type, arg7_type, arg8_type, mt_policy>* clone()
+		void release(unsigned long pos)
 		{
-			return new _connection8<dest_type, arg1_type, arg2_type, arg3_type, arg4_type, 
-            arg5_type, arg6_type, arg7_type, arg8_type, mt_policy>(*this);
+			_atomic_store_release(sequence(pos), long(pos + m_mask + 1));
 		}
         
-		virtual _connection_base8<arg1_type, arg2_type, arg3_type, arg4_type, 
-        arg5_type, arg6_type, arg7_type, arg8_type, mt_policy>* duplicate(has_slots<mt_policy>* pnewdest)
+		unsigned long dropped() const
 		{
-			return new _connection8<dest_type, arg1_type, arg2_type, arg3_type, arg4_type, 
-            arg5_type, arg6_type, arg7_type, arg8_type, mt_policy>((dest_type *)pnewdest, m_pmemfun);
+			return m_pheader != NULL ? (unsigned long)_atomic_load(&m_pheader->m_dropped) : 0;
 		}
         
-		virtual void emit(arg1_type a1, arg2_type a2, arg3_type a3, arg4_type a4,
-                          arg5_type a5, arg6_type a6, arg7_type a7, arg8_type a8)
+	private:
+		_shared_ring(const _shared_ring&);
+		_shared_ring& operator=(const _shared_ring&);
+        
+		// Events start far enough into a cell for any fundamental type.
+		enum { payload_offset = alignof(std::max_align_t) };
+        
+		void attach(_shared_ring_header* pheader)
 		{
-			(m_pobject->*m_pmemfun)(a1, a2, a3, a4, a5, a6, a7, a8);
+			m_pheader = pheader;
+			m_pcells = reinterpret_cast<char*>(pheader + 1);
+			m_mask = (unsigned long)pheader->m_cells - 1;
+			m_cell_size = size_t(pheader->m_cell_size);
 		}
         
-		virtual has_slots<mt_policy>* getdest() const
+		volatile long* sequence(unsigned long pos) const
 		{
-			return m_pobject;
+			return reinterpret_cast<volatile long*>(m_pcells + (pos & m_mask) * m_cell_size);
 		}
         
-	private:
-		dest_type* m_pobject;
-		void (dest_type::* m_pmemfun)(arg1_type, arg2_type, arg3_type, arg4_type,
-                                      arg5_type, arg6_type, arg7_type, arg8_type);
+		void* payload(unsigned long pos) const
+		{
+			return m_pcells + (pos & m_mask) * m_cell_size + payload_offset;
+		}
+        
+		_shared_mapping m_mapping;
+		_shared_ring_header* m_pheader;
+		char* m_pcells;
+		unsigned long m_mask;
+		size_t m_cell_size;
+	};
+    
+	// Checks that a signal's arguments can be sent to another process as
+	// their bytes: no references that slots could write through, and no
+	// types that are not trivially copyable.
+	template<class... arg_types>
+	struct _shareable_args
+	{
+		enum { value = true };
 	};
     
-	template<class mt_policy = SIGSLOT_DEFAULT_MT_POLICY>
-	class signal0 : public _signal_base0<mt_policy>
+	template<class arg_type, class... arg_types>
+	struct _shareable_args<arg_type, arg_types...>
+	{
+		enum { value = std::is_trivially_copyable<typename std::decay<arg_type>::type>::value
+			&& !_has_mutable_ref<arg_type>::value && _shareable_args<arg_types...>::value };
+	};
+    
+	// The sending end of a signal between processes on one host.
+	// create(name, capacity) makes a region of shared memory with room for
+	// capacity events, rounded up to a power of two, and open(name) maps
+	// one that another process made; either end may create it. emit()
+	// constructs the event straight in the shared memory and makes no
+	// system call. When the region is full it drops the event, returns
+	// false and counts it in dropped(), rather than wait for the readers.
+	//
+	// The arguments must be trivially copyable, and are sent as their
+	// bytes, so pointers in them mean nothing on the other side. Both ends
+	// must be built with the same layout for them. Any number of processes
+	// and threads may emit into one region at once, and any number may
+	// pump it. A process that dies part way through an emit leaves its
+	// cell claimed, and the readers stop there.
+	template<class... arg_types>
+	class shared_signal
 	{
 	public:
-    	typedef typename _signal_base0<mt_policy>::connections_list::const_iterator const_iterator;
-		signal0()
+		typedef std::tuple<typename std::decay<arg_types>::type...> event_type;
+        
+		bool create(const char* name, size_t capacity)
 		{
-			;
+			return m_ring.create(name, sizeof(event_type), capacity);
 		}
         
-		signal0(const signal0<mt_policy>& s)
-        : _signal_base0<mt_policy>(s)
+		bool open(const char* name)
 		{
-			;
+			return m_ring.open(name, sizeof(event_type));
 		}
         
-		template<class desttype>
-        void connect(desttype* pclass, void (desttype::*pmemfun)())
+		void close()
 		{
-			lock_block<mt_policy> lock(this);
-			_connection0<desttype, mt_policy>* conn = 
-            new _connection0<desttype, mt_policy>(pclass, pmemfun);
-			this->m_connected_slots.push_back(conn);
-			pclass->signal_connect(this);
+			m_ring.close();
 		}
         
-		void emit()
+		bool is_open() const
 		{
-			lock_block<mt_policy> lock(this);
-			const_iterator itNext, it = this->m_connected_slots.begin();
-			const_iterator itEnd = this->m_connected_slots.end();
-            
-			while(it != itEnd)
-			{
-				itNext = it;
-				++itNext;
-                
-				(*it)->emit();
-                
-				it = itNext;
-			}
+			return m_ring.is_open();
 		}
         
-		void operator()()
+		bool emit(typename _param<arg_types>::type... args)
 		{
-			lock_block<mt_policy> lock(this);
-			const_iterator itNext, it = this->m_connected_slots.begin();
-			const_iterator itEnd = this->m_connected_slots.end();
+			unsigned long pos;
+			void* pcell = m_ring.claim_write(pos);
             
-			while(it != itEnd)
+			if(pcell == NULL)
 			{
-				itNext = it;
-				++itNext;
-                
-				(*it)->emit();
-                
-				it = itNext;
+				return false;
 			}
+            
+			new(pcell) event_type(args...);
+			m_ring.publish(pos);
+			return true;
 		}
+        
+		bool operator()(typename _param<arg_types>::type... args)
+		{
+			return emit(args...);
+		}
+        
+		unsigned long dropped() const
+		{
+			return m_ring.dropped();
+		}
+        
+	private:
+		static_assert(_shareable_args<arg_types...>::value,
+			"shared_signal arguments must be trivially copyable, and not references that slots write through");
+		static_assert(alignof(event_type) <= alignof(std::max_align_t), "shared_signal arguments are over-aligned");
+        
+		_shared_ring m_ring;
 	};
     
-	template<class arg1_type, class mt_policy = SIGSLOT_DEFAULT_MT_POLICY>
-	class signal1 : public _signal_base1<arg1_type, mt_policy>
+	// The receiving end of a shared_signal. pump(sig) takes the events that
+	// are waiting and emits them into a local signal with the same
+	// arguments, so its connections see them as they would any emit;
+	// several at a time go to one emit_batch(). Nothing waits for events to
+	// arrive, so call it from whatever loop the process polls in.
+	template<class... arg_types>
+	class shared_signal_pump
 	{
 	public:
-    	typedef typename _signal_base1<arg1_type, mt_policy>::connections_list::const_iterator const_iterator;
-		signal1()
+		typedef std::tuple<typename std::decay<arg_types>::type...> event_type;
+        
+		enum { batch = 64 };
+        
+		// Room for a batch is made up front, so that copying an event out
+		// of its cell cannot fail and leave the cell claimed.
+		shared_signal_pump()
 		{
-			;
+			m_events.reserve(batch);
 		}
         
-		signal1(const signal1<arg1_type, mt_policy>& s)
-        : _signal_base1<arg1_type, mt_policy>(s)
+		bool create(const char* name, size_t capacity)
 		{
-			;
+			return m_ring.create(name, sizeof(event_type), capacity);
 		}
         
-		template<class desttype>
-        void connect(desttype* pclass, void (desttype::*pmemfun)(arg1_type))
+		bool open(const char* name)
 		{
-			lock_block<mt_policy> lock(this);
-			_connection1<desttype, arg1_type, mt_policy>* conn = 
-            new _connection1<desttype, arg1_type, mt_policy>(pclass, pmemfun);
-			this->m_connected_slots.push_back(conn);
-			pclass->signal_connect(this);
+			return m_ring.open(name, sizeof(event_type));
 		}
         
-		void emit(arg1_type a1)
+		void close()
 		{
-			lock_block<mt_policy> lock(this);
-			const_iterator itNext, it = this->m_connected_slots.begin();
-			const_iterator itEnd = this->m_connected_slots.end();
-            
-			while(it != itEnd)
-			{
-				itNext = it;
-				++itNext;
-                
-				(*it)->emit(a1);
-                
-				it = itNext;
-			}
+			m_ring.close();
 		}
         
-		void operator()(arg1_type a1)
+		bool is_open() const
 		{
-			lock_block<mt_policy> lock(this);
-			const_iterator itNext, it = this->m_connected_slots.begin();
-			const_iterator itEnd = this->m_connected_slots.end();
+			return m_ring.is_open();
+		}
+        
+		// Emits at most max_events events, and returns how many it did.
+		// Each is copied out of the shared memory before any slot runs, so
+		// a slow slot does not keep the writers short of cells.
+		template<class mt_policy, class storage_policy>
+		size_t pump(basic_signal<mt_policy, storage_policy, arg_types...>& sig, size_t max_events = size_t(-1))
+		{
+			size_t pumped = 0;
             
-			while(it != itEnd)
+			while(pumped < max_events)
 			{
-				itNext = it;
-				++itNext;
+				m_events.clear();
+				size_t room = std::min<size_t>(batch, max_events - pumped);
+                
+				unsigned long pos;
+				const void* pcell;
                 
-				(*it)->emit(a1);
+				while(m_events.size() < room && (pcell = m_ring.claim_read(pos)) != NULL)
+				{
+					m_events.push_back(*static_cast<const event_type*>(pcell));
+					m_ring.release(pos);
+				}
+                
+				if(m_events.empty())
+				{
+					break;
+				}
                 
-				it = itNext;
+				sig.emit_batch(&m_events[0], m_events.size());
+				pumped += m_events.size();
 			}
+            
+			return pumped;
+		}
+        
+		// Events that senders dropped because the region was full.
+		unsigned long dropped() const
+		{
+			return m_ring.dropped();
 		}
+        
+	private:
+		static_assert(_shareable_args<arg_types...>::value,
+			"shared_signal arguments must be trivially copyable, and not references that slots write through");
+        
+		_shared_ring m_ring;
+		std::vector<event_type> m_events;
 	};
+#endif // _SIGSLOT_SINGLE_THREADED
     
-	template<class arg1_type, typename arg2_type, typename mt_policy = SIGSLOT_DEFAULT_MT_POLICY>
-	class signal2 : public _signal_base2<arg1_type, arg2_type, mt_policy>
+	// Whether a signal_hub's slots may use the hub that is calling them. A
+	// hub keeps no snapshot that could be read without a lock, so under
+	// multi_threaded_cow its emit() takes the writers' lock; it then tracks
+	// the emitting thread as the _reentrant_emit policies do, since that
+	// lock is not recursive.
+	template<class mt_policy>
+	struct _hub_reentrant
+	{
+		enum { value = _reentrant_emit<mt_policy>::value || _lock_free_emit<mt_policy>::value };
+	};
+    
+	// The lock a signal_hub's emit() takes.
+	template<class mt_policy>
+	class _hub_emit_guard : public _emit_guard<mt_policy, _hub_reentrant<mt_policy>::value>
 	{
 	public:
-    	typedef typename _signal_base2<arg1_type, arg2_type, mt_policy>::connections_list::const_iterator const_iterator;
-		signal2()
+		_hub_emit_guard(mt_policy* phub, bool held)
+        : _emit_guard<mt_policy, _hub_reentrant<mt_policy>::value>(phub, held)
 		{
 			;
 		}
+	};
+    
+	// Many signals with the same arguments, told apart by a key such as a
+	// topic name, behind one lock and one index. The index is an open
+	// addressed hash table, probed linearly, from key to a topic that holds
+	// its connections in one array. A topic only exists while something is
+	// connected to it, so unused keys cost nothing, and emitting one finds
+	// an empty bucket and returns. Receivers are linked to the hub as they
+	// are to a signal, so destroying one removes it from every topic.
+	//
+	// The hub has the locking of a signal with the same policy, and its
+	// slots may use it in the same ways. multi_threaded_cow is the
+	// exception: there the hub locks as multi_threaded_local does, so its
+	// emits take turns, and its slots may use it as that policy allows.
+	// Connections removed during an emit are marked as gone, and their
+	// topics compacted when the outermost emit returns. key_type needs std::hash and operator==. A hub cannot
+	// be copied or moved.
+	template<class mt_policy, class key_type, class... arg_types>
+	class basic_signal_hub : public _signal_base<mt_policy>
+	{
+	public:
+		typedef _connection_base<mt_policy, arg_types...> conn_type;
+		typedef typename _signal_base<mt_policy>::link_position link_position;
         
-		signal2(const signal2<arg1_type, arg2_type, mt_policy>& s)
-        : _signal_base2<arg1_type, arg2_type, mt_policy>(s)
+		basic_signal_hub()
+        : m_topics(0), m_free_slot(no_slot), m_pemitter(NULL), m_emit_depth(0)
 		{
 			;
 		}
         
+		~basic_signal_hub()
+		{
+			disconnect_all();
+		}
+        
 		template<class desttype>
-        void connect(desttype* pclass, void (desttype::*pmemfun)(arg1_type,
-                                                                 arg2_type))
+		connection connect(const key_type& key, desttype* pclass, void (desttype::*pmemfun)(arg_types...))
 		{
-			lock_block<mt_policy> lock(this);
-			_connection2<desttype, arg1_type, arg2_type, mt_policy>* conn = new
-            _connection2<desttype, arg1_type, arg2_type, mt_policy>(pclass, pmemfun);
-			this->m_connected_slots.push_back(conn);
-			pclass->signal_connect(this);
+			hub_lock lock(this);
+			return add(key, _connection<desttype, mt_policy, arg_types...>(pclass, pmemfun).clone(), pclass);
 		}
         
-		void emit(arg1_type a1, arg2_type a2)
+		template<class desttype, void (desttype::*pmemfun)(arg_types...)>
+		connection connect(const key_type& key, desttype* pclass)
 		{
-			lock_block<mt_policy> lock(this);
-			const_iterator itNext, it = this->m_connected_slots.begin();
-			const_iterator itEnd = this->m_connected_slots.end();
-            
-			while(it != itEnd)
-			{
-				itNext = it;
-				++itNext;
-                
-				(*it)->emit(a1, a2);
-                
-				it = itNext;
-			}
+			hub_lock lock(this);
+			return add(key, _bound_connection<desttype, mt_policy, void (desttype::*)(arg_types...), pmemfun>(
+				pclass).clone(), pclass);
 		}
         
-		void operator()(arg1_type a1, arg2_type a2)
+		template<class functor_type>
+		connection connect(const key_type& key, functor_type functor)
 		{
-			lock_block<mt_policy> lock(this);
-			const_iterator itNext, it = this->m_connected_slots.begin();
-			const_iterator itEnd = this->m_connected_slots.end();
-            
-			while(it != itEnd)
-			{
-				itNext = it;
-				++itNext;
-                
-				(*it)->emit(a1, a2);
-                
-				it = itNext;
-			}
+			hub_lock lock(this);
+			return add(key, _functor_connection<functor_type, mt_policy, arg_types...>(functor).clone(), NULL);
 		}
-	};
-    
-	template<class arg1_type, typename arg2_type, typename arg3_type, typename mt_policy = SIGSLOT_DEFAULT_MT_POLICY>
-	class signal3 : public _signal_base3<arg1_type, arg2_type, arg3_type, mt_policy>
-	{
-	public:
-    	typedef typename _signal_base3<arg1_type, arg2_type, arg3_type, mt_policy>::connections_list::const_iterator const_iterator;
-		signal3()
+        
+		connection connect(const key_type& key, void (*pfunction)(arg_types...))
 		{
-			;
+			return connect<void (*)(arg_types...)>(key, pfunction);
 		}
         
-		signal3(const signal3<arg1_type, arg2_type, arg3_type, mt_policy>& s)
-        : _signal_base3<arg1_type, arg2_type, arg3_type, mt_policy>(s)
+		void disconnect(const connection& conn)
 		{
-			;
+			hub_lock lock(this);
+            
+			if(!is_live(conn))
+			{
+				return;
+			}
+            
+			slot_entry& entry = m_slots[conn.m_slot];
+            
+			if(entry.m_pdest != NULL)
+			{
+				entry.m_pdest->signal_disconnect(entry.m_link);
+			}
+            
+			remove(conn.m_slot);
 		}
         
-		template<class desttype>
-        void connect(desttype* pclass, void (desttype::*pmemfun)(arg1_type,
-                                                                 arg2_type, arg3_type))
+		bool connected(const connection& conn)
 		{
-			lock_block<mt_policy> lock(this);
-			_connection3<desttype, arg1_type, arg2_type, arg3_type, mt_policy>* conn = 
-            new _connection3<desttype, arg1_type, arg2_type, arg3_type, mt_policy>(pclass,
-                                                                                   pmemfun);
-			this->m_connected_slots.push_back(conn);
-			pclass->signal_connect(this);
+			hub_lock lock(this);
+			return is_live(conn);
 		}
         
-		void emit(arg1_type a1, arg2_type a2, arg3_type a3)
+		void disconnect_all()
 		{
-			lock_block<mt_policy> lock(this);
-			const_iterator itNext, it = this->m_connected_slots.begin();
-			const_iterator itEnd = this->m_connected_slots.end();
+			hub_lock lock(this);
             
-			while(it != itEnd)
+			for(size_t b = 0; b < m_buckets.size(); ++b)
 			{
-				itNext = it;
-				++itNext;
+				topic* ptopic = m_buckets[b].m_ptopic;
                 
-				(*it)->emit(a1, a2, a3);
+				if(ptopic == NULL)
+				{
+					continue;
+				}
+                
+				for(size_t i = 0; i < ptopic->m_conns.size(); ++i)
+				{
+					conn_type* pconn = ptopic->m_conns[i];
+                    
+					if(pconn != conn_type::tombstone())
+					{
+						slot_entry& entry = m_slots[pconn->m_slot];
+                        
+						if(entry.m_pdest != NULL)
+						{
+							entry.m_pdest->signal_disconnect(entry.m_link);
+						}
+                        
+						release_slot(pconn->m_slot);
+						delete pconn;
+						ptopic->m_conns[i] = conn_type::tombstone();
+					}
+				}
+                
+				if(m_emit_depth == 0)
+				{
+					delete ptopic;
+					continue;
+				}
                 
-				it = itNext;
+				if(ptopic->m_tombstones == 0)
+				{
+					m_dirty.push_back(ptopic);
+				}
+                
+				ptopic->m_tombstones = ptopic->m_conns.size();
+			}
+            
+			if(m_emit_depth == 0)
+			{
+				m_buckets.clear();
+				m_topics = 0;
 			}
 		}
         
-		void operator()(arg1_type a1, arg2_type a2, arg3_type a3)
+		// Runs the slots connected to key, in the order they were connected.
+		void emit(const key_type& key, typename _param<arg_types>::type... args)
 		{
-			lock_block<mt_policy> lock(this);
-			const_iterator itNext, it = this->m_connected_slots.begin();
-			const_iterator itEnd = this->m_connected_slots.end();
+			_hub_emit_guard<mt_policy> lock(this, emitting_here());
+			topic* ptopic = find(key, std::hash<key_type>()(key));
             
-			while(it != itEnd)
+			if(ptopic == NULL)
 			{
-				itNext = it;
-				++itNext;
-                
-				(*it)->emit(a1, a2, a3);
-                
-				it = itNext;
+				return;
+			}
+            
+			emit_scope scope(this);
+            
+			for(size_t i = 0; i < ptopic->m_conns.size(); ++i)
+			{
+				ptopic->m_conns[i]->emit(args...);
 			}
-		}
-	};
-    
-	template<class arg1_type, class arg2_type, class arg3_type, class arg4_type, class mt_policy = SIGSLOT_DEFAULT_MT_POLICY>
-	class signal4 : public _signal_base4<arg1_type, arg2_type, arg3_type,
-    arg4_type, mt_policy>
-	{
-	public:
-    	typedef typename _signal_base4<arg1_type, arg2_type, arg3_type, arg4_type, mt_policy>::connections_list::const_iterator const_iterator;
-		signal4()
-		{
-			;
 		}
         
-		signal4(const signal4<arg1_type, arg2_type, arg3_type, arg4_type, mt_policy>& s)
-        : _signal_base4<arg1_type, arg2_type, arg3_type, arg4_type, mt_policy>(s)
+		void operator()(const key_type& key, typename _param<arg_types>::type... args)
 		{
-			;
+			emit(key, args...);
 		}
         
-		template<class desttype>
-        void connect(desttype* pclass, void (desttype::*pmemfun)(arg1_type,
-                                                                 arg2_type, arg3_type, arg4_type))
+		void slot_disconnect(const connection& conn)
 		{
-			lock_block<mt_policy> lock(this);
-			_connection4<desttype, arg1_type, arg2_type, arg3_type, arg4_type, mt_policy>*
-            conn = new _connection4<desttype, arg1_type, arg2_type, arg3_type,
-            arg4_type, mt_policy>(pclass, pmemfun);
-			this->m_connected_slots.push_back(conn);
-			pclass->signal_connect(this);
+			hub_lock lock(this);
+            
+			if(is_live(conn))
+			{
+				remove(conn.m_slot);
+			}
 		}
         
-		void emit(arg1_type a1, arg2_type a2, arg3_type a3, arg4_type a4)
+		bool slot_duplicate(const connection& conn, has_slots<mt_policy>* pnewslot,
+			link_position plink, connection& duplicate)
 		{
-			lock_block<mt_policy> lock(this);
-			const_iterator itNext, it = this->m_connected_slots.begin();
-			const_iterator itEnd = this->m_connected_slots.end();
+			hub_lock lock(this);
             
-			while(it != itEnd)
+			if(!is_live(conn))
 			{
-				itNext = it;
-				++itNext;
-                
-				(*it)->emit(a1, a2, a3, a4);
-                
-				it = itNext;
+				return false;
 			}
+            
+			slot_entry& entry = m_slots[conn.m_slot];
+			topic* ptopic = entry.m_ptopic;
+			duplicate = insert(ptopic, ptopic->m_conns[entry.m_pos]->duplicate(pnewslot), pnewslot);
+			m_slots[duplicate.m_slot].m_link = plink;
+			return true;
 		}
         
-		void operator()(arg1_type a1, arg2_type a2, arg3_type a3, arg4_type a4)
+		void slot_relink(const connection& conn, has_slots<mt_policy>* pnewslot)
 		{
-			lock_block<mt_policy> lock(this);
-			const_iterator itNext, it = this->m_connected_slots.begin();
-			const_iterator itEnd = this->m_connected_slots.end();
+			hub_lock lock(this);
             
-			while(it != itEnd)
+			if(is_live(conn))
 			{
-				itNext = it;
-				++itNext;
-                
-				(*it)->emit(a1, a2, a3, a4);
-                
-				it = itNext;
+				slot_entry& entry = m_slots[conn.m_slot];
+				entry.m_pdest = pnewslot;
+				entry.m_ptopic->m_conns[entry.m_pos]->retarget(pnewslot);
 			}
 		}
-	};
-    
-	template<class arg1_type, class arg2_type, class arg3_type, class arg4_type,
-	class arg5_type, class mt_policy = SIGSLOT_DEFAULT_MT_POLICY>
-	class signal5 : public _signal_base5<arg1_type, arg2_type, arg3_type,
-    arg4_type, arg5_type, mt_policy>
-	{
-	public:
-    	typedef typename _signal_base5<arg1_type, arg2_type, arg3_type, arg4_type, arg5_type, mt_policy>::connections_list::const_iterator const_iterator;
-		signal5()
-		{
-			;
-		}
         
-		signal5(const signal5<arg1_type, arg2_type, arg3_type, arg4_type,
-                arg5_type, mt_policy>& s)
-        : _signal_base5<arg1_type, arg2_type, arg3_type, arg4_type,
-        arg5_type, mt_policy>(s)
-		{
-			;
-		}
+	private:
+		basic_signal_hub(const basic_signal_hub&);
+		basic_signal_hub& operator=(const basic_signal_hub&);
         
-		template<class desttype>
-        void connect(desttype* pclass, void (desttype::*pmemfun)(arg1_type,
-                                                                 arg2_type, arg3_type, arg4_type, arg5_type))
-		{
-			lock_block<mt_policy> lock(this);
-			_connection5<desttype, arg1_type, arg2_type, arg3_type, arg4_type,
-            arg5_type, mt_policy>* conn = new _connection5<desttype, arg1_type, arg2_type,
-            arg3_type, arg4_type, arg5_type, mt_policy>(pclass, pmemfun);
-			this->m_connected_slots.push_back(conn);
-			pclass->signal_connect(this);
-		}
+		enum { no_slot = -1, initial_buckets = 16 };
         
-		void emit(arg1_type a1, arg2_type a2, arg3_type a3, arg4_type a4,
-                  arg5_type a5)
+		struct topic : public _connection_allocation
 		{
-			lock_block<mt_policy> lock(this);
-			const_iterator itNext, it = this->m_connected_slots.begin();
-			const_iterator itEnd = this->m_connected_slots.end();
+			topic(const key_type& key, size_t hash)
+            : m_key(key), m_hash(hash), m_tombstones(0)
+			{
+				;
+			}
             
-			while(it != itEnd)
+			key_type m_key;
+			size_t m_hash;
+			std::vector<conn_type*> m_conns;
+			size_t m_tombstones;
+		};
+        
+		// The key's hash is kept beside its topic, so that probing past
+		// other keys does not have to visit their topics.
+		struct bucket
+		{
+			size_t m_hash;
+			topic* m_ptopic;
+		};
+        
+		struct slot_entry
+		{
+			topic* m_ptopic;
+			size_t m_pos;
+			has_slots<mt_policy>* m_pdest;
+			link_position m_link;
+			unsigned long m_generation;
+			size_t m_next_free;
+		};
+        
+		// As signal_lock is for a signal.
+		class hub_lock : public _reentrant_lock_block<mt_policy>
+		{
+		public:
+			hub_lock(basic_signal_hub* phub)
+            : _reentrant_lock_block<mt_policy>(phub, phub->emitting_here())
 			{
-				itNext = it;
-				++itNext;
-                
-				(*it)->emit(a1, a2, a3, a4, a5);
-                
-				it = itNext;
+				;
 			}
-		}
+		};
         
-		void operator()(arg1_type a1, arg2_type a2, arg3_type a3, arg4_type a4,
-                        arg5_type a5)
+		// As a signal's emit_scope, and compacts the topics that lost
+		// connections once the outermost emit is done.
+		class emit_scope
 		{
-			lock_block<mt_policy> lock(this);
-			const_iterator itNext, it = this->m_connected_slots.begin();
-			const_iterator itEnd = this->m_connected_slots.end();
+		public:
+			emit_scope(basic_signal_hub* phub)
+            : m_phub(phub)
+			{
+				if(_hub_reentrant<mt_policy>::value && m_phub->m_emit_depth++ == 0)
+				{
+					_atomic_store_relaxed(&m_phub->m_pemitter, _current_thread());
+				}
+			}
             
-			while(it != itEnd)
+			~emit_scope()
 			{
-				itNext = it;
-				++itNext;
-                
-				(*it)->emit(a1, a2, a3, a4, a5);
-                
-				it = itNext;
+				if(_hub_reentrant<mt_policy>::value && --m_phub->m_emit_depth == 0)
+				{
+					_atomic_store_relaxed(&m_phub->m_pemitter, static_cast<void*>(NULL));
+                    
+					if(!m_phub->m_dirty.empty())
+					{
+						m_phub->compact();
+					}
+				}
 			}
-		}
-	};
-    
-    
-	template<class arg1_type, class arg2_type, class arg3_type, class arg4_type,
-	class arg5_type, class arg6_type, class mt_policy = SIGSLOT_DEFAULT_MT_POLICY>
-	class signal6 : public _signal_base6<arg1_type, arg2_type, arg3_type,
-    arg4_type, arg5_type, arg6_type, mt_policy>
-	{
-	public:
-    	typedef typename _signal_base6<arg1_type, arg2_type, arg3_type,
-		arg4_type, arg5_type, arg6_type, mt_policy>::connections_list::const_iterator const_iterator;
-		signal6()
+            
+		private:
+			basic_signal_hub* m_phub;
+		};
+        
+		bool emitting_here()
 		{
-			;
+			return _hub_reentrant<mt_policy>::value && _atomic_load_relaxed(&m_pemitter) == _current_thread();
 		}
         
-		signal6(const signal6<arg1_type, arg2_type, arg3_type, arg4_type,
-                arg5_type, arg6_type, mt_policy>& s)
-        : _signal_base6<arg1_type, arg2_type, arg3_type, arg4_type,
-        arg5_type, arg6_type, mt_policy>(s)
+		// Adopts a heap allocated connection and registers it with its
+		// receiver. Called with the hub locked.
+		connection add(const key_type& key, conn_type* pconn, has_slots<mt_policy>* pdest)
 		{
-			;
+			size_t hash = std::hash<key_type>()(key);
+			topic* ptopic = find(key, hash);
+            
+			if(ptopic == NULL)
+			{
+				ptopic = new topic(key, hash);
+				insert_topic(ptopic);
+			}
+            
+			connection handle = insert(ptopic, pconn, pdest);
+            
+			if(pdest != NULL)
+			{
+				m_slots[handle.m_slot].m_link = pdest->signal_connect(this, handle);
+			}
+            
+			return handle;
 		}
         
-		template<class desttype>
-        void connect(desttype* pclass, void (desttype::*pmemfun)(arg1_type,
-                                                                 arg2_type, arg3_type, arg4_type, arg5_type, arg6_type))
+		// Appends a connection to a topic; the caller fills in m_link.
+		connection insert(topic* ptopic, conn_type* pconn, has_slots<mt_policy>* pdest)
 		{
-			lock_block<mt_policy> lock(this);
-			_connection6<desttype, arg1_type, arg2_type, arg3_type, arg4_type,
-            arg5_type, arg6_type, mt_policy>* conn = 
-            new _connection6<desttype, arg1_type, arg2_type, arg3_type,
-            arg4_type, arg5_type, arg6_type, mt_policy>(pclass, pmemfun);
-			this->m_connected_slots.push_back(conn);
-			pclass->signal_connect(this);
+			size_t slot = acquire_slot();
+			pconn->m_slot = slot;
+			m_slots[slot].m_ptopic = ptopic;
+			m_slots[slot].m_pos = ptopic->m_conns.size();
+			m_slots[slot].m_pdest = pdest;
+			ptopic->m_conns.push_back(pconn);
+			return connection(slot, m_slots[slot].m_generation);
 		}
         
-		void emit(arg1_type a1, arg2_type a2, arg3_type a3, arg4_type a4,
-                  arg5_type a5, arg6_type a6)
+		// Destroys a connection. During an emit its place is left to the
+		// tombstone; otherwise those behind it move down, and a topic left
+		// empty is dropped.
+		void remove(size_t slot)
 		{
-			lock_block<mt_policy> lock(this);
-			const_iterator itNext, it = this->m_connected_slots.begin();
-			const_iterator itEnd = this->m_connected_slots.end();
+			topic* ptopic = m_slots[slot].m_ptopic;
+			size_t pos = m_slots[slot].m_pos;
+			delete ptopic->m_conns[pos];
+			release_slot(slot);
             
-			while(it != itEnd)
+			if(m_emit_depth != 0)
 			{
-				itNext = it;
-				++itNext;
+				ptopic->m_conns[pos] = conn_type::tombstone();
                 
-				(*it)->emit(a1, a2, a3, a4, a5, a6);
+				if(ptopic->m_tombstones++ == 0)
+				{
+					m_dirty.push_back(ptopic);
+				}
                 
-				it = itNext;
+				return;
 			}
+            
+			ptopic->m_conns.erase(ptopic->m_conns.begin() + pos);
+			renumber(ptopic, pos);
 		}
         
-		void operator()(arg1_type a1, arg2_type a2, arg3_type a3, arg4_type a4,
-                        arg5_type a5, arg6_type a6)
+		// Called from the end of the outermost emit.
+		_SIGSLOT_NOINLINE void compact()
 		{
-			lock_block<mt_policy> lock(this);
-			const_iterator itNext, it = this->m_connected_slots.begin();
-			const_iterator itEnd = this->m_connected_slots.end();
-            
-			while(it != itEnd)
+			for(size_t i = 0; i < m_dirty.size(); ++i)
 			{
-				itNext = it;
-				++itNext;
-                
-				(*it)->emit(a1, a2, a3, a4, a5, a6);
-                
-				it = itNext;
+				topic* ptopic = m_dirty[i];
+				ptopic->m_conns.erase(std::remove(ptopic->m_conns.begin(), ptopic->m_conns.end(),
+					conn_type::tombstone()), ptopic->m_conns.end());
+				ptopic->m_tombstones = 0;
+				renumber(ptopic, 0);
 			}
-		}
-	};
-    
-	template<class arg1_type, class arg2_type, class arg3_type, class arg4_type,
-	class arg5_type, class arg6_type, class arg7_type, class mt_policy = SIGSLOT_DEFAULT_MT_POLICY>
-	class signal7 : public _signal_base7<arg1_type, arg2_type, arg3_type,
-    arg4_type, arg5_type, arg6_type, arg7_type, mt_policy>
-	{
-	public:
-    	typedef typename _signal_base7<arg1_type, arg2_type, arg3_type,
-		arg4_type, arg5_type, arg6_type, arg7_type, mt_policy>::connections_list::const_iterator const_iterator;
-		signal7()
-		{
-			;
+            
+			m_dirty.clear();
 		}
         
-		signal7(const signal7<arg1_type, arg2_type, arg3_type, arg4_type,
-                arg5_type, arg6_type, arg7_type, mt_policy>& s)
-        : _signal_base7<arg1_type, arg2_type, arg3_type, arg4_type,
-        arg5_type, arg6_type, arg7_type, mt_policy>(s)
+		// Updates the positions of a topic's connections from pos on, and
+		// drops the topic if it has none left.
+		void renumber(topic* ptopic, size_t pos)
 		{
-			;
+			for(size_t i = pos; i < ptopic->m_conns.size(); ++i)
+			{
+				m_slots[ptopic->m_conns[i]->m_slot].m_pos = i;
+			}
+            
+			if(ptopic->m_conns.empty())
+			{
+				erase_topic(ptopic);
+			}
 		}
         
-		template<class desttype>
-        void connect(desttype* pclass, void (desttype::*pmemfun)(arg1_type,
-                                                                 arg2_type, arg3_type, arg4_type, arg5_type, arg6_type, 
-                                                                 arg7_type))
+		topic* find(const key_type& key, size_t hash) const
 		{
-			lock_block<mt_policy> lock(this);
-			_connection7<desttype, arg1_type, arg2_type, arg3_type, arg4_type,
-            arg5_type, arg6_type, arg7_type, mt_policy>* conn = 
-            new _connection7<desttype, arg1_type, arg2_type, arg3_type,
-            arg4_type, arg5_type, arg6_type, arg7_type, mt_policy>(pclass, pmemfun);
-			this->m_connected_slots.push_back(conn);
-			pclass->signal_connect(this);
+			if(m_buckets.empty())
+			{
+				return NULL;
+			}
+            
+			size_t mask = m_buckets.size() - 1;
+            
+			for(size_t i = hash & mask; m_buckets[i].m_ptopic != NULL; i = (i + 1) & mask)
+			{
+				if(m_buckets[i].m_hash == hash && m_buckets[i].m_ptopic->m_key == key)
+				{
+					return m_buckets[i].m_ptopic;
+				}
+			}
+            
+			return NULL;
 		}
         
-		void emit(arg1_type a1, arg2_type a2, arg3_type a3, arg4_type a4,
-                  arg5_type a5, arg6_type a6, arg7_type a7)
+		// Keeps the table at most half full, so that probes stay short.
+		void insert_topic(topic* ptopic)
 		{
-			lock_block<mt_policy> lock(this);
-			const_iterator itNext, it = this->m_connected_slots.begin();
-			const_iterator itEnd = this->m_connected_slots.end();
-            
-			while(it != itEnd)
+			if((m_topics + 1) * 2 > m_buckets.size())
 			{
-				itNext = it;
-				++itNext;
+				std::vector<bucket> buckets(m_buckets.empty() ? size_t(initial_buckets) : m_buckets.size() * 2);
+				buckets.swap(m_buckets);
                 
-				(*it)->emit(a1, a2, a3, a4, a5, a6, a7);
-                
-				it = itNext;
+				for(size_t i = 0; i < buckets.size(); ++i)
+				{
+					if(buckets[i].m_ptopic != NULL)
+					{
+						place(buckets[i]);
+					}
+				}
 			}
+            
+			bucket entry = { ptopic->m_hash, ptopic };
+			place(entry);
+			++m_topics;
 		}
         
-		void operator()(arg1_type a1, arg2_type a2, arg3_type a3, arg4_type a4,
-                        arg5_type a5, arg6_type a6, arg7_type a7)
+		void place(const bucket& entry)
 		{
-			lock_block<mt_policy> lock(this);
-			const_iterator itNext, it = this->m_connected_slots.begin();
-			const_iterator itEnd = this->m_connected_slots.end();
+			size_t mask = m_buckets.size() - 1;
+			size_t i = entry.m_hash & mask;
             
-			while(it != itEnd)
+			while(m_buckets[i].m_ptopic != NULL)
 			{
-				itNext = it;
-				++itNext;
-                
-				(*it)->emit(a1, a2, a3, a4, a5, a6, a7);
-                
-				it = itNext;
+				i = (i + 1) & mask;
 			}
-		}
-	};
-    
-	template<class arg1_type, class arg2_type, class arg3_type, class arg4_type,
-	class arg5_type, class arg6_type, class arg7_type, class arg8_type, class mt_policy = SIGSLOT_DEFAULT_MT_POLICY>
-	class signal8 : public _signal_base8<arg1_type, arg2_type, arg3_type,
-    arg4_type, arg5_type, arg6_type, arg7_type, arg8_type, mt_policy>
-	{
-	public:
-    	typedef typename _signal_base8<arg1_type, arg2_type, arg3_type,
-		arg4_type, arg5_type, arg6_type, arg7_type, arg8_type, mt_policy>::connections_list::const_iterator const_iterator;
-		signal8()
-		{
-			;
+            
+			m_buckets[i] = entry;
 		}
         
-		signal8(const signal8<arg1_type, arg2_type, arg3_type, arg4_type,
-                arg5_type, arg6_type, arg7_type, arg8_type, mt_policy>& s)
-        : _signal_base8<arg1_type, arg2_type, arg3_type, arg4_type,
-        arg5_type, arg6_type, arg7_type, arg8_type, mt_policy>(s)
+		// Removes a topic's bucket and moves back each bucket after it that
+		// would otherwise be cut off from its home by the gap, so that the
+		// table needs no markers for removed keys.
+		void erase_topic(topic* ptopic)
 		{
-			;
+			size_t mask = m_buckets.size() - 1;
+			size_t gap = ptopic->m_hash & mask;
+            
+			while(m_buckets[gap].m_ptopic != ptopic)
+			{
+				gap = (gap + 1) & mask;
+			}
+            
+			for(size_t i = (gap + 1) & mask; m_buckets[i].m_ptopic != NULL; i = (i + 1) & mask)
+			{
+				size_t home = m_buckets[i].m_hash & mask;
+                
+				if(((i - home) & mask) >= ((i - gap) & mask))
+				{
+					m_buckets[gap] = m_buckets[i];
+					gap = i;
+				}
+			}
+            
+			m_buckets[gap].m_ptopic = NULL;
+			--m_topics;
+			delete ptopic;
 		}
         
-		template<class desttype>
-        void connect(desttype* pclass, void (desttype::*pmemfun)(arg1_type,
-                                                                 arg2_type, arg3_type, arg4_type, arg5_type, arg6_type, 
-                                                                 arg7_type, arg8_type))
+		bool is_live(const connection& conn) const
 		{
-			lock_block<mt_policy> lock(this);
-			_connection8<desttype, arg1_type, arg2_type, arg3_type, arg4_type,
-            arg5_type, arg6_type, arg7_type, arg8_type, mt_policy>* conn = 
-            new _connection8<desttype, arg1_type, arg2_type, arg3_type,
-            arg4_type, arg5_type, arg6_type, arg7_type, 
-            arg8_type, mt_policy>(pclass, pmemfun);
-			this->m_connected_slots.push_back(conn);
-			pclass->signal_connect(this);
+			return conn.m_slot < m_slots.size() && conn.m_generation != 0 &&
+				m_slots[conn.m_slot].m_generation == conn.m_generation;
 		}
         
-		void emit(arg1_type a1, arg2_type a2, arg3_type a3, arg4_type a4,
-                  arg5_type a5, arg6_type a6, arg7_type a7, arg8_type a8)
+		size_t acquire_slot()
 		{
-			lock_block<mt_policy> lock(this);
-			const_iterator itNext, it = this->m_connected_slots.begin();
-			const_iterator itEnd = this->m_connected_slots.end();
-            
-			while(it != itEnd)
+			if(m_free_slot != size_t(no_slot))
 			{
-				itNext = it;
-				++itNext;
-                
-				(*it)->emit(a1, a2, a3, a4, a5, a6, a7, a8);
-                
-				it = itNext;
+				size_t slot = m_free_slot;
+				m_free_slot = m_slots[slot].m_next_free;
+				return slot;
 			}
+            
+			slot_entry entry = slot_entry();
+			entry.m_generation = 1;
+			m_slots.push_back(entry);
+			return m_slots.size() - 1;
 		}
         
-		void operator()(arg1_type a1, arg2_type a2, arg3_type a3, arg4_type a4,
-                        arg5_type a5, arg6_type a6, arg7_type a7, arg8_type a8)
+		void release_slot(size_t slot)
 		{
-			lock_block<mt_policy> lock(this);
-			const_iterator itNext, it = this->m_connected_slots.begin();
-			const_iterator itEnd = this->m_connected_slots.end();
+			slot_entry& entry = m_slots[slot];
             
-			while(it != itEnd)
+			if(++entry.m_generation == 0)
 			{
-				itNext = it;
-				++itNext;
-                
-				(*it)->emit(a1, a2, a3, a4, a5, a6, a7, a8);
-                
-				it = itNext;
+				entry.m_generation = 1;
 			}
+            
+			entry.m_next_free = m_free_slot;
+			m_free_slot = slot;
 		}
+        
+		std::vector<bucket> m_buckets;
+		size_t m_topics;
+		std::vector<slot_entry> m_slots;
+		size_t m_free_slot;
+		std::vector<topic*> m_dirty;
+		void* volatile m_pemitter;
+		int m_emit_depth;
 	};
     
+	template<class key_type, class... arg_types>
+	using signal_hub = basic_signal_hub<SIGSLOT_DEFAULT_MT_POLICY, key_type, arg_types...>;
+    
 }; // namespace sigslot
 
 #endif // SIGSLOT_H__